@@ -16,16 +16,40 @@ namespace hermesml {
         [[nodiscard]] std::vector<BootstrapableCiphertext>
         Encrypt(const std::vector<std::vector<int64_t> > &data) const;
 
+        // Reads back the first slot of every integer-scheme ciphertext
+        [[nodiscard]] std::vector<int64_t> Decrypt(const std::vector<BootstrapableCiphertext> &ciphertexts) const;
+
+        // A depth other than 0 encrypts with only the levels that many operations need, e.g. a model's
+        // InferenceDepth for testing data
         [[nodiscard]] std::vector<BootstrapableCiphertext> EncryptCKKS(
-            const std::vector<std::vector<double> > &data) const;
+            const std::vector<std::vector<double> > &data, uint32_t depth = 0) const;
 
         [[nodiscard]] std::vector<BootstrapableCiphertext> EncryptCKKS(const std::vector<double> &data,
                                                                        size_t n_features = 0) const;
 
+        // numSlots labels per ciphertext, for PACKED_LABELS
+        [[nodiscard]] std::vector<BootstrapableCiphertext> EncryptCKKSLabels(const std::vector<double> &labels) const;
+
+        [[nodiscard]] TrainingSet EncryptTrainingSet(const std::vector<std::vector<double> > &features,
+                                                     const std::vector<double> &labels,
+                                                     LabelEncoding encoding) const;
+
         void EncryptCKKS(const std::vector<std::vector<double> > &data, const std::string &filePath) const;
 
         void EncryptCKKS(const std::vector<double> &data, size_t n_features, const std::string &filePath) const;
 
+        // Decrypts the first slot of every ciphertext, spreading the ciphertexts over worker threads
+        [[nodiscard]] std::vector<double> DecryptCKKS(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                                      uint32_t workers = 0) const;
+
+        // Packs GetSamplesPerCiphertext() rows per ciphertext, one numSlots-wide block per row
+        [[nodiscard]] std::vector<BootstrapableCiphertext> EncryptCKKSPacked(
+            const std::vector<std::vector<double> > &data, uint32_t depth = 0) const;
+
+        // Reads back the first slot of every block written by a batched prediction
+        [[nodiscard]] std::vector<double> DecryptPacked(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                                        size_t n_samples) const;
+
         void SerializeToFile(const std::string &filename, const std::vector<BootstrapableCiphertext> &vec) const;
 
         [[nodiscard]] std::vector<BootstrapableCiphertext> DeserializeFromFile(const std::string &filename) const;
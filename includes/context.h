@@ -1,11 +1,149 @@
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
+#include <array>
+#include <atomic>
+#include <functional>
+
 #include "openfhe.h"
 
 using namespace lbcrypto;
 
 namespace hermesml {
+    class HEContext;
+
+    // Which key fresh ciphertexts are encrypted under. The secret key is only an option for the data owner, who holds
+    // it anyway; it is cheaper and leaves less fresh noise than public-key encryption
+    enum EncryptionMode { PUBLIC_KEY_ENCRYPTION, SECRET_KEY_ENCRYPTION };
+
+    enum SimulatedOp { SIM_ENCRYPT, SIM_ADD, SIM_MULT, SIM_ROTATE, SIM_BOOTSTRAP, SIM_OPS };
+
+    // Milliseconds per ciphertext operation, indexed by SimulatedOp
+    using OperationCosts = std::array<double, SIM_OPS>;
+
+    // What every primitive costs on one machine, at every level. A ciphertext with more levels left carries more RNS
+    // limbs, so the same operation is dearer the earlier in the chain it runs
+    class CostModel {
+        // Indexed by remaining levels
+        std::vector<OperationCosts> costsByLevel;
+
+    public:
+        CostModel() = default;
+
+        explicit CostModel(std::vector<OperationCosts> costsByLevel);
+
+        [[nodiscard]] bool IsCalibrated() const;
+
+        [[nodiscard]] uint32_t GetLevels() const;
+
+        // Levels outside the calibrated range take the cost of the nearest calibrated one
+        [[nodiscard]] double GetCost(SimulatedOp op, int32_t level) const;
+
+        // Times every primitive on fresh ciphertexts of a real context, at each level of its chain
+        [[nodiscard]] static CostModel Calibrate(const HEContext &ctx, uint32_t repetitions = 10);
+
+        void Save(const std::string &filePath) const;
+
+        [[nodiscard]] static CostModel Load(const std::string &filePath);
+    };
+
+    // Tallies the ciphertext operations a simulated context stands in for, by the level they run at. Composite
+    // operations (sums, merges, polynomials) are charged as the primitives OpenFHE runs for them
+    class Simulation {
+        // Indexed by remaining levels, then by SimulatedOp
+        std::vector<std::array<std::atomic<uint64_t>, SIM_OPS> > counts;
+        CostModel costModel;
+
+    public:
+        explicit Simulation(uint32_t levels, CostModel costModel = {});
+
+        // Levels outside [0, levels] are charged to the nearest end
+        void Count(SimulatedOp op, int32_t level, uint64_t times = 1);
+
+        [[nodiscard]] uint64_t GetCount(SimulatedOp op) const;
+
+        [[nodiscard]] uint64_t GetCount(SimulatedOp op, int32_t level) const;
+
+        [[nodiscard]] uint64_t GetTotalCount() const;
+
+        void Reset();
+
+        [[nodiscard]] const CostModel &GetCostModel() const;
+
+        void SetCostModel(const CostModel &costModel);
+
+        // Wall time the counted operations would take, each at the level it ran at
+        [[nodiscard]] double EstimateSeconds() const;
+
+        [[nodiscard]] static std::string GetName(SimulatedOp op);
+    };
+
+    // Restores the level budget of a ciphertext that ran out of multiplicative depth
+    class RefreshStrategy {
+    public:
+        virtual ~RefreshStrategy() = default;
+
+        [[nodiscard]] virtual Ciphertext<DCRTPoly> Refresh(const CryptoContext<DCRTPoly> &cc,
+                                                          const Ciphertext<DCRTPoly> &ciphertext) const = 0;
+
+        // The slot values a refresh under a simulated context returns; the level reset is left to the caller
+        [[nodiscard]] virtual std::vector<double> SimulateRefresh(const std::vector<double> &values) const {
+            return values;
+        }
+    };
+
+    // Local CKKS bootstrapping; needs nothing but the evaluation keys
+    class BootstrapRefresh final : public RefreshStrategy {
+    public:
+        [[nodiscard]] Ciphertext<DCRTPoly> Refresh(const CryptoContext<DCRTPoly> &cc,
+                                                  const Ciphertext<DCRTPoly> &ciphertext) const override;
+    };
+
+    // Where the threads of each worker may run: anywhere, on a block of cores of their own, or on one NUMA node
+    enum CoreAffinity { NO_AFFINITY, CORE_AFFINITY, NUMA_AFFINITY };
+
+    // Splits a core budget between the workers hermesml runs side by side (graph nodes, samples, decryptions) and the
+    // OpenMP threads OpenFHE starts inside every operation. Nesting both without a budget oversubscribes the cores
+    class ThreadingPolicy {
+        uint32_t cores = 0;
+        uint32_t workers = 0;
+        CoreAffinity affinity = NO_AFFINITY;
+
+    public:
+        ThreadingPolicy() = default;
+
+        // 0 cores takes every core the process may run on; 0 workers allows one per core
+        explicit ThreadingPolicy(uint32_t cores, uint32_t workers = 0, CoreAffinity affinity = NO_AFFINITY);
+
+        [[nodiscard]] uint32_t GetCores() const;
+
+        [[nodiscard]] uint32_t GetWorkers() const;
+
+        [[nodiscard]] CoreAffinity GetAffinity() const;
+
+        // Workers to start for a number of independent jobs: as requested, or as the policy allows when 0, and never
+        // more than there are jobs
+        [[nodiscard]] uint32_t ResolveWorkers(uint32_t requested, size_t jobs) const;
+
+        // OpenMP threads each of `workers` concurrent workers gets inside OpenFHE
+        [[nodiscard]] uint32_t GetOpenMPThreads(uint32_t workers) const;
+
+        // Sizes the OpenMP team of the calling thread, and pins it, as worker `worker` of `workers`
+        void EnterWorker(uint32_t worker, uint32_t workers) const;
+
+        // Runs job(i) for every i < jobs, each worker pulling the next index. The first exception is rethrown once
+        // every worker has stopped
+        void ParallelFor(size_t jobs, uint32_t requested, const std::function<void(size_t)> &job) const;
+
+        // HERMESML_CORES, HERMESML_WORKERS and HERMESML_AFFINITY (none, cores or numa), over the given defaults
+        [[nodiscard]] static ThreadingPolicy FromEnvironment(const ThreadingPolicy &defaults);
+
+        // What new contexts start with: the executable's default under the environment variables
+        [[nodiscard]] static ThreadingPolicy GetDefault();
+
+        static void SetDefault(const ThreadingPolicy &policy);
+    };
+
     class HEContext {
         CryptoContext<DCRTPoly> cc;
         PublicKey<DCRTPoly> publicKey;
@@ -16,17 +154,22 @@ namespace hermesml {
         uint32_t levelsAfterBootstrapping = 0;
         uint32_t earlyBootstrapping = 0;
         uint32_t numFeatures = 0;
+        uint32_t packingSlots = 0;
+        EncryptionMode encryptionMode = PUBLIC_KEY_ENCRYPTION;
+        std::shared_ptr<const RefreshStrategy> refreshStrategy;
+        std::shared_ptr<Simulation> simulation;
+        ThreadingPolicy threadingPolicy;
 
     public:
-        [[nodiscard]] CryptoContext<DCRTPoly> GetCc() const;
+        [[nodiscard]] const CryptoContext<DCRTPoly> &GetCc() const;
 
         void SetCc(const CryptoContext<DCRTPoly> &cc);
 
-        [[nodiscard]] PublicKey<DCRTPoly> GetPublicKey() const;
+        [[nodiscard]] const PublicKey<DCRTPoly> &GetPublicKey() const;
 
         void SetPublicKey(const PublicKey<DCRTPoly> &publicKey);
 
-        [[nodiscard]] PrivateKey<DCRTPoly> GetPrivateKey() const;
+        [[nodiscard]] const PrivateKey<DCRTPoly> &GetPrivateKey() const;
 
         void SetPrivateKey(const PrivateKey<DCRTPoly> &privateKey);
 
@@ -53,14 +196,68 @@ namespace hermesml {
         [[nodiscard]] uint32_t GetNumFeatures() const;
 
         void SetNumFeatures(uint32_t numFeatures);
+
+        // Slots available to sample-packed ciphertexts, or 0 when batched inference is disabled
+        [[nodiscard]] uint32_t GetPackingSlots() const;
+
+        void SetPackingSlots(uint32_t packingSlots);
+
+        [[nodiscard]] uint32_t GetSamplesPerCiphertext() const;
+
+        [[nodiscard]] EncryptionMode GetEncryptionMode() const;
+
+        void SetEncryptionMode(EncryptionMode encryptionMode);
+
+        // Shared by every object built from this context afterwards. Defaults to local bootstrapping
+        [[nodiscard]] const RefreshStrategy &GetRefreshStrategy() const;
+
+        void SetRefreshStrategy(std::shared_ptr<const RefreshStrategy> refreshStrategy);
+
+        // A simulated context has no keys: ciphertexts carry their plain slot values instead
+        [[nodiscard]] bool IsSimulated() const;
+
+        [[nodiscard]] Simulation &GetSimulation() const;
+
+        void SetSimulation(std::shared_ptr<Simulation> simulation);
+
+        [[nodiscard]] const ThreadingPolicy &GetThreadingPolicy() const;
+
+        // Also sizes the OpenMP team of the calling thread, which runs everything outside of worker pools
+        void SetThreadingPolicy(const ThreadingPolicy &threadingPolicy);
     };
 
     class HEContextFactory {
     private:
+        inline static const std::vector<uint32_t> levelBudget = {1, 1};
+        inline static const std::vector<uint32_t> bsgsDim = {0, 0};
+        static constexpr uint32_t ckksRingDimension = 2048;
+        static constexpr uint32_t ckksScalingModSize = 56;
+        static constexpr uint32_t ckksDepth = 30;
+
         [[nodiscard]] static uint32_t NextPowerOfTwo(uint32_t n);
 
+        static void SetupBootstrapping(const CryptoContext<DCRTPoly> &cc, uint32_t numSlots, uint32_t packingSlots);
+
     public:
-        [[nodiscard]] static HEContext ckksHeContext(uint32_t n_features);
+        [[nodiscard]] static HEContext ckksHeContext(uint32_t n_features, bool batchedInference = false);
+
+        // Exact integer arithmetic over Quantizer-scaled data. There is no rescaling, so the 60-bit plaintext modulus
+        // has to hold the accumulated scale of the deepest product
+        [[nodiscard]] static HEContext bfvHeContext(uint32_t n_features, uint32_t multiplicativeDepth = 3);
+
+        // Same parameters as ckksHeContext, without generating a crypto context or keys
+        [[nodiscard]] static HEContext simulatedCkksHeContext(uint32_t n_features, bool batchedInference = false);
+
+        // Writes the crypto context, public and evaluation keys (and optionally the secret key) into a directory
+        static void Save(const HEContext &ctx, const std::string &directory, bool withPrivateKey = false);
+
+        // Restores a context written by Save. Bootstrapping precomputations are rebuilt, as they are not serialized
+        [[nodiscard]] static HEContext Load(const std::string &directory, bool withPrivateKey = false);
+
+        // Reuses the full context (secret key included) saved in a directory, creating it on first use. Resuming an
+        // encrypted training needs the key pair its checkpoints were written under
+        [[nodiscard]] static HEContext LoadOrCreate(const std::string &directory, uint32_t n_features,
+                                                    bool batchedInference = false);
     };
 }
 
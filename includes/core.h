@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <random>
+
 #include "context.h"
 #include "datasets.h"
+#include "tracing.h"
 #include "spdlog/spdlog.h"
 
 namespace hermesml {
@@ -14,6 +17,8 @@ namespace hermesml {
 
     class BootstrapableCiphertext {
         Ciphertext<DCRTPoly> ciphertext;
+        // Slot values standing in for the ciphertext under a simulated context
+        std::vector<double> values;
         int32_t remainingLevels = 0;
         int32_t additionsExecuted = 0;
 
@@ -23,13 +28,36 @@ namespace hermesml {
         explicit BootstrapableCiphertext(const Ciphertext<DCRTPoly> &ciphertext, int32_t remainingLevels,
                                          int32_t additionsExecuted = 0);
 
+        explicit BootstrapableCiphertext(Ciphertext<DCRTPoly> &&ciphertext, int32_t remainingLevels,
+                                         int32_t additionsExecuted = 0);
+
+        explicit BootstrapableCiphertext(std::vector<double> values, int32_t remainingLevels,
+                                         int32_t additionsExecuted = 0);
+
+        BootstrapableCiphertext(const BootstrapableCiphertext &other) = default;
+
+        BootstrapableCiphertext(BootstrapableCiphertext &&other) noexcept = default;
+
+        BootstrapableCiphertext &operator=(const BootstrapableCiphertext &other) = default;
+
+        BootstrapableCiphertext &operator=(BootstrapableCiphertext &&other) noexcept = default;
+
         [[nodiscard]] const Ciphertext<DCRTPoly> &GetCiphertext() const;
 
+        // Copies share the underlying ciphertext, so it is cloned before handing out a mutable reference
+        [[nodiscard]] Ciphertext<DCRTPoly> &GetMutableCiphertext();
+
+        [[nodiscard]] const std::vector<double> &GetValues() const;
+
         [[nodiscard]] int32_t GetRemainingLevels() const;
 
         void SetRemainingLevels(int32_t pRemainingLevels);
 
         [[nodiscard]] int32_t GetAdditionsExecuted() const;
+
+        void SetAdditionsExecuted(int32_t pAdditionsExecuted);
+
+        [[nodiscard]] size_t GetSizeInBytes() const;
     };
 
     //-----------------------------------------------------------------------------------------------------------------
@@ -39,19 +67,47 @@ namespace hermesml {
         CryptoContext<DCRTPoly> cc;
 
     protected:
-        static int32_t ComputeRemainingLevels(const BootstrapableCiphertext &ciphertext1,
-                                              const BootstrapableCiphertext &ciphertext2);
+        [[nodiscard]] int32_t ComputeRemainingLevels(const Ciphertext<DCRTPoly> &ciphertext) const;
+
+        [[nodiscard]] BootstrapableCiphertext Wrap(const Ciphertext<DCRTPoly> &ciphertext,
+                                                   int32_t additionsExecuted = 0) const;
+
+        [[nodiscard]] BootstrapableCiphertext Wrap(Ciphertext<DCRTPoly> &&ciphertext,
+                                                   int32_t additionsExecuted = 0) const;
 
         [[nodiscard]] Ciphertext<DCRTPoly> SafeRescaling(const Ciphertext<DCRTPoly> &ciphertext) const;
 
+        // OpenFHE's binary serialization, or under a simulated context the slot values with their level metadata
+        void WriteCiphertext(std::ostream &out, const BootstrapableCiphertext &ciphertext) const;
+
+        [[nodiscard]] BootstrapableCiphertext ReadCiphertext(std::istream &in) const;
+
+        // Fresh ciphertext with just enough levels left for `depth` more, plus the margin EvalBootstrapInPlace keeps.
+        // A depth of 0 encrypts at the top of the modulus chain
+        [[nodiscard]] BootstrapableCiphertext EncryptCKKSForDepth(const std::vector<double> &plaintext, uint32_t depth,
+                                                                  uint32_t slots = 0) const;
+
+        // Encrypts under the key selected by the context's EncryptionMode
+        [[nodiscard]] Ciphertext<DCRTPoly> EncryptPlaintext(const Plaintext &plaintext) const;
+
+        // Plain-value counterparts of the ciphertext operations, for simulated contexts. Levels follow what
+        // FLEXIBLEAUTO would leave: products consume one, everything else keeps the lower operand's
+        [[nodiscard]] BootstrapableCiphertext SimulateEncrypt(const std::vector<double> &plaintext,
+                                                              uint32_t slots = 0, uint32_t levels = 0) const;
+
+        [[nodiscard]] BootstrapableCiphertext SimulateBinary(const BootstrapableCiphertext &ciphertext1,
+                                                             const BootstrapableCiphertext &ciphertext2,
+                                                             const std::function<double(double, double)> &op,
+                                                             SimulatedOp counted, int32_t additionsExecuted) const;
+
         //-----------------------------------------------------------------------------------------------------------------
 
     public:
         explicit EncryptedObject(const HEContext &ctx);
 
-        [[nodiscard]] HEContext GetCtx() const;
+        [[nodiscard]] const HEContext &GetCtx() const;
 
-        [[nodiscard]] CryptoContext<DCRTPoly> GetCc() const;
+        [[nodiscard]] const CryptoContext<DCRTPoly> &GetCc() const;
 
         [[nodiscard]] BootstrapableCiphertext Encrypt(const std::vector<int64_t> &plaintext) const;
 
@@ -65,15 +121,44 @@ namespace hermesml {
         [[nodiscard]] BootstrapableCiphertext EvalAdd(const BootstrapableCiphertext &ciphertext1,
                                                       const BootstrapableCiphertext &ciphertext2) const;
 
+        [[nodiscard]] BootstrapableCiphertext EvalAdd(BootstrapableCiphertext &&ciphertext1,
+                                                      const BootstrapableCiphertext &ciphertext2) const;
+
+        void EvalAddInPlace(BootstrapableCiphertext &ciphertext1, const BootstrapableCiphertext &ciphertext2) const;
+
         [[nodiscard]] BootstrapableCiphertext EvalSum(const BootstrapableCiphertext &ciphertext1) const;
 
         [[nodiscard]] BootstrapableCiphertext EvalSub(const BootstrapableCiphertext &ciphertext1,
                                                       const BootstrapableCiphertext &ciphertext2) const;
 
+        [[nodiscard]] BootstrapableCiphertext EvalSub(BootstrapableCiphertext &&ciphertext1,
+                                                      const BootstrapableCiphertext &ciphertext2) const;
+
+        void EvalSubInPlace(BootstrapableCiphertext &ciphertext1, const BootstrapableCiphertext &ciphertext2) const;
+
         [[nodiscard]] BootstrapableCiphertext EvalMult(const BootstrapableCiphertext &ciphertext1,
                                                        const BootstrapableCiphertext &ciphertext2) const;
 
-        [[nodiscard]] BootstrapableCiphertext EvalBootstrap(const BootstrapableCiphertext &ciphertext) const;
+        void EvalMultInPlace(BootstrapableCiphertext &ciphertext1, const BootstrapableCiphertext &ciphertext2) const;
+
+        // Sum of pairwise products with a single relinearization: the tensor products are accumulated as they are,
+        // and FLEXIBLEAUTO rescales the total once, on its next use
+        [[nodiscard]] BootstrapableCiphertext EvalInnerProduct(const std::vector<BootstrapableCiphertext> &ciphertexts1,
+                                                               const std::vector<BootstrapableCiphertext> &ciphertexts2)
+        const;
+
+        // Weighted sum with one rescaling for the whole combination. Weights of +1 and -1 only add and subtract, so
+        // they keep the level a constant product would spend
+        [[nodiscard]] BootstrapableCiphertext EvalLinearWSum(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                                             const std::vector<double> &weights) const;
+
+        [[nodiscard]] BootstrapableCiphertext EvalBootstrap(const BootstrapableCiphertext &ciphertext,
+                                                            int32_t levelsRequired = 0) const;
+
+        [[nodiscard]] BootstrapableCiphertext EvalBootstrap(BootstrapableCiphertext &&ciphertext,
+                                                            int32_t levelsRequired = 0) const;
+
+        void EvalBootstrapInPlace(BootstrapableCiphertext &ciphertext, int32_t levelsRequired = 0) const;
 
         void Snoop(const BootstrapableCiphertext &ciphertext) const;
 
@@ -88,6 +173,21 @@ namespace hermesml {
 
         [[nodiscard]] BootstrapableCiphertext EvalFlatten(const BootstrapableCiphertext &ciphertext) const;
 
+        // Multiplies every slot by the matching mask entry, through a plaintext; slots past the mask are cleared
+        [[nodiscard]] BootstrapableCiphertext EvalMask(const BootstrapableCiphertext &ciphertext,
+                                                       const std::vector<double> &mask) const;
+
+        [[nodiscard]] BootstrapableCiphertext EvalSegmentSum(const BootstrapableCiphertext &ciphertext,
+                                                             uint32_t segmentSize) const;
+
+        // Copies slot 0 into slots [0, count) by rotate-and-add doubling, without spending a level. Every other slot
+        // of the input must already be zero
+        [[nodiscard]] BootstrapableCiphertext EvalReplicate(const BootstrapableCiphertext &ciphertext,
+                                                            uint32_t count) const;
+
+        [[nodiscard]] BootstrapableCiphertext EvalMergePacked(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                                              uint32_t segmentSize) const;
+
         [[nodiscard]] BootstrapableCiphertext
         EvalRotate(const BootstrapableCiphertext &ciphertext, int32_t index) const;
     };
@@ -115,15 +215,178 @@ namespace hermesml {
 
     //-----------------------------------------------------------------------------------------------------------------
 
+    class MemoryFootprint {
+    public:
+        [[nodiscard]] static size_t CiphertextBytes(const Ciphertext<DCRTPoly> &ciphertext);
+
+        [[nodiscard]] static size_t CiphertextBytes(const std::vector<BootstrapableCiphertext> &ciphertexts);
+
+        [[nodiscard]] static size_t CiphertextBytes(
+            const std::vector<std::vector<BootstrapableCiphertext> > &ciphertexts);
+
+        // Serialized size of a fresh ciphertext, measured after level-reducing it by 0, 1, 2... levels
+        [[nodiscard]] static std::vector<size_t> CiphertextBytesByLevel(const HEContext &ctx);
+
+        [[nodiscard]] static size_t CurrentRss();
+
+        // High-water mark of the resident set since the last ResetPeakRss, or since the process started
+        [[nodiscard]] static size_t PeakRss();
+
+        // Restarts PeakRss from the current resident set. Returns false where the kernel does not allow it, in which
+        // case PeakRss keeps reporting the peak of the whole process
+        static bool ResetPeakRss();
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    // Next sample to train on. A sample equal to the epoch length means the epoch is complete
+    struct TrainingCursor {
+        uint16_t epoch = 0;
+        size_t sample = 0;
+    };
+
+    // Told after every training step how many of the total steps are done
+    using ProgressCallback = std::function<void(size_t done, size_t total)>;
+
+    struct CheckpointOptions {
+        // Empty disables checkpointing
+        std::string directory;
+        // Samples between checkpoints within an epoch; 0 only checkpoints at epoch boundaries
+        size_t everySamples = 0;
+        uint16_t everyEpochs = 1;
+    };
+
+    // Persists encrypted parameters, with their level metadata, alongside the training cursor and RNG state.
+    // Ciphertexts only make sense under the key pair that produced them, so resuming needs the same context. Under a
+    // simulated context the slot values are stored instead
+    class Checkpointer : public EncryptedObject {
+        CheckpointOptions options;
+        std::string modelName;
+
+        [[nodiscard]] std::string GetFilePath() const;
+
+        [[nodiscard]] std::string GetKeyTag() const;
+
+    public:
+        explicit Checkpointer(const HEContext &ctx, CheckpointOptions options, std::string modelName);
+
+        [[nodiscard]] bool IsEnabled() const;
+
+        // Whether a checkpoint is due once training reached the cursor
+        [[nodiscard]] bool IsDue(const TrainingCursor &cursor, size_t samplesPerEpoch) const;
+
+        // The activation coefficients ride on the header line, so a polynomial activation resumes as it was trained
+        void Save(const TrainingCursor &cursor, const std::mt19937 &rng,
+                  const std::vector<BootstrapableCiphertext> &parameters,
+                  const std::vector<double> &activationCoefficients = {}) const;
+
+        // Returns false when there is no checkpoint to resume from
+        [[nodiscard]] bool Load(TrainingCursor &cursor, std::mt19937 &rng,
+                                std::vector<BootstrapableCiphertext> &parameters,
+                                std::vector<double> &activationCoefficients) const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    enum LabelEncoding {
+        // One ciphertext per label, replicated over n_features slots
+        REPLICATED_LABELS,
+        // The label rides in the spare slot right after the features, so labels take no ciphertexts of their own
+        FEATURE_SLOT_LABELS,
+        // numSlots labels per ciphertext
+        PACKED_LABELS
+    };
+
+    // Encrypted training samples in any LabelEncoding. GetFeatures and GetLabel hand back a sample laid out as with
+    // REPLICATED_LABELS, so models train alike on every encoding. The compact encodings pay for that with a rotation,
+    // a one-slot mask and log2(n_features) rotate-and-adds, only for the sample being trained on
+    class TrainingSet : public EncryptedObject {
+        LabelEncoding encoding;
+        std::vector<BootstrapableCiphertext> features;
+        // Unused with FEATURE_SLOT_LABELS
+        std::vector<BootstrapableCiphertext> labels;
+
+    public:
+        explicit TrainingSet(const HEContext &ctx, std::vector<BootstrapableCiphertext> features,
+                             std::vector<BootstrapableCiphertext> labels, LabelEncoding encoding = REPLICATED_LABELS);
+
+        // FEATURE_SLOT_LABELS needs a free slot after the features; without one, PACKED_LABELS is the next most
+        // compact encoding
+        [[nodiscard]] static LabelEncoding SupportedEncoding(const HEContext &ctx, LabelEncoding encoding);
+
+        [[nodiscard]] LabelEncoding GetEncoding() const;
+
+        [[nodiscard]] size_t GetSize() const;
+
+        [[nodiscard]] BootstrapableCiphertext GetFeatures(size_t i) const;
+
+        [[nodiscard]] BootstrapableCiphertext GetLabel(size_t i) const;
+
+        [[nodiscard]] size_t GetCiphertextBytes() const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    struct ClassificationMetrics {
+        size_t truePositives = 0;
+        size_t falsePositives = 0;
+        size_t trueNegatives = 0;
+        size_t falseNegatives = 0;
+        double accuracy = 0.0;
+        double precision = 0.0;
+        double recall = 0.0;
+        double f1 = 0.0;
+    };
+
+    struct MemorySample {
+        std::string stage;
+        size_t liveCiphertextBytes;
+        size_t currentRss;
+        size_t peakRss;
+    };
+
+    // Run time a cost model predicts for each stage of an experiment
+    struct RuntimeEstimate {
+        double encryptingSeconds = 0.0;
+        double trainingSeconds = 0.0;
+        double testingSeconds = 0.0;
+
+        [[nodiscard]] double GetTotalSeconds() const;
+    };
+
     class Experiment {
         std::string experimentId;
         std::string contentPath;
         Dataset &dataset;
         std::shared_ptr<spdlog::logger> logger;
+        std::vector<MemorySample> memorySamples;
+        RuntimeEstimate estimate;
 
     protected:
         [[nodiscard]] std::string BuildFilePath(const std::string &fileName) const;
 
+        // Kept apart from the predictions, whose presence marks an experiment as executed
+        [[nodiscard]] std::string BuildCheckpointPath() const;
+
+        void SampleMemory(const std::string &stage, size_t liveCiphertextBytes);
+
+        [[nodiscard]] const std::vector<MemorySample> &GetMemorySamples() const;
+
+        void DumpMemory(const HEContext &ctx) const;
+
+        // Thresholds the decrypted predictions, writes predictions.csv in one buffered pass and scores them
+        ClassificationMetrics WritePredictions(const std::vector<double> &predictions,
+                                               const std::vector<double> &labels, double threshold) const;
+
+        static void WriteMetrics(std::ostream &out, const ClassificationMetrics &metrics);
+
+        // Logs how far a stage got and the time it has left. The estimate starts from the stage's predicted run time
+        // and moves over to the measured pace as the stage advances
+        [[nodiscard]] ProgressCallback TrackProgress(const std::string &stage, double estimatedSeconds) const;
+
+        // Runs the experiment over plain values on a simulated context charged by the cost model
+        [[nodiscard]] virtual RuntimeEstimate Simulate(const CostModel &costModel) const;
+
     public:
         virtual ~Experiment() = default;
 
@@ -139,8 +402,31 @@ namespace hermesml {
 
         void Error(const std::string &message) const;
 
+        // Predicts the run time from a simulated run over plain values, and keeps it for progress reports. Zero when
+        // the experiment cannot be simulated or the cost model is not calibrated
+        RuntimeEstimate Estimate(const CostModel &costModel);
+
+        [[nodiscard]] const RuntimeEstimate &GetEstimate() const;
+
         virtual void Run();
     };
+
+    // Runs a grid of experiments in the order their estimated run times suggest
+    class ExperimentSweep {
+        std::vector<std::unique_ptr<Experiment> > experiments;
+
+    public:
+        void Add(std::unique_ptr<Experiment> experiment);
+
+        // Deals the grid out over `shards` machines, longest experiments first onto the least loaded one, so that
+        // all of them finish at about the same time. Runs the share of `shard`, shortest first so that results start
+        // coming in early. Without a calibrated cost model, runs the whole grid in the order it was added
+        void Run(const CostModel &costModel, uint32_t shard = 0, uint32_t shards = 1);
+
+        // Takes the cost model from HERMESML_COSTS (operation_costs.csv when unset, if it exists) and the share to run
+        // from HERMESML_SHARD, written as shard/shards
+        void Run();
+    };
 }
 
 #endif //CORE_H
@@ -0,0 +1,76 @@
+#ifndef DISTRIBUTED_H
+#define DISTRIBUTED_H
+
+#include <functional>
+
+#include "client.h"
+#include "model.h"
+
+namespace hermesml {
+    // Exchange area shared by the coordinator and the worker processes of a data-parallel training. Every file is
+    // written under a temporary name and renamed once complete, so a reader never observes a partial file
+    class SharedDirectory {
+        std::string directory;
+
+    public:
+        explicit SharedDirectory(std::string directory);
+
+        [[nodiscard]] const std::string &GetDirectory() const;
+
+        [[nodiscard]] std::string Path(const std::string &name) const;
+
+        [[nodiscard]] std::string ShardPath(uint32_t worker, const std::string &kind) const;
+
+        [[nodiscard]] std::string ModelPath(uint64_t round) const;
+
+        [[nodiscard]] std::string GradientsPath(uint64_t round, uint32_t worker) const;
+
+        [[nodiscard]] std::string FailurePath(uint32_t worker) const;
+
+        void Publish(const std::string &path, const std::function<void(const std::string &)> &write) const;
+
+        // Blocks until one of the files exists and returns its index
+        [[nodiscard]] size_t WaitForAny(const std::vector<std::string> &paths, uint32_t pollIntervalMs) const;
+    };
+
+    struct ShardedTrainingOptions {
+        std::string directory;
+        uint32_t workers = 2;
+        // Samples each worker folds into its gradient per round. workers * localBatchSize samples move the weights
+        // at once, so 1 worker with a batch of 1 reproduces the sequential Fit
+        uint32_t localBatchSize = 1;
+        uint32_t pollIntervalMs = 10;
+    };
+
+    class TrainingCoordinator : public EncryptedObject {
+        ShardedTrainingOptions options;
+        SharedDirectory shared;
+
+        [[nodiscard]] Gradients CollectGradients(uint64_t round) const;
+
+    public:
+        explicit TrainingCoordinator(const HEContext &ctx, ShardedTrainingOptions options);
+
+        // Writes the public context and deals the samples round-robin into one shard per worker
+        void Prepare(const std::vector<BootstrapableCiphertext> &x, const std::vector<BootstrapableCiphertext> &y)
+        const;
+
+        // Broadcasts the weights, sums the worker gradients and applies them, once per round
+        void Train(CkksLogisticRegression &model, uint16_t epochs) const;
+    };
+
+    class TrainingWorker : public EncryptedObject {
+        SharedDirectory shared;
+        uint32_t rank;
+        uint32_t pollIntervalMs;
+
+    public:
+        explicit TrainingWorker(const HEContext &ctx, const std::string &directory, uint32_t rank,
+                                uint32_t pollIntervalMs = 10);
+
+        // Serves rounds until the coordinator marks the training as done
+        void Run() const;
+    };
+}
+
+#endif //DISTRIBUTED_H
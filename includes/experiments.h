@@ -12,6 +12,15 @@ namespace hermesml {
         int8_t earlyBootstrapping;
         int8_t scalingAlpha;
         int8_t scalingBeta;
+        bool batchedInference;
+        // Encrypts the data under the secret key, which the experiment holds anyway
+        bool secretKeyEncryption;
+        LabelEncoding labelEncoding;
+        // Resumes an interrupted run from its last checkpoint; 0 samples checkpoints once per epoch
+        bool checkpointing;
+        size_t checkpointEverySamples;
+        // Only the logistic regression takes an optimizer; the defaults are plain SGD at a fixed rate
+        OptimizerOptions optimizer;
     };
 
     class CkksLogisticRegressionExperiment : public Experiment {
@@ -27,6 +36,12 @@ namespace hermesml {
         std::chrono::duration<double> encryptingTime{};
         std::chrono::duration<double> trainingTime{};
         std::chrono::duration<double> testingTime{};
+        std::chrono::duration<double> collectingTime{};
+
+        ClassificationMetrics metrics{};
+
+    protected:
+        [[nodiscard]] RuntimeEstimate Simulate(const CostModel &costModel) const override;
 
     public:
         explicit CkksLogisticRegressionExperiment(const std::string &experimentId,
@@ -53,6 +68,12 @@ namespace hermesml {
         std::chrono::duration<double> encryptingTime{};
         std::chrono::duration<double> trainingTime{};
         std::chrono::duration<double> testingTime{};
+        std::chrono::duration<double> collectingTime{};
+
+        ClassificationMetrics metrics{};
+
+    protected:
+        [[nodiscard]] RuntimeEstimate Simulate(const CostModel &costModel) const override;
 
     public:
         explicit CkksNeuralNetworkExperiment(const std::string &experimentId,
@@ -0,0 +1,288 @@
+#ifndef EXPRESSIONS_H
+#define EXPRESSIONS_H
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <type_traits>
+
+#include "core.h"
+
+namespace hermesml {
+    // Arithmetic over ciphertexts written with operators, e.g. Evaluate(*this, 0.5 * (a * b + c * d) - bias). The
+    // operators only build the expression type; Evaluate flattens it into weighted ciphertexts and weighted products
+    // before anything is computed, so that:
+    //  - constant factors become weights instead of plaintext products,
+    //  - products sharing a weight are accumulated and relinearized once, through EvalInnerProduct,
+    //  - the whole linear combination is a single EvalLinearWSum, with one bootstrap check at the end,
+    //  - terms that cancel out, as in a - a, leave an encrypted zero.
+    // Products with different weights are relinearized once per weight: a * b + 2 * c * d takes two, while
+    // 2 * (a * b + c * d) takes one. Their sum spends a level too, unless every weight is +1 or -1
+    // Expressions refer to their ciphertexts, so they must be evaluated within the statement that builds them
+
+    // Flattened expression: sum of weight * linear + sum of weight * left * right
+    class ExpressionTerms {
+        // Operands that had to be evaluated on their own; a deque keeps their addresses stable
+        std::deque<BootstrapableCiphertext> temporaries;
+
+    public:
+        std::vector<const BootstrapableCiphertext *> linear;
+        std::vector<double> linearWeights;
+        std::vector<const BootstrapableCiphertext *> left;
+        std::vector<const BootstrapableCiphertext *> right;
+        std::vector<double> productWeights;
+
+        const BootstrapableCiphertext *Keep(BootstrapableCiphertext ciphertext) {
+            this->temporaries.push_back(std::move(ciphertext));
+            return &this->temporaries.back();
+        }
+
+        void AddLinear(const BootstrapableCiphertext *ciphertext, const double weight) {
+            // a + a is one term, not two
+            for (size_t i = 0; i < this->linear.size(); i++) {
+                if (this->linear[i] == ciphertext) {
+                    this->linearWeights[i] += weight;
+                    return;
+                }
+            }
+
+            this->linear.push_back(ciphertext);
+            this->linearWeights.push_back(weight);
+        }
+
+        void AddProduct(const BootstrapableCiphertext *ciphertext1, const BootstrapableCiphertext *ciphertext2,
+                        const double weight) {
+            this->left.push_back(ciphertext1);
+            this->right.push_back(ciphertext2);
+            this->productWeights.push_back(weight);
+        }
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    template<typename E>
+    struct IsExpression : std::false_type {
+    };
+
+    template<typename T>
+    constexpr bool IsOperand = IsExpression<std::decay_t<T> >::value ||
+                               std::is_same_v<std::decay_t<T>, BootstrapableCiphertext>;
+
+    template<typename E>
+    [[nodiscard]] BootstrapableCiphertext Evaluate(const EncryptedObject &evaluator, const E &expression);
+
+    class LeafExpression {
+        const BootstrapableCiphertext &ciphertext;
+
+    public:
+        explicit LeafExpression(const BootstrapableCiphertext &ciphertext) : ciphertext(ciphertext) {
+        }
+
+        [[nodiscard]] const BootstrapableCiphertext &GetCiphertext() const {
+            return this->ciphertext;
+        }
+
+        void Collect(const EncryptedObject &, const double weight, ExpressionTerms &terms) const {
+            terms.AddLinear(&this->ciphertext, weight);
+        }
+    };
+
+    template<typename E>
+    class ScaledExpression {
+        E expression;
+        double weight;
+
+    public:
+        explicit ScaledExpression(E expression, const double weight) : expression(std::move(expression)),
+                                                                         weight(weight) {
+        }
+
+        [[nodiscard]] const E &GetExpression() const {
+            return this->expression;
+        }
+
+        [[nodiscard]] double GetWeight() const {
+            return this->weight;
+        }
+
+        void Collect(const EncryptedObject &evaluator, const double weight, ExpressionTerms &terms) const {
+            this->expression.Collect(evaluator, weight * this->weight, terms);
+        }
+    };
+
+    template<typename L, typename R>
+    class SumExpression {
+        L left;
+        R right;
+
+    public:
+        explicit SumExpression(L left, R right) : left(std::move(left)), right(std::move(right)) {
+        }
+
+        void Collect(const EncryptedObject &evaluator, const double weight, ExpressionTerms &terms) const {
+            this->left.Collect(evaluator, weight, terms);
+            this->right.Collect(evaluator, weight, terms);
+        }
+    };
+
+    // One factor of a product as a ciphertext and its constant. Only a (scaled) ciphertext is taken as it is; any
+    // other operand is evaluated first, which keeps every product at degree two
+    template<typename E>
+    std::pair<const BootstrapableCiphertext *, double> Factor(const EncryptedObject &evaluator, const E &expression,
+                                                              ExpressionTerms &terms) {
+        if constexpr (std::is_same_v<E, LeafExpression>) {
+            return {&expression.GetCiphertext(), 1.0};
+        } else if constexpr (std::is_same_v<E, ScaledExpression<LeafExpression> >) {
+            return {&expression.GetExpression().GetCiphertext(), expression.GetWeight()};
+        } else {
+            return {terms.Keep(Evaluate(evaluator, expression)), 1.0};
+        }
+    }
+
+    template<typename L, typename R>
+    class ProductExpression {
+        L left;
+        R right;
+
+    public:
+        explicit ProductExpression(L left, R right) : left(std::move(left)), right(std::move(right)) {
+        }
+
+        void Collect(const EncryptedObject &evaluator, const double weight, ExpressionTerms &terms) const {
+            const auto [ciphertext1, weight1] = Factor(evaluator, this->left, terms);
+            const auto [ciphertext2, weight2] = Factor(evaluator, this->right, terms);
+            terms.AddProduct(ciphertext1, ciphertext2, weight * weight1 * weight2);
+        }
+    };
+
+    template<>
+    struct IsExpression<LeafExpression> : std::true_type {
+    };
+
+    template<typename E>
+    struct IsExpression<ScaledExpression<E> > : std::true_type {
+    };
+
+    template<typename L, typename R>
+    struct IsExpression<SumExpression<L, R> > : std::true_type {
+    };
+
+    template<typename L, typename R>
+    struct IsExpression<ProductExpression<L, R> > : std::true_type {
+    };
+
+    inline LeafExpression ToExpression(const BootstrapableCiphertext &ciphertext) {
+        return LeafExpression(ciphertext);
+    }
+
+    template<typename E, typename = std::enable_if_t<IsExpression<E>::value> >
+    const E &ToExpression(const E &expression) {
+        return expression;
+    }
+
+    template<typename T>
+    using ExpressionOf = std::decay_t<decltype(ToExpression(std::declval<const T &>()))>;
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    template<typename L, typename R, typename = std::enable_if_t<IsOperand<L> && IsOperand<R> > >
+    SumExpression<ExpressionOf<L>, ExpressionOf<R> > operator+(const L &left, const R &right) {
+        return SumExpression<ExpressionOf<L>, ExpressionOf<R> >(ToExpression(left), ToExpression(right));
+    }
+
+    template<typename L, typename R, typename = std::enable_if_t<IsOperand<L> && IsOperand<R> > >
+    SumExpression<ExpressionOf<L>, ScaledExpression<ExpressionOf<R> > > operator-(const L &left, const R &right) {
+        return SumExpression<ExpressionOf<L>, ScaledExpression<ExpressionOf<R> > >(
+            ToExpression(left), ScaledExpression<ExpressionOf<R> >(ToExpression(right), -1.0));
+    }
+
+    template<typename T, typename = std::enable_if_t<IsOperand<T> > >
+    ScaledExpression<ExpressionOf<T> > operator-(const T &operand) {
+        return ScaledExpression<ExpressionOf<T> >(ToExpression(operand), -1.0);
+    }
+
+    template<typename L, typename R, typename = std::enable_if_t<IsOperand<L> && IsOperand<R> > >
+    ProductExpression<ExpressionOf<L>, ExpressionOf<R> > operator*(const L &left, const R &right) {
+        return ProductExpression<ExpressionOf<L>, ExpressionOf<R> >(ToExpression(left), ToExpression(right));
+    }
+
+    template<typename T, typename = std::enable_if_t<IsOperand<T> > >
+    ScaledExpression<ExpressionOf<T> > operator*(const double weight, const T &operand) {
+        return ScaledExpression<ExpressionOf<T> >(ToExpression(operand), weight);
+    }
+
+    template<typename T, typename = std::enable_if_t<IsOperand<T> > >
+    ScaledExpression<ExpressionOf<T> > operator*(const T &operand, const double weight) {
+        return ScaledExpression<ExpressionOf<T> >(ToExpression(operand), weight);
+    }
+
+    template<typename T, typename = std::enable_if_t<IsOperand<T> > >
+    ScaledExpression<ExpressionOf<T> > operator/(const T &operand, const double divisor) {
+        return ScaledExpression<ExpressionOf<T> >(ToExpression(operand), 1.0 / divisor);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    template<typename E>
+    BootstrapableCiphertext Evaluate(const EncryptedObject &evaluator, const E &expression) {
+        static_assert(IsOperand<E>, "Only ciphertexts and expressions over them can be evaluated");
+
+        ExpressionTerms terms;
+        ToExpression(expression).Collect(evaluator, 1.0, terms);
+
+        std::vector<BootstrapableCiphertext> ciphertexts;
+        std::vector<double> weights;
+        for (size_t i = 0; i < terms.linear.size(); i++) {
+            if (terms.linearWeights[i] != 0.0) {
+                ciphertexts.push_back(*terms.linear[i]);
+                weights.push_back(terms.linearWeights[i]);
+            }
+        }
+
+        // Products sharing a weight are accumulated before a single relinearization
+        using Products = std::pair<std::vector<BootstrapableCiphertext>, std::vector<BootstrapableCiphertext> >;
+        std::map<double, Products> groups;
+        for (size_t i = 0; i < terms.productWeights.size(); i++) {
+            auto &[ciphertexts1, ciphertexts2] = groups[terms.productWeights[i]];
+            ciphertexts1.push_back(*terms.left[i]);
+            ciphertexts2.push_back(*terms.right[i]);
+        }
+        for (const auto &[weight, products]: groups) {
+            if (weight != 0.0) {
+                ciphertexts.push_back(evaluator.EvalInnerProduct(products.first, products.second));
+                weights.push_back(weight);
+            }
+        }
+
+        if (ciphertexts.empty()) {
+            // Everything cancelled: the difference of the lowest term with itself, at the level the terms are left at
+            std::vector<BootstrapableCiphertext> cancelled;
+            for (const auto *ciphertext: terms.linear) {
+                cancelled.push_back(*ciphertext);
+            }
+            if (!terms.productWeights.empty()) {
+                std::vector<BootstrapableCiphertext> ciphertexts1;
+                std::vector<BootstrapableCiphertext> ciphertexts2;
+                for (size_t i = 0; i < terms.productWeights.size(); i++) {
+                    ciphertexts1.push_back(*terms.left[i]);
+                    ciphertexts2.push_back(*terms.right[i]);
+                }
+                cancelled.push_back(evaluator.EvalInnerProduct(ciphertexts1, ciphertexts2));
+            }
+
+            const auto byLevel = [](const auto &x, const auto &y) {
+                return x.GetRemainingLevels() < y.GetRemainingLevels();
+            };
+            const auto &lowest = *std::min_element(cancelled.begin(), cancelled.end(), byLevel);
+            return evaluator.EvalSub(lowest, lowest);
+        }
+
+        if (ciphertexts.size() == 1 && weights[0] == 1.0) {
+            return ciphertexts[0];
+        }
+
+        return evaluator.EvalLinearWSum(ciphertexts, weights);
+    }
+}
+
+#endif //EXPRESSIONS_H
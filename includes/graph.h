@@ -0,0 +1,82 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <functional>
+
+#include "core.h"
+
+namespace hermesml {
+    // Position of a value recorded in a ComputationGraph
+    using NodeId = size_t;
+
+    // Records homomorphic operations instead of running them. Nothing is evaluated until a GraphExecutor runs the
+    // graph, which is free to run independent operations concurrently
+    class ComputationGraph : public EncryptedObject {
+    public:
+        using Operation = std::function<BootstrapableCiphertext(
+            const std::vector<const BootstrapableCiphertext *> &)>;
+
+        struct Node {
+            // Empty for inputs, which already hold their value
+            Operation operation;
+            std::vector<NodeId> inputs;
+            BootstrapableCiphertext value;
+            // Name of the span the executor traces the operation under
+            std::string label;
+        };
+
+    private:
+        std::vector<Node> nodes;
+
+        NodeId Record(std::string label, Operation operation, std::vector<NodeId> inputs);
+
+    public:
+        explicit ComputationGraph(const HEContext &ctx);
+
+        [[nodiscard]] NodeId Input(const BootstrapableCiphertext &ciphertext);
+
+        [[nodiscard]] NodeId Add(NodeId a, NodeId b);
+
+        [[nodiscard]] NodeId Sub(NodeId a, NodeId b);
+
+        [[nodiscard]] NodeId Mult(NodeId a, NodeId b);
+
+        [[nodiscard]] NodeId Sum(NodeId a);
+
+        [[nodiscard]] NodeId Rotate(NodeId a, int32_t index);
+
+        [[nodiscard]] NodeId Flatten(NodeId a);
+
+        [[nodiscard]] NodeId Merge(const std::vector<NodeId> &inputs);
+
+        [[nodiscard]] NodeId InnerProduct(const std::vector<NodeId> &a, const std::vector<NodeId> &b);
+
+        [[nodiscard]] NodeId WeightedSum(NodeId weights, NodeId features, NodeId bias);
+
+        // Any other step over one value, such as an activation
+        [[nodiscard]] NodeId Apply(NodeId a,
+                                   std::function<BootstrapableCiphertext(const BootstrapableCiphertext &)> fn);
+
+        // Names a node in traces, e.g. after the neuron it computes
+        void Label(NodeId a, std::string label);
+
+        [[nodiscard]] const std::vector<Node> &GetNodes() const;
+    };
+
+    // Runs a graph on a work-stealing pool: every worker pops the operations it made ready from the back of its own
+    // queue and steals from the front of the others when it runs dry
+    class GraphExecutor {
+        uint32_t workers;
+
+    public:
+        // 0 takes as many workers as the context's threading policy allows; 1 runs the graph on the calling thread
+        explicit GraphExecutor(uint32_t workers = 0);
+
+        // Evaluates what the outputs depend on, in their order. Intermediate values are released as soon as their last
+        // consumer has run, so peak memory follows the widest part of the graph rather than its size
+        [[nodiscard]] std::vector<BootstrapableCiphertext> Run(const ComputationGraph &graph,
+                                                               const std::vector<NodeId> &outputs) const;
+    };
+}
+
+#endif //GRAPH_H
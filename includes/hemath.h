@@ -5,6 +5,11 @@
 #ifndef HEMATH_H
 #define HEMATH_H
 
+// Terms of the Taylor series after the constant one, from 1 to 3
+#ifndef TAYLOR_SQRT_PRECISION
+#define TAYLOR_SQRT_PRECISION 2
+#endif
+
 #include "openfhe.h"
 #include "context.h"
 #include "core.h"
@@ -12,9 +17,59 @@
 using namespace lbcrypto;
 
 namespace hermesml {
-    enum ActivationFn { TANH, SIGMOID };
+    // SQUARE, SCALED_SQUARE and ODD_POLY are low-degree polynomials evaluated exactly in one or two levels, so the
+    // approximation only applies to TANH and SIGMOID
+    enum ActivationFn { TANH, SIGMOID, SQUARE, SCALED_SQUARE, ODD_POLY };
+
+    enum ApproximationFn { CHEBYSHEV, TAYLOR, LEAST_SQUARES, MINIMAX };
+
+    enum FitCriterion { FIT_MINIMAX, FIT_LEAST_SQUARES };
+
+    struct PolynomialApproximation {
+        std::vector<double> coefficients; // Chebyshev series, OpenFHE convention (c_0 / 2 + sum c_k T_k)
+        double lowerBound;
+        double upperBound;
+        uint32_t degree;
+        uint32_t depth;
+        double maxError;
+    };
 
-    enum ApproximationFn { CHEBYSHEV, TAYLOR, LEAST_SQUARES };
+    class ApproximationFitter {
+        static std::map<std::string, PolynomialApproximation> cache;
+        static std::mutex cacheMutex;
+
+        [[nodiscard]] static std::vector<double> LeastSquares(const std::function<double(double)> &f,
+                                                              double lowerBound, double upperBound, uint32_t degree);
+
+        // Best uniform approximation of one degree; the constant term is not doubled yet, as Fit stores it
+        [[nodiscard]] static std::vector<double> Remez(const std::function<double(double)> &f, double lowerBound,
+                                                       double upperBound, uint32_t degree);
+
+        [[nodiscard]] static double MaxError(const std::function<double(double)> &f, double lowerBound,
+                                             double upperBound, const std::vector<double> &coefficients);
+
+        [[nodiscard]] static uint32_t MaxDegree(uint32_t depth);
+
+    public:
+        // Lowest degree whose error stays within errorTarget, among those maxDepth can evaluate. Throws
+        // std::invalid_argument when none of them does
+        [[nodiscard]] static PolynomialApproximation Fit(const std::string &name,
+                                                         const std::function<double(double)> &f,
+                                                         double lowerBound, double upperBound, double errorTarget,
+                                                         uint32_t maxDepth, FitCriterion criterion = FIT_MINIMAX);
+
+        [[nodiscard]] static double Evaluate(const PolynomialApproximation &approximation, double x);
+
+        // Fixed-degree Chebyshev interpolant, as OpenFHE builds for EvalChebyshevFunction and EvalLogistic
+        [[nodiscard]] static PolynomialApproximation Interpolate(const std::function<double(double)> &f,
+                                                                 double lowerBound, double upperBound,
+                                                                 uint32_t degree);
+    };
+
+    struct ActivationOutput {
+        BootstrapableCiphertext value;
+        BootstrapableCiphertext derivative;
+    };
 
     class Constants : EncryptedObject {
         BootstrapableCiphertext zero;
@@ -39,46 +94,67 @@ namespace hermesml {
     public:
         explicit Constants(const HEContext &ctx);
 
-        [[nodiscard]] BootstrapableCiphertext Zero() const;
+        [[nodiscard]] const BootstrapableCiphertext &Zero() const;
 
-        [[nodiscard]] BootstrapableCiphertext One() const;
+        [[nodiscard]] const BootstrapableCiphertext &One() const;
 
-        [[nodiscard]] BootstrapableCiphertext Two() const;
+        [[nodiscard]] const BootstrapableCiphertext &Two() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_9580() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_9580() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_625() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_625() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_5() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_5() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_333333() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_333333() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_25() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_25() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_21689() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_21689() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_2125() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_2125() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_133333() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_133333() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_125() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_125() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_0240() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_0240() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_020833() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_020833() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_002083() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_002083() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_0081934() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_0081934() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_00016588() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_00016588() const;
 
-        [[nodiscard]] BootstrapableCiphertext C0_0000011959() const;
+        [[nodiscard]] const BootstrapableCiphertext &C0_0000011959() const;
     };
 
     class Calculus : EncryptedObject {
+        static constexpr double approximationErrorTarget = 1e-3;
+        static constexpr uint32_t sigmoidChebyshevDegree = 5;
+        static constexpr uint32_t tanhChebyshevDegree = 59;
+        // Every Taylor and least-squares series below is of degree 5
+        static constexpr uint32_t powerSeriesDegree = 5;
+
         Constants constants;
 
+        // Slot-wise polynomial for simulated contexts, charged the products and depth its evaluation would take
+        [[nodiscard]] BootstrapableCiphertext SimulatePolynomial(const BootstrapableCiphertext &x,
+                                                                 const std::function<double(double)> &polynomial,
+                                                                 uint32_t products, uint32_t depth) const;
+
+        [[nodiscard]] BootstrapableCiphertext EvalApproximation(const BootstrapableCiphertext &x,
+                                                                const PolynomialApproximation &approximation) const;
+
+        [[nodiscard]] static PolynomialApproximation MinimaxApproximation(const HEContext &ctx,
+                                                                          ActivationFn activation);
+
+        [[nodiscard]] BootstrapableCiphertext SigmoidMinimax(const BootstrapableCiphertext &x) const;
+
+        [[nodiscard]] BootstrapableCiphertext TanhMinimax(const BootstrapableCiphertext &x) const;
+
         [[nodiscard]] BootstrapableCiphertext SigmoidTaylor(const BootstrapableCiphertext &x) const;
 
         [[nodiscard]] BootstrapableCiphertext SigmoidLeastSquares(const BootstrapableCiphertext &x) const;
@@ -94,28 +170,80 @@ namespace hermesml {
     public:
         explicit Calculus(const HEContext &ctx);
 
+        [[nodiscard]] static uint32_t ChebyshevDepth(uint32_t degree);
+
+        [[nodiscard]] static uint32_t PolyLinearDepth(uint32_t degree);
+
+        // Levels one activation consumes, as its evaluation below will spend them
+        [[nodiscard]] static uint32_t ActivationDepth(const HEContext &ctx, ActivationFn activation,
+                                                      ApproximationFn approximation);
+
+        // Activation output above which a prediction is labelled as the positive class
+        [[nodiscard]] static double DecisionThreshold(ActivationFn activation);
+
+        [[nodiscard]] static bool IsPolynomial(ActivationFn activation);
+
+        [[nodiscard]] static uint32_t PolynomialDepth(ActivationFn activation);
+
+        // Coefficients a polynomial activation starts with, lowest degree first: x^2 for SQUARE, the least-squares
+        // fit of ReLU on [-2, 2] for SCALED_SQUARE and of tanh on [-4, 4] for ODD_POLY
+        [[nodiscard]] static std::vector<double> DefaultCoefficients(ActivationFn activation);
+
+        // Throws unless the coefficients fit the shape of the activation: c_0 + c_1 x + c_2 x^2 for SCALED_SQUARE and
+        // c_1 x + c_3 x^3 for ODD_POLY. SQUARE takes none but its own
+        static void CheckCoefficients(ActivationFn activation, const std::vector<double> &coefficients);
+
+        [[nodiscard]] BootstrapableCiphertext Polynomial(const BootstrapableCiphertext &x, ActivationFn activation,
+                                                         const std::vector<double> &coefficients) const;
+
+        // Taken from the activation's input, which costs fewer levels than rebuilding it from the output
+        [[nodiscard]] BootstrapableCiphertext PolynomialDerivative(const BootstrapableCiphertext &x,
+                                                                   ActivationFn activation,
+                                                                   const std::vector<double> &coefficients) const;
+
         [[nodiscard]] BootstrapableCiphertext Sigmoid(const BootstrapableCiphertext &x,
                                                       ApproximationFn approximation) const;
 
         [[nodiscard]] BootstrapableCiphertext SigmoidDerivative(const BootstrapableCiphertext &x,
                                                                 ApproximationFn approximation) const;
 
+        [[nodiscard]] BootstrapableCiphertext SigmoidDerivativeFromActivation(const BootstrapableCiphertext &s) const;
+
+        [[nodiscard]] ActivationOutput SigmoidWithDerivative(const BootstrapableCiphertext &x,
+                                                             ApproximationFn approximation) const;
+
         [[nodiscard]] BootstrapableCiphertext Tanh(const BootstrapableCiphertext &x,
                                                    ApproximationFn approximation) const;
 
         [[nodiscard]] BootstrapableCiphertext TanhDerivative(const BootstrapableCiphertext &x,
                                                              ApproximationFn approximation) const;
 
+        [[nodiscard]] BootstrapableCiphertext TanhDerivativeFromActivation(const BootstrapableCiphertext &t) const;
+
+        [[nodiscard]] ActivationOutput TanhWithDerivative(const BootstrapableCiphertext &x,
+                                                          ApproximationFn approximation) const;
+
         [[nodiscard]] static std::vector<std::vector<double> > Transpose(const std::vector<std::vector<double> > &mat);
     };
 
+    // Fixed-point helpers for integer schemes (BFV/BGV) over Quantizer-scaled data. Nothing is rescaled, so every
+    // product multiplies the scales of its operands
     class CalculusQuant : EncryptedObject {
-        Constants constants;
+        [[nodiscard]] Plaintext Constant(double value) const;
 
     public:
         explicit CalculusQuant(const HEContext &ctx);
 
+        // sqrt(1 + u) for |u| < 1, where x holds u scaled by QUANTIZE_SCALE_FACTOR. The result carries
+        // TaylorSqrtScale()
         [[nodiscard]] BootstrapableCiphertext TaylorSqrt(const BootstrapableCiphertext &x) const;
+
+        [[nodiscard]] static double TaylorSqrtScale();
+
+        // Exact squared distance in the first slot, carrying QUANTIZE_SCALE_FACTOR^2. The square root is monotonic,
+        // so ranking neighbours needs nothing more
+        [[nodiscard]] BootstrapableCiphertext Euclidean(const BootstrapableCiphertext &point1,
+                                                        const BootstrapableCiphertext &point2) const;
     };
 }
 
@@ -21,10 +21,76 @@ namespace hermesml {
 
         virtual BootstrapableCiphertext Predict(const BootstrapableCiphertext &point) = 0;
 
+        [[nodiscard]] virtual size_t GetCiphertextBytes() const = 0;
+
         [[nodiscard]] uint32_t GetSeed() const;
 
+        void SetCheckpointOptions(const CheckpointOptions &options);
+
+        [[nodiscard]] const CheckpointOptions &GetCheckpointOptions() const;
+
+        // Called by Fit after every sample, counted over all epochs
+        void SetProgressCallback(ProgressCallback progressCallback);
+
+    protected:
+        // Seeded from GetSeed(), and part of every checkpoint
+        [[nodiscard]] std::mt19937 &GetRng();
+
+        void ReportProgress(const TrainingCursor &reached, size_t samples, uint16_t epochs) const;
+
     private:
         uint32_t seed;
+        std::mt19937 rng;
+        CheckpointOptions checkpointOptions;
+        ProgressCallback progressCallback;
+    };
+
+    // Update directions summed over a set of samples, before any learning rate is applied
+    struct Gradients {
+        BootstrapableCiphertext eWeights;
+        BootstrapableCiphertext eBias;
+    };
+
+    enum OptimizerFn { SGD, MOMENTUM, NESTEROV };
+
+    // How the learning rate decays: by decayRate every decayEpochs (STEP_DECAY), continuously at that pace
+    // (EXPONENTIAL_DECAY), or as learningRate / (1 + decayRate * epochs / decayEpochs) (INVERSE_TIME_DECAY)
+    enum ScheduleFn { CONSTANT_RATE, STEP_DECAY, EXPONENTIAL_DECAY, INVERSE_TIME_DECAY };
+
+    struct OptimizerOptions {
+        OptimizerFn optimizer = SGD;
+        double learningRate = 0.005;
+        double momentum = 0.9;
+        ScheduleFn schedule = CONSTANT_RATE;
+        double decayRate = 0.5;
+        double decayEpochs = 1.0;
+    };
+
+    // Moves encrypted parameters along their update directions. Velocities are kept encrypted, like the parameters;
+    // the scheduled learning rate and the momentum are plaintext weights, so every update is a single weighted sum
+    class Optimizer : public EncryptedObject {
+        OptimizerOptions options;
+        std::vector<BootstrapableCiphertext> eVelocities;
+
+    public:
+        explicit Optimizer(const HEContext &ctx, const OptimizerOptions &options = OptimizerOptions());
+
+        [[nodiscard]] const OptimizerOptions &GetOptions() const;
+
+        // Rate the schedule gives at a point of training, in epochs: 1.5 is halfway through the second one
+        [[nodiscard]] double GetLearningRate(double epoch) const;
+
+        // Adds rate * direction to every parameter, through the velocities for MOMENTUM and NESTEROV. The parameters
+        // hold Nesterov's look-ahead point, so directions are taken at the parameters themselves
+        void Step(const std::vector<BootstrapableCiphertext *> &eParameters,
+                  const std::vector<BootstrapableCiphertext> &eDirections, double rate);
+
+        // Empty before the first step, and always for SGD
+        [[nodiscard]] const std::vector<BootstrapableCiphertext> &GetVelocities() const;
+
+        void SetVelocities(std::vector<BootstrapableCiphertext> eVelocities);
+
+        void Reset();
     };
 
     class CkksLogisticRegression : public EncryptedObject, public MlModel {
@@ -34,31 +100,111 @@ namespace hermesml {
 
         [[nodiscard]] BootstrapableCiphertext GetLearningRate() const;
 
+        // Replaces plain SGD at a fixed rate. Takes effect from the next Fit
+        void SetOptimizer(const OptimizerOptions &options);
+
+        [[nodiscard]] const Optimizer &GetOptimizer() const;
+
         void Fit(const std::vector<BootstrapableCiphertext> &x,
                  const std::vector<BootstrapableCiphertext> &y) override;
 
+        void Fit(const TrainingSet &samples);
+
         void Fit(const std::string &eTrainingFeaturesFilePath, const std::string &eTrainingLabelsFilePath);
 
+        // Draws fresh weights and a zero bias, as Fit does, for training loops driven from outside the model
+        void Initialize();
+
+        // Sums the update directions of samples [begin, end), all evaluated against the current weights. Fit would
+        // scale each of them by the learning rate; ApplyGradients does it once for the whole sum
+        [[nodiscard]] Gradients ComputeGradients(const std::vector<BootstrapableCiphertext> &x,
+                                                 const std::vector<BootstrapableCiphertext> &y, size_t begin,
+                                                 size_t end);
+
+        // Steps the optimizer along the gradients at the rate its schedule gives for the point of training, in epochs
+        void ApplyGradients(const Gradients &gradients, double epoch);
+
         BootstrapableCiphertext Predict(const BootstrapableCiphertext &x) override;
 
         std::vector<BootstrapableCiphertext> PredictAll(const std::vector<BootstrapableCiphertext> &x);
 
         std::vector<BootstrapableCiphertext> PredictAll(const std::string &eTestingFeaturesFilePath);
 
+        // Predicts every sample of a Client::EncryptCKKSPacked ciphertext at once
+        [[nodiscard]] BootstrapableCiphertext PredictBatch(const BootstrapableCiphertext &xPacked) const;
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> PredictAllPacked(
+            const std::vector<BootstrapableCiphertext> &xPacked) const;
+
+        // Stores the encrypted weights and bias, plus what is needed to rebuild the model around them
+        void Save(const std::string &filePath) const;
+
+        [[nodiscard]] static CkksLogisticRegression Load(const HEContext &ctx, const std::string &filePath);
+
+        [[nodiscard]] const BootstrapableCiphertext &GetWeights() const;
+
+        [[nodiscard]] const BootstrapableCiphertext &GetBias() const;
+
+        // Coefficients of a polynomial activation, lowest degree first, e.g. as learned by plaintext pre-training. They
+        // stay fixed while the model trains over ciphertexts
+        void SetActivationCoefficients(const std::vector<double> &coefficients);
+
+        [[nodiscard]] const std::vector<double> &GetActivationCoefficients() const;
+
+        [[nodiscard]] size_t GetCiphertextBytes() const override;
+
+        // Levels Predict consumes, so that inputs can be encrypted with no more than they need
+        [[nodiscard]] static uint32_t InferenceDepth(const HEContext &ctx, ActivationFn activation,
+                                                     ApproximationFn approximation);
+
     private:
         Calculus calculus;
         Constants constants;
 
         ActivationFn activation;
         ApproximationFn approximation;
+        std::vector<double> activationCoefficients;
         uint16_t n_features;
         uint16_t epochs;
         BootstrapableCiphertext eWeights;
         BootstrapableCiphertext eBias;
+        Optimizer optimizer;
 
         void InitWeights();
 
+        bool RestoreCheckpoint(const Checkpointer &checkpointer, TrainingCursor &cursor);
+
+        void StoreCheckpoint(const Checkpointer &checkpointer, const TrainingCursor &cursor);
+
         [[nodiscard]] BootstrapableCiphertext Activation(const BootstrapableCiphertext &x) const;
+
+        // Adds the update of one sample, whose error is label - activation, through the optimizer
+        void Update(const BootstrapableCiphertext &eFeatures, const BootstrapableCiphertext &eError, double epoch);
+    };
+
+    // Inference over an integer scheme (BFV/BGV) for weights trained elsewhere. Features and weights are both quantized
+    // by QUANTIZE_SCALE_FACTOR, so the logit comes back exact, scaled by QUANTIZE_SCALE_FACTOR^2. The activation is
+    // left to the client: the decision only depends on the sign of the logit
+    class QuantizedLogisticRegression : public EncryptedObject {
+    public:
+        explicit QuantizedLogisticRegression(const HEContext &ctx, const std::vector<double> &weights, double bias);
+
+        // Encrypted logit in the first slot
+        [[nodiscard]] BootstrapableCiphertext Predict(const BootstrapableCiphertext &x) const;
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> PredictAll(
+            const std::vector<BootstrapableCiphertext> &x) const;
+
+        [[nodiscard]] static double Dequantize(int64_t logit);
+
+    private:
+        BootstrapableCiphertext eWeights;
+        BootstrapableCiphertext eBias;
+    };
+
+    struct ForwardWorkspace {
+        std::vector<BootstrapableCiphertext> ePreActivations;
+        std::vector<BootstrapableCiphertext> eActivations;
     };
 
     class CkksNeuralNetwork : public EncryptedObject, public MlModel {
@@ -72,13 +218,49 @@ namespace hermesml {
         void Fit(const std::vector<BootstrapableCiphertext> &x,
                  const std::vector<BootstrapableCiphertext> &y) override;
 
+        void Fit(const TrainingSet &samples);
+
         void Fit(const std::string &eTrainingFeaturesFilePath, const std::string &eTrainingLabelsFilePath);
 
         BootstrapableCiphertext Predict(const BootstrapableCiphertext &x) override;
 
-        std::vector<BootstrapableCiphertext> PredictAll(const std::vector<BootstrapableCiphertext> &x);
+        // Reentrant forward pass. Intermediate layers are only kept when a workspace is given
+        [[nodiscard]] BootstrapableCiphertext Predict(const BootstrapableCiphertext &x,
+                                                      ForwardWorkspace *workspace) const;
 
-        std::vector<BootstrapableCiphertext> PredictAll(const std::string &eTestingFeaturesFilePath);
+        [[nodiscard]] std::vector<BootstrapableCiphertext> PredictAll(const std::vector<BootstrapableCiphertext> &x,
+                                                                      uint32_t workers = 0) const;
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> PredictAll(const std::string &eTestingFeaturesFilePath,
+                                                                      uint32_t workers = 0) const;
+
+        // Predicts every sample of a Client::EncryptCKKSPacked ciphertext at once
+        [[nodiscard]] BootstrapableCiphertext PredictBatch(const BootstrapableCiphertext &xPacked) const;
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> PredictAllPacked(
+            const std::vector<BootstrapableCiphertext> &xPacked, uint32_t workers = 0) const;
+
+        [[nodiscard]] size_t GetCiphertextBytes() const override;
+
+        // Threads used inside a single forward or backward pass; 0 as the threading policy allows. Keep it at 1 when
+        // samples already run concurrently, as in PredictAll
+        void SetGraphWorkers(uint32_t workers);
+
+        // One ciphertext per unit, holding the weights of its inputs, layer by layer
+        [[nodiscard]] const std::vector<std::vector<BootstrapableCiphertext> > &GetWeights() const;
+
+        // One ciphertext per unit, with the bias in the first slot
+        [[nodiscard]] const std::vector<std::vector<BootstrapableCiphertext> > &GetBias() const;
+
+        // Coefficients of a polynomial activation, lowest degree first, e.g. as learned by plaintext pre-training. They
+        // stay fixed while the model trains over ciphertexts
+        void SetActivationCoefficients(const std::vector<double> &coefficients);
+
+        [[nodiscard]] const std::vector<double> &GetActivationCoefficients() const;
+
+        // Levels Predict consumes for these layer sizes, so that inputs can be encrypted with no more than they need
+        [[nodiscard]] static uint32_t InferenceDepth(const HEContext &ctx, const std::vector<size_t> &sizes,
+                                                     ActivationFn activation, ApproximationFn approximation);
 
     private:
         Calculus calculus;
@@ -86,18 +268,28 @@ namespace hermesml {
 
         ActivationFn activation;
         ApproximationFn approximation;
+        std::vector<double> activationCoefficients;
         std::vector<size_t> layerSizes;
         uint16_t n_features;
         uint16_t epochs;
         std::vector<std::vector<BootstrapableCiphertext> > eWeights;
         std::vector<std::vector<BootstrapableCiphertext> > eBias;
-        std::vector<BootstrapableCiphertext> ePreActivations;
-        std::vector<BootstrapableCiphertext> eActivations;
+        ForwardWorkspace trainingWorkspace;
+        uint32_t graphWorkers = 1;
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> MapSamples(
+            const std::vector<BootstrapableCiphertext> &x, uint32_t workers,
+            const std::function<BootstrapableCiphertext(const BootstrapableCiphertext &)> &fn) const;
 
         void InitWeights();
 
+        bool RestoreCheckpoint(const Checkpointer &checkpointer, TrainingCursor &cursor);
+
+        void StoreCheckpoint(const Checkpointer &checkpointer, const TrainingCursor &cursor);
+
         [[nodiscard]] BootstrapableCiphertext Activation(const BootstrapableCiphertext &x) const;
 
+        // Taken from the activation for TANH and SIGMOID, and from its input for the polynomial activations
         [[nodiscard]] BootstrapableCiphertext ActivationDerivative(const BootstrapableCiphertext &x) const;
     };
 }
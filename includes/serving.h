@@ -0,0 +1,200 @@
+#ifndef SERVING_H
+#define SERVING_H
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <set>
+
+#include "core.h"
+#include "model.h"
+
+namespace hermesml {
+    enum MessageType : uint8_t {
+        MSG_PREDICT = 'P',
+        MSG_RESULT = 'R',
+        MSG_STATS = 'S',
+        MSG_SHUTDOWN = 'Q',
+        MSG_ERROR = 'E',
+        MSG_REFRESH = 'F'
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    // Length-prefixed frames over a connected Unix domain socket: 1 byte type, 8 bytes length, payload
+    class SocketStream {
+        int fd;
+        uint64_t maxFrameBytes;
+
+    public:
+        // Large enough for a bootstrappable ciphertext of the biggest ring the contexts use
+        static constexpr uint64_t defaultMaxFrameBytes = 1ull << 30;
+
+        explicit SocketStream(int fd, uint64_t maxFrameBytes = defaultMaxFrameBytes);
+
+        ~SocketStream();
+
+        SocketStream(const SocketStream &) = delete;
+
+        SocketStream &operator=(const SocketStream &) = delete;
+
+        [[nodiscard]] static std::unique_ptr<SocketStream> Connect(const std::string &socketPath,
+                                                                   uint64_t maxFrameBytes = defaultMaxFrameBytes);
+
+        void WriteFrame(MessageType type, const std::string &payload) const;
+
+        // Returns false once the peer closed the connection. Throws on a frame above maxFrameBytes, before reading its
+        // payload, so the stream cannot be resynchronized afterwards
+        [[nodiscard]] bool ReadFrame(MessageType &type, std::string &payload) const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    struct LatencySummary {
+        size_t count = 0;
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+    };
+
+    class LatencyRecorder {
+        mutable std::mutex mutex;
+        std::vector<double> samples;
+
+    public:
+        void Record(double milliseconds);
+
+        [[nodiscard]] LatencySummary Summarize() const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    struct InferenceResult {
+        BootstrapableCiphertext prediction;
+    };
+
+    struct InferenceServerOptions {
+        std::string socketPath;
+        // How long the first request of a batch waits for others to join it
+        uint32_t maxBatchWaitMs = 5;
+        // 0 packs as many queries as fit in one ciphertext
+        uint32_t maxBatchSize = 0;
+        // Connections sending a larger frame get a MSG_ERROR and are closed
+        uint64_t maxFrameBytes = SocketStream::defaultMaxFrameBytes;
+    };
+
+    class InferenceServer : public EncryptedObject {
+        struct PendingRequest {
+            BootstrapableCiphertext query;
+            std::chrono::steady_clock::time_point arrival;
+            std::promise<InferenceResult> result;
+        };
+
+        const CkksLogisticRegression &model;
+        InferenceServerOptions options;
+        uint32_t batchSize;
+        std::vector<Plaintext> blockMasks;
+        // Keep only the first slot of a block, where its prediction lands, so a reply reveals no other query
+        std::vector<Plaintext> resultMasks;
+
+        std::mutex queueMutex;
+        std::condition_variable queueCondition;
+        std::deque<PendingRequest> queue;
+
+        // Handlers are detached and leave the set as their connection closes; Serve waits for it to drain
+        std::mutex connectionsMutex;
+        std::condition_variable connectionsCondition;
+        std::set<int> connections;
+
+        std::atomic<bool> running{false};
+        std::atomic<int> listenFd{-1};
+        std::atomic<size_t> batchesExecuted{0};
+        LatencyRecorder latency;
+
+        void HandleConnection(int fd);
+
+        void BatchLoop();
+
+        void Execute(std::vector<PendingRequest> &batch);
+
+        [[nodiscard]] BootstrapableCiphertext Pack(const std::vector<PendingRequest> &batch) const;
+
+        void Stop();
+
+    public:
+        explicit InferenceServer(const HEContext &ctx, const CkksLogisticRegression &model,
+                                 InferenceServerOptions options);
+
+        // Blocks until a client sends MSG_SHUTDOWN
+        void Serve();
+
+        [[nodiscard]] std::string GetStats() const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    // One connection per instance, so each harness thread owns its own client
+    class InferenceClient : public EncryptedObject {
+        std::unique_ptr<SocketStream> stream;
+
+    public:
+        explicit InferenceClient(const HEContext &ctx, const std::string &socketPath);
+
+        [[nodiscard]] double Predict(const std::vector<double> &features) const;
+
+        [[nodiscard]] std::string Stats() const;
+
+        void Shutdown() const;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    // Refreshes ciphertexts through the data owner: the server adds a random mask, the key holder decrypts and
+    // re-encrypts the masked values at full depth, and the server subtracts the mask again. The key holder only sees
+    // values flooded by the mask, so maskBound should dwarf the magnitude of the data
+    class ClientAidedRefresh final : public RefreshStrategy {
+        std::unique_ptr<SocketStream> stream;
+        mutable std::mutex streamMutex;
+        double maskBound;
+        mutable std::mt19937_64 rng;
+        mutable std::atomic<size_t> refreshes{0};
+
+        [[nodiscard]] std::vector<double> DrawMask(size_t slots) const;
+
+        // Sends a masked payload to the key holder and returns its fresh encryption
+        [[nodiscard]] std::string Exchange(const std::string &payload) const;
+
+    public:
+        explicit ClientAidedRefresh(const std::string &socketPath, double maskBound = 1e3);
+
+        [[nodiscard]] Ciphertext<DCRTPoly> Refresh(const CryptoContext<DCRTPoly> &cc,
+                                                  const Ciphertext<DCRTPoly> &ciphertext) const override;
+
+        // Runs the same masking round trip over plain slot values, against a key holder on a simulated context
+        [[nodiscard]] std::vector<double> SimulateRefresh(const std::vector<double> &values) const override;
+
+        [[nodiscard]] size_t GetRefreshes() const;
+
+        // Stops the key holder
+        void Shutdown() const;
+    };
+
+    // The key holder side of ClientAidedRefresh
+    class RefreshService : public EncryptedObject {
+        std::string socketPath;
+        std::atomic<bool> running{false};
+        std::atomic<int> listenFd{-1};
+
+        void HandleConnection(int fd);
+
+        [[nodiscard]] std::string Refresh(const std::string &payload) const;
+
+    public:
+        explicit RefreshService(const HEContext &ctx, std::string socketPath);
+
+        // Blocks until a client sends MSG_SHUTDOWN
+        void Serve();
+    };
+}
+
+#endif //SERVING_H
@@ -0,0 +1,86 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hermesml {
+    // Collects timed spans into a trace-event timeline, as read by chrome://tracing or Perfetto. Each thread records
+    // into its own buffer, so spans from concurrent workers never contend; nesting follows from the spans' times
+    class Tracer {
+    public:
+        struct Span {
+            std::string name;
+            int64_t start;
+            int64_t duration;
+        };
+
+    private:
+        struct ThreadSpans {
+            uint32_t thread;
+            std::vector<Span> spans;
+        };
+
+        std::chrono::steady_clock::time_point origin;
+        std::mutex mutex;
+        std::vector<ThreadSpans *> threads;
+        // Spans of threads that exited before the next Flush; their buffers are gone
+        std::vector<ThreadSpans> finished;
+        uint32_t nextThread = 0;
+
+        Tracer();
+
+        ThreadSpans &GetThreadSpans();
+
+        void Retire(ThreadSpans &spans);
+
+    public:
+        [[nodiscard]] static Tracer &Get();
+
+        // Whether TRACE_SCOPE records anything in this build
+        [[nodiscard]] static constexpr bool IsEnabled() {
+#ifdef HERMESML_TRACING
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Microseconds since the tracer started
+        [[nodiscard]] int64_t Now() const;
+
+        void Record(std::string name, int64_t start, int64_t end);
+
+        // Writes every span recorded so far as trace-event JSON and starts over. Threads must not be recording
+        void Flush(const std::string &filePath);
+    };
+
+    class TraceScope {
+        std::string name;
+        int64_t start;
+
+    public:
+        explicit TraceScope(std::string name);
+
+        ~TraceScope();
+
+        TraceScope(const TraceScope &) = delete;
+
+        TraceScope &operator=(const TraceScope &) = delete;
+    };
+}
+
+#define HERMESML_TRACE_CONCAT_(a, b) a##b
+#define HERMESML_TRACE_CONCAT(a, b) HERMESML_TRACE_CONCAT_(a, b)
+
+// Records a span from here to the end of the enclosing scope. Built without HERMESML_TRACING, it expands to nothing
+// and its name is never evaluated
+#ifdef HERMESML_TRACING
+#define TRACE_SCOPE(name) const hermesml::TraceScope HERMESML_TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+#endif //TRACING_H
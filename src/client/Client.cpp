@@ -9,10 +9,8 @@ namespace hermesml {
 
         for (auto row: data) {
             const auto pValue = this->GetCc()->MakePackedPlaintext({row});
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
-            const auto bCiphertext = BootstrapableCiphertext(
-                eRow, static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            eData.emplace_back(bCiphertext);
+            const auto eRow = this->EncryptPlaintext(pValue);
+            eData.emplace_back(this->Wrap(eRow));
         }
 
         return eData;
@@ -23,24 +21,33 @@ namespace hermesml {
 
         for (auto &row: data) {
             const auto pValue = this->GetCc()->MakePackedPlaintext(row);
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
-            const auto bCiphertext = BootstrapableCiphertext(
-                eRow, static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            eData.emplace_back(bCiphertext);
+            const auto eRow = this->EncryptPlaintext(pValue);
+            eData.emplace_back(this->Wrap(eRow));
         }
 
         return eData;
     }
 
-    std::vector<BootstrapableCiphertext> Client::EncryptCKKS(const std::vector<std::vector<double> > &data) const {
+    std::vector<int64_t> Client::Decrypt(const std::vector<BootstrapableCiphertext> &ciphertexts) const {
+        std::vector<int64_t> values;
+        values.reserve(ciphertexts.size());
+
+        Plaintext plaintext;
+        for (const auto &ciphertext: ciphertexts) {
+            this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), ciphertext.GetCiphertext(), &plaintext);
+            values.push_back(plaintext->GetPackedValue()[0]);
+        }
+
+        return values;
+    }
+
+    std::vector<BootstrapableCiphertext> Client::EncryptCKKS(const std::vector<std::vector<double> > &data,
+                                                             const uint32_t depth) const {
+        TRACE_SCOPE("EncryptCKKS");
         auto eData = std::vector<BootstrapableCiphertext>();
 
         for (auto &row: data) {
-            const auto pValue = this->GetCc()->MakeCKKSPackedPlaintext(row);
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
-            const auto bCiphertext = BootstrapableCiphertext(
-                eRow, static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            eData.emplace_back(bCiphertext);
+            eData.emplace_back(this->EncryptCKKSForDepth(row, depth));
         }
 
         return eData;
@@ -51,17 +58,69 @@ namespace hermesml {
         auto eData = std::vector<BootstrapableCiphertext>();
 
         for (auto &row: data) {
+            if (this->GetCtx().IsSimulated()) {
+                eData.emplace_back(this->SimulateEncrypt(std::vector(n_features, row)));
+                continue;
+            }
+
             const auto pValue = this->GetCc()->MakeCKKSPackedPlaintext(std::vector(n_features, row));
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
-            const auto bCiphertext = BootstrapableCiphertext(
-                eRow, static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            eData.emplace_back(bCiphertext);
+            const auto eRow = this->EncryptPlaintext(pValue);
+            eData.emplace_back(this->Wrap(eRow));
         }
 
         return eData;
     }
 
+    std::vector<BootstrapableCiphertext> Client::EncryptCKKSLabels(const std::vector<double> &labels) const {
+        TRACE_SCOPE("EncryptCKKSLabels");
+        const auto slots = this->GetCtx().GetNumSlots();
+        auto eLabels = std::vector<BootstrapableCiphertext>();
+
+        for (size_t first = 0; first < labels.size(); first += slots) {
+            const std::vector packed(labels.begin() + first, labels.begin() + std::min(labels.size(), first + slots));
+
+            if (this->GetCtx().IsSimulated()) {
+                eLabels.emplace_back(this->SimulateEncrypt(packed));
+                continue;
+            }
+
+            eLabels.emplace_back(this->Wrap(this->EncryptPlaintext(this->GetCc()->MakeCKKSPackedPlaintext(packed))));
+        }
+
+        return eLabels;
+    }
+
+    TrainingSet Client::EncryptTrainingSet(const std::vector<std::vector<double> > &features,
+                                           const std::vector<double> &labels, const LabelEncoding encoding) const {
+        TRACE_SCOPE("EncryptTrainingSet");
+        if (features.size() != labels.size()) {
+            throw std::invalid_argument("Got " + std::to_string(features.size()) + " samples but " +
+                                        std::to_string(labels.size()) + " labels");
+        }
+
+        switch (encoding) {
+            case FEATURE_SLOT_LABELS: {
+                // TrainingSet checks that the slot after the features is free
+                std::vector<std::vector<double> > rows;
+                rows.reserve(features.size());
+                for (size_t i = 0; i < features.size(); i++) {
+                    auto &row = rows.emplace_back(features[i]);
+                    row.resize(this->GetCtx().GetNumFeatures() + 1, 0.0);
+                    row.back() = labels[i];
+                }
+                return TrainingSet(this->GetCtx(), this->EncryptCKKS(rows), {}, encoding);
+            }
+            case PACKED_LABELS:
+                return TrainingSet(this->GetCtx(), this->EncryptCKKS(features), this->EncryptCKKSLabels(labels),
+                                   encoding);
+            default:
+                return TrainingSet(this->GetCtx(), this->EncryptCKKS(features),
+                                   this->EncryptCKKS(labels, this->GetCtx().GetNumFeatures()), encoding);
+        }
+    }
+
     void Client::EncryptCKKS(const std::vector<std::vector<double> > &data, const std::string &filePath) const {
+        TRACE_SCOPE("EncryptCKKS");
         if (std::ifstream(filePath)) {
             std::remove(filePath.c_str());
         }
@@ -70,7 +129,7 @@ namespace hermesml {
 
         for (auto &row: data) {
             const auto pValue = this->GetCc()->MakeCKKSPackedPlaintext(std::vector(row));
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
+            const auto eRow = this->EncryptPlaintext(pValue);
             Serial::Serialize(eRow, out, SerType::BINARY);
         }
 
@@ -79,6 +138,7 @@ namespace hermesml {
 
     void Client::EncryptCKKS(const std::vector<double> &data,
                              const size_t n_features, const std::string &filePath) const {
+        TRACE_SCOPE("EncryptCKKS");
         if (std::ifstream(filePath)) {
             std::remove(filePath.c_str());
         }
@@ -87,27 +147,116 @@ namespace hermesml {
 
         for (auto &row: data) {
             const auto pValue = this->GetCc()->MakeCKKSPackedPlaintext(std::vector(n_features, row));
-            const auto eRow = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), pValue);
+            const auto eRow = this->EncryptPlaintext(pValue);
             Serial::Serialize(eRow, out, SerType::BINARY);
         }
 
         out.close();
     }
 
+    std::vector<double> Client::DecryptCKKS(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                            const uint32_t workers) const {
+        TRACE_SCOPE("DecryptCKKS");
+        std::vector<double> values(ciphertexts.size());
+
+        if (this->GetCtx().IsSimulated()) {
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                values[i] = ciphertexts[i].GetValues()[0];
+            }
+            return values;
+        }
+
+        const auto &policy = this->GetCtx().GetThreadingPolicy();
+        policy.ParallelFor(ciphertexts.size(), workers, [this, &ciphertexts, &values](const size_t i) {
+            Plaintext plaintext;
+            this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), ciphertexts[i].GetCiphertext(), &plaintext);
+            values[i] = plaintext->GetCKKSPackedValue()[0].real();
+        });
+
+        return values;
+    }
+
+    std::vector<BootstrapableCiphertext> Client::EncryptCKKSPacked(
+        const std::vector<std::vector<double> > &data, const uint32_t depth) const {
+        TRACE_SCOPE("EncryptCKKSPacked");
+        const auto slots = this->GetCtx().GetPackingSlots();
+        const auto blockSize = this->GetCtx().GetNumSlots();
+        const auto samplesPerCiphertext = this->GetCtx().GetSamplesPerCiphertext();
+
+        if (samplesPerCiphertext == 0) {
+            throw std::runtime_error("Batched inference is not enabled in this context");
+        }
+
+        auto eData = std::vector<BootstrapableCiphertext>();
+
+        for (size_t first = 0; first < data.size(); first += samplesPerCiphertext) {
+            std::vector packed(slots, 0.0);
+
+            const auto last = std::min(data.size(), first + samplesPerCiphertext);
+            for (size_t i = first; i < last; i++) {
+                if (data[i].size() > blockSize) {
+                    throw std::invalid_argument("Row " + std::to_string(i) + " does not fit in " +
+                                                std::to_string(blockSize) + " slots");
+                }
+                std::copy(data[i].begin(), data[i].end(), packed.begin() + (i - first) * blockSize);
+            }
+
+            eData.emplace_back(this->EncryptCKKSForDepth(packed, depth, slots));
+        }
+
+        return eData;
+    }
+
+    std::vector<double> Client::DecryptPacked(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                              const size_t n_samples) const {
+        TRACE_SCOPE("DecryptPacked");
+        const auto blockSize = this->GetCtx().GetNumSlots();
+        const auto samplesPerCiphertext = this->GetCtx().GetSamplesPerCiphertext();
+
+        std::vector<double> values;
+        values.reserve(n_samples);
+
+        Plaintext plaintext;
+        for (const auto &ciphertext: ciphertexts) {
+            if (this->GetCtx().IsSimulated()) {
+                for (size_t k = 0; k < samplesPerCiphertext && values.size() < n_samples; k++) {
+                    values.push_back(ciphertext.GetValues()[k * blockSize]);
+                }
+                continue;
+            }
+
+            this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), ciphertext.GetCiphertext(), &plaintext);
+            const auto &packed = plaintext->GetCKKSPackedValue();
+
+            for (size_t k = 0; k < samplesPerCiphertext && values.size() < n_samples; k++) {
+                values.push_back(packed[k * blockSize].real());
+            }
+        }
+
+        if (values.size() != n_samples) {
+            throw std::runtime_error("Expected " + std::to_string(n_samples) + " packed values, found " +
+                                     std::to_string(values.size()));
+        }
+
+        return values;
+    }
+
     void Client::SerializeToFile(const std::string &filename, const std::vector<BootstrapableCiphertext> &vec) const {
+        TRACE_SCOPE("Serialize");
         std::ofstream outFile(filename, std::ios::binary);
 
         if (!outFile.is_open())
             throw std::runtime_error("Failed to open file for serialization: " + filename);
 
         for (auto &row: vec) {
-            Serial::Serialize(row.GetCiphertext(), outFile, SerType::BINARY);
+            this->WriteCiphertext(outFile, row);
         }
 
         outFile.close();
     }
 
     std::vector<BootstrapableCiphertext> Client::DeserializeFromFile(const std::string &filename) const {
+        TRACE_SCOPE("Deserialize");
         std::ifstream inFile(filename, std::ios::binary);
 
         if (!inFile.is_open())
@@ -116,11 +265,7 @@ namespace hermesml {
         std::vector<BootstrapableCiphertext> result;
 
         while (inFile.peek() != EOF) {
-            Ciphertext<DCRTPoly> eFeatures;
-            Serial::Deserialize(eFeatures, inFile, SerType::BINARY);
-            const auto b = BootstrapableCiphertext(
-                eFeatures, static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            result.emplace_back(b);
+            result.emplace_back(this->ReadCiphertext(inFile));
         }
 
         inFile.close();
@@ -5,7 +5,7 @@
 #include "context.h"
 
 namespace hermesml {
-    CryptoContext<DCRTPoly> HEContext::GetCc() const {
+    const CryptoContext<DCRTPoly> &HEContext::GetCc() const {
         return this->cc;
     }
 
@@ -13,7 +13,7 @@ namespace hermesml {
         this->cc = cc;
     }
 
-    PublicKey<DCRTPoly> HEContext::GetPublicKey() const {
+    const PublicKey<DCRTPoly> &HEContext::GetPublicKey() const {
         return this->publicKey;
     }
 
@@ -21,7 +21,7 @@ namespace hermesml {
         this->publicKey = publicKey;
     }
 
-    PrivateKey<DCRTPoly> HEContext::GetPrivateKey() const {
+    const PrivateKey<DCRTPoly> &HEContext::GetPrivateKey() const {
         return this->privateKey;
     }
 
@@ -76,4 +76,62 @@ namespace hermesml {
     void HEContext::SetNumFeatures(const uint32_t numFeatures) {
         this->numFeatures = numFeatures;
     }
+
+    uint32_t HEContext::GetPackingSlots() const {
+        return this->packingSlots;
+    }
+
+    void HEContext::SetPackingSlots(const uint32_t packingSlots) {
+        this->packingSlots = packingSlots;
+    }
+
+    uint32_t HEContext::GetSamplesPerCiphertext() const {
+        return this->numSlots > 0 ? this->packingSlots / this->numSlots : 0;
+    }
+
+    EncryptionMode HEContext::GetEncryptionMode() const {
+        return this->encryptionMode;
+    }
+
+    void HEContext::SetEncryptionMode(const EncryptionMode encryptionMode) {
+        this->encryptionMode = encryptionMode;
+    }
+
+    const RefreshStrategy &HEContext::GetRefreshStrategy() const {
+        static const BootstrapRefresh bootstrapRefresh;
+        return this->refreshStrategy ? *this->refreshStrategy : bootstrapRefresh;
+    }
+
+    void HEContext::SetRefreshStrategy(std::shared_ptr<const RefreshStrategy> refreshStrategy) {
+        this->refreshStrategy = std::move(refreshStrategy);
+    }
+
+    bool HEContext::IsSimulated() const {
+        return this->simulation != nullptr;
+    }
+
+    Simulation &HEContext::GetSimulation() const {
+        if (!this->simulation) {
+            throw std::runtime_error("This context is not simulated");
+        }
+        return *this->simulation;
+    }
+
+    void HEContext::SetSimulation(std::shared_ptr<Simulation> simulation) {
+        this->simulation = std::move(simulation);
+    }
+
+    const ThreadingPolicy &HEContext::GetThreadingPolicy() const {
+        return this->threadingPolicy;
+    }
+
+    void HEContext::SetThreadingPolicy(const ThreadingPolicy &threadingPolicy) {
+        this->threadingPolicy = threadingPolicy;
+        this->threadingPolicy.EnterWorker(0, 1);
+    }
+
+    Ciphertext<DCRTPoly> BootstrapRefresh::Refresh(const CryptoContext<DCRTPoly> &cc,
+                                                   const Ciphertext<DCRTPoly> &ciphertext) const {
+        return cc->EvalBootstrap(ciphertext);
+    }
 }
@@ -2,7 +2,13 @@
 // Created by rkruger on 23/10/24.
 //
 
+#include <filesystem>
+
 #include "context.h"
+#include "ciphertext-ser.h"
+#include "cryptocontext-ser.h"
+#include "key/key-ser.h"
+#include "scheme/ckksrns/ckksrns-ser.h"
 
 namespace hermesml {
     uint32_t HEContextFactory::NextPowerOfTwo(const uint32_t n) {
@@ -22,26 +28,31 @@ namespace hermesml {
         return i;
     }
 
-    HEContext HEContextFactory::ckksHeContext(const uint32_t n_features) {
-        const std::vector<uint32_t> levelBudget = {1, 1};
-        const std::vector<uint32_t> bsgsDim = {0, 0};
-        constexpr auto ringDimension = 2048;
-        constexpr auto scalingModSize = 56;
+    void HEContextFactory::SetupBootstrapping(const CryptoContext<DCRTPoly> &cc, const uint32_t numSlots,
+                                              const uint32_t packingSlots) {
+        cc->EvalBootstrapSetup(levelBudget, bsgsDim, numSlots);
+        if (packingSlots > numSlots) {
+            cc->EvalBootstrapSetup(levelBudget, bsgsDim, packingSlots);
+        }
+    }
+
+    HEContext HEContextFactory::ckksHeContext(const uint32_t n_features, const bool batchedInference) {
         const auto numSlots = NextPowerOfTwo(n_features);
+        // Sample-packed ciphertexts fill the whole ring, one numSlots-wide block per sample
+        const uint32_t packingSlots = batchedInference ? ckksRingDimension / 2 : 0;
 
         auto parameters = CCParams<CryptoContextCKKSRNS>();
         parameters.SetSecurityLevel(HEStd_NotSet);
-        parameters.SetRingDim(ringDimension);
-        parameters.SetScalingModSize(scalingModSize);
+        parameters.SetRingDim(ckksRingDimension);
+        parameters.SetScalingModSize(ckksScalingModSize);
         parameters.SetKeySwitchTechnique(HYBRID);
         parameters.SetScalingTechnique(FLEXIBLEAUTO);
         parameters.SetSecretKeyDist(UNIFORM_TERNARY);
         parameters.SetBatchSize(numSlots);
 
-        constexpr uint32_t depth = 30;
-        const uint32_t levelsAfterBootstrap = depth - FHECKKSRNS::GetBootstrapDepth(
+        const uint32_t levelsAfterBootstrap = ckksDepth - FHECKKSRNS::GetBootstrapDepth(
                                                   levelBudget, parameters.GetSecretKeyDist());
-        parameters.SetMultiplicativeDepth(depth);
+        parameters.SetMultiplicativeDepth(ckksDepth);
 
         /* https://github.com/malb/lattice-estimator
          *
@@ -65,7 +76,7 @@ namespace hermesml {
         cc->Enable(ADVANCEDSHE);
         cc->Enable(FHE);
 
-        cc->EvalBootstrapSetup(levelBudget, bsgsDim, numSlots);
+        SetupBootstrapping(cc, numSlots, packingSlots);
 
         // Key generation ---------------------------------------------------------------------------------------------
         const auto keys = cc->KeyGen();
@@ -73,6 +84,9 @@ namespace hermesml {
         cc->EvalMultKeyGen(keys.secretKey);
         cc->EvalSumKeyGen(keys.secretKey);
         cc->EvalBootstrapKeyGen(keys.secretKey, numSlots);
+        if (packingSlots > numSlots) {
+            cc->EvalBootstrapKeyGen(keys.secretKey, packingSlots);
+        }
 
         std::vector<int> rotationIndices;
         for (int i = 1; i < numSlots; i++) {
@@ -84,14 +98,175 @@ namespace hermesml {
         // Build context ----------------------------------------------------------------------------------------------
         auto ctx = HEContext();
         ctx.SetCc(cc);
-        ctx.SetScalingModSize(scalingModSize);
-        ctx.SetMultiplicativeDepth(depth);
+        ctx.SetScalingModSize(ckksScalingModSize);
+        ctx.SetMultiplicativeDepth(ckksDepth);
         ctx.SetLevelsAfterBootstrapping(levelsAfterBootstrap);
         ctx.SetNumSlots(numSlots);
         ctx.SetPublicKey(keys.publicKey);
         ctx.SetPrivateKey(keys.secretKey);
         ctx.SetNumFeatures(n_features);
+        ctx.SetPackingSlots(packingSlots);
+        ctx.SetThreadingPolicy(ThreadingPolicy::GetDefault());
+
+        return ctx;
+    }
+
+    HEContext HEContextFactory::bfvHeContext(const uint32_t n_features, const uint32_t multiplicativeDepth) {
+        constexpr auto plaintextModulusBits = 60;
+        const auto numSlots = NextPowerOfTwo(n_features);
+
+        // Batching needs t = 1 mod 2N. The ring dimension is picked by OpenFHE for the security level, so the
+        // modulus is chosen to suit every ring up to 2^16
+        constexpr uint64_t cyclotomicOrder = 1 << 17;
+        const auto plaintextModulus = FirstPrime<NativeInteger>(plaintextModulusBits, cyclotomicOrder);
+
+        auto parameters = CCParams<CryptoContextBFVRNS>();
+        parameters.SetSecurityLevel(HEStd_128_classic);
+        parameters.SetPlaintextModulus(plaintextModulus.ConvertToInt());
+        parameters.SetMultiplicativeDepth(multiplicativeDepth);
+        parameters.SetKeySwitchTechnique(HYBRID);
+        parameters.SetBatchSize(numSlots);
+
+        const auto cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(KEYSWITCH);
+        cc->Enable(LEVELEDSHE);
+        cc->Enable(ADVANCEDSHE);
+
+        // Key generation ---------------------------------------------------------------------------------------------
+        const auto keys = cc->KeyGen();
+
+        cc->EvalMultKeyGen(keys.secretKey);
+        cc->EvalSumKeyGen(keys.secretKey);
+
+        // Build context ----------------------------------------------------------------------------------------------
+        auto ctx = HEContext();
+        ctx.SetCc(cc);
+        ctx.SetMultiplicativeDepth(multiplicativeDepth);
+        ctx.SetNumSlots(numSlots);
+        ctx.SetPublicKey(keys.publicKey);
+        ctx.SetPrivateKey(keys.secretKey);
+        ctx.SetNumFeatures(n_features);
+        ctx.SetThreadingPolicy(ThreadingPolicy::GetDefault());
+
+        return ctx;
+    }
+
+    HEContext HEContextFactory::simulatedCkksHeContext(const uint32_t n_features, const bool batchedInference) {
+        const auto numSlots = NextPowerOfTwo(n_features);
+
+        auto ctx = HEContext();
+        ctx.SetScalingModSize(ckksScalingModSize);
+        ctx.SetMultiplicativeDepth(ckksDepth);
+        ctx.SetLevelsAfterBootstrapping(ckksDepth - FHECKKSRNS::GetBootstrapDepth(levelBudget, UNIFORM_TERNARY));
+        ctx.SetNumSlots(numSlots);
+        ctx.SetNumFeatures(n_features);
+        ctx.SetPackingSlots(batchedInference ? ckksRingDimension / 2 : 0);
+        ctx.SetSimulation(std::make_shared<Simulation>(ckksDepth));
+        ctx.SetThreadingPolicy(ThreadingPolicy::GetDefault());
+
+        return ctx;
+    }
+
+    void HEContextFactory::Save(const HEContext &ctx, const std::string &directory, const bool withPrivateKey) {
+        std::filesystem::create_directories(directory);
+
+        if (!Serial::SerializeToFile(directory + "/cryptocontext.bin", ctx.GetCc(), SerType::BINARY) ||
+            !Serial::SerializeToFile(directory + "/public_key.bin", ctx.GetPublicKey(), SerType::BINARY)) {
+            throw std::runtime_error("Failed to serialize the crypto context into " + directory);
+        }
+
+        if (withPrivateKey &&
+            !Serial::SerializeToFile(directory + "/private_key.bin", ctx.GetPrivateKey(), SerType::BINARY)) {
+            throw std::runtime_error("Failed to serialize the private key into " + directory);
+        }
+
+        // Rotation, summation and bootstrapping keys all live in the automorphism key map
+        std::ofstream multKeys(directory + "/eval_mult_keys.bin", std::ios::binary | std::ios::trunc);
+        std::ofstream automorphismKeys(directory + "/eval_automorphism_keys.bin", std::ios::binary | std::ios::trunc);
+
+        if (!multKeys || !ctx.GetCc()->SerializeEvalMultKey(multKeys, SerType::BINARY) ||
+            !automorphismKeys || !ctx.GetCc()->SerializeEvalAutomorphismKey(automorphismKeys, SerType::BINARY)) {
+            throw std::runtime_error("Failed to serialize the evaluation keys into " + directory);
+        }
+
+        std::ofstream parameters(directory + "/context.txt", std::ios::trunc);
+        parameters << "scalingModSize = " << ctx.GetScalingModSize() << std::endl;
+        parameters << "multiplicativeDepth = " << ctx.GetMultiplicativeDepth() << std::endl;
+        parameters << "numSlots = " << ctx.GetNumSlots() << std::endl;
+        parameters << "levelsAfterBootstrapping = " << ctx.GetLevelsAfterBootstrapping() << std::endl;
+        parameters << "earlyBootstrapping = " << ctx.GetEarlyBootstrapping() << std::endl;
+        parameters << "numFeatures = " << ctx.GetNumFeatures() << std::endl;
+        parameters << "packingSlots = " << ctx.GetPackingSlots() << std::endl;
+    }
+
+    HEContext HEContextFactory::Load(const std::string &directory, const bool withPrivateKey) {
+        CryptoContext<DCRTPoly> cc;
+        PublicKey<DCRTPoly> publicKey;
+        PrivateKey<DCRTPoly> privateKey;
+
+        if (!Serial::DeserializeFromFile(directory + "/cryptocontext.bin", cc, SerType::BINARY) ||
+            !Serial::DeserializeFromFile(directory + "/public_key.bin", publicKey, SerType::BINARY)) {
+            throw std::runtime_error("Failed to deserialize the crypto context from " + directory);
+        }
+
+        if (withPrivateKey &&
+            !Serial::DeserializeFromFile(directory + "/private_key.bin", privateKey, SerType::BINARY)) {
+            throw std::runtime_error("Failed to deserialize the private key from " + directory);
+        }
+
+        std::ifstream multKeys(directory + "/eval_mult_keys.bin", std::ios::binary);
+        std::ifstream automorphismKeys(directory + "/eval_automorphism_keys.bin", std::ios::binary);
+
+        if (!multKeys || !cc->DeserializeEvalMultKey(multKeys, SerType::BINARY) ||
+            !automorphismKeys || !cc->DeserializeEvalAutomorphismKey(automorphismKeys, SerType::BINARY)) {
+            throw std::runtime_error("Failed to deserialize the evaluation keys from " + directory);
+        }
+
+        std::ifstream parametersFile(directory + "/context.txt");
+        if (!parametersFile) {
+            throw std::runtime_error("Failed to read " + directory + "/context.txt");
+        }
+
+        std::map<std::string, uint32_t> parameters;
+        std::string name, separator;
+        uint32_t value;
+        while (parametersFile >> name >> separator >> value) {
+            parameters[name] = value;
+        }
+
+        auto ctx = HEContext();
+        ctx.SetCc(cc);
+        ctx.SetPublicKey(publicKey);
+        ctx.SetPrivateKey(privateKey);
+        ctx.SetScalingModSize(parameters.at("scalingModSize"));
+        ctx.SetMultiplicativeDepth(parameters.at("multiplicativeDepth"));
+        ctx.SetNumSlots(parameters.at("numSlots"));
+        ctx.SetLevelsAfterBootstrapping(parameters.at("levelsAfterBootstrapping"));
+        ctx.SetEarlyBootstrapping(parameters.at("earlyBootstrapping"));
+        ctx.SetNumFeatures(parameters.at("numFeatures"));
+        ctx.SetPackingSlots(parameters.at("packingSlots"));
+
+        SetupBootstrapping(cc, ctx.GetNumSlots(), ctx.GetPackingSlots());
+        ctx.SetThreadingPolicy(ThreadingPolicy::GetDefault());
+
+        return ctx;
+    }
+
+    HEContext HEContextFactory::LoadOrCreate(const std::string &directory, const uint32_t n_features,
+                                             const bool batchedInference) {
+        if (std::filesystem::exists(directory + "/context.txt")) {
+            auto ctx = Load(directory, true);
+
+            if (ctx.GetNumFeatures() != n_features || (ctx.GetPackingSlots() > 0) != batchedInference) {
+                throw std::runtime_error("The context saved in " + directory + " was created for other parameters");
+            }
+
+            return ctx;
+        }
 
+        auto ctx = ckksHeContext(n_features, batchedInference);
+        Save(ctx, directory, true);
         return ctx;
     }
 }
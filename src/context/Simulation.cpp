@@ -0,0 +1,216 @@
+#include "context.h"
+
+namespace hermesml {
+    CostModel::CostModel(std::vector<OperationCosts> costsByLevel) : costsByLevel(std::move(costsByLevel)) {
+    }
+
+    bool CostModel::IsCalibrated() const {
+        return !this->costsByLevel.empty();
+    }
+
+    uint32_t CostModel::GetLevels() const {
+        return this->costsByLevel.empty() ? 0 : static_cast<uint32_t>(this->costsByLevel.size() - 1);
+    }
+
+    double CostModel::GetCost(const SimulatedOp op, const int32_t level) const {
+        if (this->costsByLevel.empty()) {
+            return 0.0;
+        }
+
+        const auto index = std::clamp<int32_t>(level, 0, static_cast<int32_t>(this->costsByLevel.size() - 1));
+        return this->costsByLevel[index][op];
+    }
+
+    CostModel CostModel::Calibrate(const HEContext &ctx, const uint32_t repetitions) {
+        if (ctx.IsSimulated()) {
+            throw std::invalid_argument("Costs can only be measured on a real context");
+        }
+
+        const auto &cc = ctx.GetCc();
+        const auto depth = ctx.GetMultiplicativeDepth();
+        const auto values = std::vector(ctx.GetNumSlots(), 0.5);
+
+        const auto measure = [repetitions](const std::function<void()> &operation) {
+            const auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < repetitions; i++) {
+                operation();
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / repetitions;
+        };
+
+        // A product needs a level to consume, so the bottom of the chain is charged as the level above it
+        std::vector<OperationCosts> costsByLevel(depth + 1);
+        for (uint32_t level = 1; level <= depth; level++) {
+            const auto plaintext = cc->MakeCKKSPackedPlaintext(values, 1, depth - level);
+            const auto ciphertext = cc->Encrypt(ctx.GetPublicKey(), plaintext);
+
+            auto &costs = costsByLevel[level];
+            costs[SIM_ENCRYPT] = measure([&] {
+                (void) cc->Encrypt(ctx.GetPublicKey(), cc->MakeCKKSPackedPlaintext(values, 1, depth - level));
+            });
+            costs[SIM_ADD] = measure([&] { (void) cc->EvalAdd(ciphertext, ciphertext); });
+            costs[SIM_MULT] = measure([&] { (void) cc->EvalMult(ciphertext, ciphertext); });
+            costs[SIM_ROTATE] = measure([&] { (void) cc->EvalRotate(ciphertext, 1); });
+        }
+        costsByLevel[0] = costsByLevel[std::min(1u, depth)];
+
+        // A refresh always starts from the bottom of the chain, whatever level triggered it. Whatever refresh the
+        // context is configured with, as that is what the models will pay for
+        const auto exhausted = cc->Encrypt(ctx.GetPublicKey(), cc->MakeCKKSPackedPlaintext(values, 1, depth - 1));
+        const auto bootstrap = measure([&] { (void) ctx.GetRefreshStrategy().Refresh(cc, exhausted); });
+        for (auto &costs: costsByLevel) {
+            costs[SIM_BOOTSTRAP] = bootstrap;
+        }
+
+        return CostModel(std::move(costsByLevel));
+    }
+
+    void CostModel::Save(const std::string &filePath) const {
+        std::ofstream out(filePath, std::ios::trunc);
+
+        if (!out) {
+            throw std::runtime_error("Could not open " + filePath + " for writing");
+        }
+
+        out << "level";
+        for (auto op = 0; op < SIM_OPS; op++) {
+            out << "," << Simulation::GetName(static_cast<SimulatedOp>(op));
+        }
+        out << std::endl;
+
+        for (size_t level = 0; level < this->costsByLevel.size(); level++) {
+            out << level;
+            for (const auto cost: this->costsByLevel[level]) {
+                out << "," << cost;
+            }
+            out << std::endl;
+        }
+    }
+
+    CostModel CostModel::Load(const std::string &filePath) {
+        std::ifstream in(filePath);
+
+        if (!in) {
+            throw std::runtime_error("Could not read " + filePath);
+        }
+
+        const auto split = [](const std::string &line) {
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            for (std::string field; std::getline(stream, field, ',');) {
+                fields.push_back(field);
+            }
+            return fields;
+        };
+
+        // Columns are matched by name, so files written before an operation was added fail loudly
+        std::string line;
+        std::getline(in, line);
+        const auto header = split(line);
+
+        std::array<size_t, SIM_OPS> columns{};
+        for (auto op = 0; op < SIM_OPS; op++) {
+            const auto name = Simulation::GetName(static_cast<SimulatedOp>(op));
+            const auto it = std::find(header.begin(), header.end(), name);
+            if (it == header.end()) {
+                throw std::runtime_error(filePath + " has no cost for " + name);
+            }
+            columns[op] = static_cast<size_t>(it - header.begin());
+        }
+
+        std::vector<OperationCosts> costsByLevel;
+        while (std::getline(in, line)) {
+            if (line.empty()) {
+                continue;
+            }
+
+            const auto fields = split(line);
+            if (fields.size() != header.size() || std::stoul(fields[0]) != costsByLevel.size()) {
+                throw std::runtime_error(filePath + " has a malformed row for level " +
+                                         std::to_string(costsByLevel.size()));
+            }
+
+            OperationCosts costs{};
+            for (auto op = 0; op < SIM_OPS; op++) {
+                costs[op] = std::stod(fields[columns[op]]);
+            }
+            costsByLevel.push_back(costs);
+        }
+
+        return CostModel(std::move(costsByLevel));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    Simulation::Simulation(const uint32_t levels, CostModel costModel) : counts(levels + 1),
+                                                                         costModel(std::move(costModel)) {
+    }
+
+    void Simulation::Count(const SimulatedOp op, const int32_t level, const uint64_t times) {
+        const auto index = std::clamp<int32_t>(level, 0, static_cast<int32_t>(this->counts.size() - 1));
+        this->counts[index][op].fetch_add(times, std::memory_order_relaxed);
+    }
+
+    uint64_t Simulation::GetCount(const SimulatedOp op) const {
+        uint64_t total = 0;
+        for (const auto &count: this->counts) {
+            total += count[op].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t Simulation::GetCount(const SimulatedOp op, const int32_t level) const {
+        if (level < 0 || static_cast<size_t>(level) >= this->counts.size()) {
+            return 0;
+        }
+        return this->counts[level][op].load(std::memory_order_relaxed);
+    }
+
+    uint64_t Simulation::GetTotalCount() const {
+        uint64_t total = 0;
+        for (auto op = 0; op < SIM_OPS; op++) {
+            total += this->GetCount(static_cast<SimulatedOp>(op));
+        }
+        return total;
+    }
+
+    void Simulation::Reset() {
+        for (auto &level: this->counts) {
+            for (auto &count: level) {
+                count.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const CostModel &Simulation::GetCostModel() const {
+        return this->costModel;
+    }
+
+    void Simulation::SetCostModel(const CostModel &costModel) {
+        this->costModel = costModel;
+    }
+
+    double Simulation::EstimateSeconds() const {
+        double milliseconds = 0.0;
+        for (size_t level = 0; level < this->counts.size(); level++) {
+            for (auto op = 0; op < SIM_OPS; op++) {
+                const auto count = this->counts[level][op].load(std::memory_order_relaxed);
+                milliseconds += static_cast<double>(count) *
+                        this->costModel.GetCost(static_cast<SimulatedOp>(op), static_cast<int32_t>(level));
+            }
+        }
+        return milliseconds / 1000.0;
+    }
+
+    std::string Simulation::GetName(const SimulatedOp op) {
+        switch (op) {
+            case SIM_ENCRYPT: return "encrypt";
+            case SIM_ADD: return "add";
+            case SIM_MULT: return "mult";
+            case SIM_ROTATE: return "rotate";
+            case SIM_BOOTSTRAP: return "bootstrap";
+            default: throw std::invalid_argument("Unknown operation: " + std::to_string(op));
+        }
+    }
+}
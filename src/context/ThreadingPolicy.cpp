@@ -0,0 +1,231 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "context.h"
+
+namespace hermesml {
+    namespace {
+        // CPUs the process was allowed to run on when it started, before any worker narrowed its own mask
+        const std::vector<uint32_t> &AvailableCpus() {
+            static const auto cpus = [] {
+                std::vector<uint32_t> available;
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                    for (uint32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                        if (CPU_ISSET(cpu, &set)) {
+                            available.push_back(cpu);
+                        }
+                    }
+                }
+#endif
+                if (available.empty()) {
+                    for (uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+                        available.push_back(cpu);
+                    }
+                }
+                return available;
+            }();
+            return cpus;
+        }
+
+        // CPUs of every NUMA node, as sysfs lists them ("0-15,32-47"); empty when the topology is unknown
+        const std::vector<std::vector<uint32_t> > &NumaNodes() {
+            static const auto nodes = [] {
+                std::vector<std::vector<uint32_t> > found;
+                for (uint32_t node = 0;; node++) {
+                    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                    if (!in) {
+                        break;
+                    }
+
+                    std::vector<uint32_t> cpus;
+                    std::string range;
+                    while (std::getline(in, range, ',')) {
+                        const auto dash = range.find('-');
+                        const auto first = std::stoul(range.substr(0, dash));
+                        const auto last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                        for (auto cpu = first; cpu <= last; cpu++) {
+                            cpus.push_back(static_cast<uint32_t>(cpu));
+                        }
+                    }
+                    found.push_back(std::move(cpus));
+                }
+                return found;
+            }();
+            return nodes;
+        }
+
+        void PinCallingThread(const std::vector<uint32_t> &cpus) {
+#ifdef __linux__
+            if (cpus.empty()) {
+                return;
+            }
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (const auto cpu: cpus) {
+                CPU_SET(cpu, &set);
+            }
+            // OpenMP threads started from here on inherit the mask
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+        }
+
+        ThreadingPolicy &DefaultPolicy() {
+            static ThreadingPolicy policy;
+            return policy;
+        }
+    }
+
+    ThreadingPolicy::ThreadingPolicy(const uint32_t cores, const uint32_t workers,
+                                     const CoreAffinity affinity) : cores(cores), workers(workers),
+                                                                    affinity(affinity) {
+    }
+
+    uint32_t ThreadingPolicy::GetCores() const {
+        const auto available = static_cast<uint32_t>(AvailableCpus().size());
+        return this->cores > 0 ? std::min(this->cores, available) : available;
+    }
+
+    uint32_t ThreadingPolicy::GetWorkers() const {
+        return this->workers > 0 ? this->workers : this->GetCores();
+    }
+
+    CoreAffinity ThreadingPolicy::GetAffinity() const {
+        return this->affinity;
+    }
+
+    uint32_t ThreadingPolicy::ResolveWorkers(const uint32_t requested, const size_t jobs) const {
+        const auto resolved = std::max(1u, requested > 0 ? requested : this->GetWorkers());
+        return static_cast<uint32_t>(std::min<size_t>(resolved, std::max<size_t>(jobs, 1)));
+    }
+
+    uint32_t ThreadingPolicy::GetOpenMPThreads(const uint32_t workers) const {
+        return std::max(1u, this->GetCores() / std::max(1u, workers));
+    }
+
+    void ThreadingPolicy::EnterWorker(const uint32_t worker, const uint32_t workers) const {
+        const auto threads = this->GetOpenMPThreads(workers);
+
+#ifdef _OPENMP
+        omp_set_num_threads(static_cast<int>(threads));
+#endif
+
+        const auto &available = AvailableCpus();
+        const auto &nodes = NumaNodes();
+
+        // A lone worker gets the whole budget back, whatever a pool pinned this thread to before
+        if (workers <= 1 || this->affinity == NO_AFFINITY) {
+            if (this->affinity != NO_AFFINITY) {
+                PinCallingThread(available);
+            }
+            return;
+        }
+
+        switch (this->affinity) {
+            case CORE_AFFINITY: {
+                // Consecutive blocks of the budget, so that the team of a worker shares its caches
+                std::vector<uint32_t> cpus;
+                for (uint32_t k = 0; k < threads; k++) {
+                    cpus.push_back(available[(worker * threads + k) % this->GetCores()]);
+                }
+                PinCallingThread(cpus);
+                break;
+            }
+            case NUMA_AFFINITY:
+                // Workers go round the nodes, so that each one allocates and computes on the same socket
+                if (!nodes.empty()) {
+                    PinCallingThread(nodes[worker % nodes.size()]);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    void ThreadingPolicy::ParallelFor(const size_t jobs, const uint32_t requested,
+                                      const std::function<void(size_t)> &job) const {
+        const auto nWorkers = this->ResolveWorkers(requested, jobs);
+        if (nWorkers == 1) {
+            for (size_t i = 0; i < jobs; i++) {
+                job(i);
+            }
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        std::vector<std::exception_ptr> errors(nWorkers);
+        std::vector<std::thread> pool;
+        pool.reserve(nWorkers);
+
+        for (uint32_t w = 0; w < nWorkers; w++) {
+            pool.emplace_back([this, &job, &next, &errors, jobs, nWorkers, w] {
+                try {
+                    this->EnterWorker(w, nWorkers);
+                    for (auto i = next.fetch_add(1); i < jobs; i = next.fetch_add(1)) {
+                        job(i);
+                    }
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                    next = jobs;
+                }
+            });
+        }
+
+        for (auto &t: pool) {
+            t.join();
+        }
+
+        for (const auto &error: errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    ThreadingPolicy ThreadingPolicy::FromEnvironment(const ThreadingPolicy &defaults) {
+        auto policy = defaults;
+
+        if (const auto *cores = std::getenv("HERMESML_CORES")) {
+            policy.cores = std::stoul(cores);
+        }
+        if (const auto *workers = std::getenv("HERMESML_WORKERS")) {
+            policy.workers = std::stoul(workers);
+        }
+        if (const auto *affinity = std::getenv("HERMESML_AFFINITY")) {
+            const std::string value(affinity);
+            if (value == "none") {
+                policy.affinity = NO_AFFINITY;
+            } else if (value == "cores") {
+                policy.affinity = CORE_AFFINITY;
+            } else if (value == "numa") {
+                policy.affinity = NUMA_AFFINITY;
+            } else {
+                throw std::invalid_argument("HERMESML_AFFINITY must be none, cores or numa, got " + value);
+            }
+        }
+
+        return policy;
+    }
+
+    ThreadingPolicy ThreadingPolicy::GetDefault() {
+        return FromEnvironment(DefaultPolicy());
+    }
+
+    void ThreadingPolicy::SetDefault(const ThreadingPolicy &policy) {
+        DefaultPolicy() = policy;
+    }
+}
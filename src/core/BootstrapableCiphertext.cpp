@@ -9,6 +9,17 @@ namespace hermesml {
         remainingLevels(remainingLevels), additionsExecuted(additionsExecuted) {
     }
 
+    BootstrapableCiphertext::BootstrapableCiphertext(Ciphertext<DCRTPoly> &&ciphertext,
+                                                     const int32_t remainingLevels,
+                                                     const int32_t additionsExecuted) : ciphertext(std::move(ciphertext)),
+        remainingLevels(remainingLevels), additionsExecuted(additionsExecuted) {
+    }
+
+    BootstrapableCiphertext::BootstrapableCiphertext(std::vector<double> values, const int32_t remainingLevels,
+                                                     const int32_t additionsExecuted) : values(std::move(values)),
+        remainingLevels(remainingLevels), additionsExecuted(additionsExecuted) {
+    }
+
     int32_t BootstrapableCiphertext::GetRemainingLevels() const {
         return this->remainingLevels;
     }
@@ -21,7 +32,26 @@ namespace hermesml {
         return this->additionsExecuted;
     }
 
+    void BootstrapableCiphertext::SetAdditionsExecuted(const int32_t pAdditionsExecuted) {
+        this->additionsExecuted = pAdditionsExecuted;
+    }
+
     const Ciphertext<DCRTPoly> &BootstrapableCiphertext::GetCiphertext() const {
         return this->ciphertext;
     }
+
+    Ciphertext<DCRTPoly> &BootstrapableCiphertext::GetMutableCiphertext() {
+        if (this->ciphertext && this->ciphertext.use_count() > 1) {
+            this->ciphertext = this->ciphertext->Clone();
+        }
+        return this->ciphertext;
+    }
+
+    const std::vector<double> &BootstrapableCiphertext::GetValues() const {
+        return this->values;
+    }
+
+    size_t BootstrapableCiphertext::GetSizeInBytes() const {
+        return MemoryFootprint::CiphertextBytes(this->ciphertext);
+    }
 }
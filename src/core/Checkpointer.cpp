@@ -0,0 +1,151 @@
+#include <filesystem>
+#include <iomanip>
+
+#include "ciphertext-ser.h"
+#include "core.h"
+
+namespace hermesml {
+    Checkpointer::Checkpointer(const HEContext &ctx, CheckpointOptions options,
+                               std::string modelName) : EncryptedObject(ctx), options(std::move(options)),
+                                                        modelName(std::move(modelName)) {
+    }
+
+    std::string Checkpointer::GetFilePath() const {
+        return this->options.directory + "/" + this->modelName + ".ckpt";
+    }
+
+    std::string Checkpointer::GetKeyTag() const {
+        return this->GetCtx().IsSimulated() ? "simulated" : this->GetCtx().GetPublicKey()->GetKeyTag();
+    }
+
+    bool Checkpointer::IsEnabled() const {
+        return !this->options.directory.empty();
+    }
+
+    bool Checkpointer::IsDue(const TrainingCursor &cursor, const size_t samplesPerEpoch) const {
+        if (!this->IsEnabled()) {
+            return false;
+        }
+
+        if (this->options.everySamples > 0 && cursor.sample % this->options.everySamples == 0) {
+            return true;
+        }
+
+        return cursor.sample == samplesPerEpoch && this->options.everyEpochs > 0 &&
+               (cursor.epoch + 1) % this->options.everyEpochs == 0;
+    }
+
+    void Checkpointer::Save(const TrainingCursor &cursor, const std::mt19937 &rng,
+                            const std::vector<BootstrapableCiphertext> &parameters,
+                            const std::vector<double> &activationCoefficients) const {
+        TRACE_SCOPE("Checkpoint save");
+        std::filesystem::create_directories(this->options.directory);
+
+        // Written aside and renamed, so a crash while saving keeps the previous checkpoint intact
+        const auto filePath = this->GetFilePath();
+        const auto temporaryPath = filePath + ".tmp";
+
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            throw std::runtime_error("Failed to open file for serialization: " + temporaryPath);
+
+        out << this->modelName;
+        for (const auto coefficient: activationCoefficients) {
+            out << " " << std::setprecision(17) << coefficient;
+        }
+        out << "\n" << this->GetKeyTag() << "\n";
+        out << cursor.epoch << " " << cursor.sample << " " << parameters.size() << "\n";
+        out << rng << "\n";
+
+        for (const auto &parameter: parameters) {
+            out << parameter.GetRemainingLevels() << " " << parameter.GetAdditionsExecuted() << "\n";
+
+            if (this->GetCtx().IsSimulated()) {
+                const auto &values = parameter.GetValues();
+                out << values.size() << std::setprecision(17);
+                for (const auto value: values) {
+                    out << " " << value;
+                }
+                out << "\n";
+            } else {
+                Serial::Serialize(parameter.GetCiphertext(), out, SerType::BINARY);
+            }
+        }
+
+        out.close();
+
+        if (!out) {
+            throw std::runtime_error("Failed to write checkpoint " + temporaryPath);
+        }
+
+        std::filesystem::rename(temporaryPath, filePath);
+    }
+
+    bool Checkpointer::Load(TrainingCursor &cursor, std::mt19937 &rng,
+                            std::vector<BootstrapableCiphertext> &parameters,
+                            std::vector<double> &activationCoefficients) const {
+        TRACE_SCOPE("Checkpoint load");
+        if (!this->IsEnabled() || !std::filesystem::exists(this->GetFilePath())) {
+            return false;
+        }
+
+        std::ifstream in(this->GetFilePath(), std::ios::binary);
+
+        if (!in.is_open())
+            throw std::runtime_error("Failed to open file for deserialization: " + this->GetFilePath());
+
+        std::string header, name, keyTag;
+        std::getline(in, header);
+        std::getline(in, keyTag);
+
+        std::istringstream headerStream(header);
+        headerStream >> name;
+        activationCoefficients.clear();
+        for (double coefficient; headerStream >> coefficient;) {
+            activationCoefficients.push_back(coefficient);
+        }
+
+        if (name != this->modelName) {
+            throw std::runtime_error("Checkpoint " + this->GetFilePath() + " belongs to " + name);
+        }
+
+        if (keyTag != this->GetKeyTag()) {
+            throw std::runtime_error("Checkpoint " + this->GetFilePath() +
+                                     " was written under another key pair; load the context saved with it");
+        }
+
+        size_t count;
+        in >> cursor.epoch >> cursor.sample >> count >> rng;
+
+        parameters.clear();
+        parameters.reserve(count);
+
+        for (size_t i = 0; i < count; i++) {
+            int32_t remainingLevels, additionsExecuted;
+            in >> remainingLevels >> additionsExecuted;
+
+            if (this->GetCtx().IsSimulated()) {
+                size_t size;
+                in >> size;
+                std::vector<double> values(size);
+                for (auto &value: values) {
+                    in >> value;
+                }
+                parameters.emplace_back(std::move(values), remainingLevels, additionsExecuted);
+                continue;
+            }
+
+            in.get();
+            Ciphertext<DCRTPoly> ciphertext;
+            Serial::Deserialize(ciphertext, in, SerType::BINARY);
+            parameters.emplace_back(std::move(ciphertext), remainingLevels, additionsExecuted);
+        }
+
+        if (!in) {
+            throw std::runtime_error("Checkpoint " + this->GetFilePath() + " is truncated");
+        }
+
+        return true;
+    }
+}
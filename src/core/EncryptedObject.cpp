@@ -1,3 +1,7 @@
+#include <iomanip>
+#include <numeric>
+
+#include "ciphertext-ser.h"
 #include "core.h"
 
 namespace hermesml {
@@ -6,35 +10,149 @@ namespace hermesml {
         this->cc = this->ctx.GetCc();
     }
 
-    int32_t EncryptedObject::ComputeRemainingLevels(const BootstrapableCiphertext &ciphertext1,
-                                                    const BootstrapableCiphertext &ciphertext2) {
-        auto remainingLevels = ciphertext1.GetRemainingLevels();
-        if (ciphertext2.GetRemainingLevels() < remainingLevels) {
-            remainingLevels = ciphertext2.GetRemainingLevels();
+    int32_t EncryptedObject::ComputeRemainingLevels(const Ciphertext<DCRTPoly> &ciphertext) const {
+        // Read the levels straight from the ciphertext: every rescale consumed a level, and a pending rescale
+        // (noise scale degree > 1) will consume another one at the next operation
+        const auto consumedLevels = static_cast<int32_t>(ciphertext->GetLevel()) +
+                                    static_cast<int32_t>(ciphertext->GetNoiseScaleDeg()) - 1;
+        return static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()) - consumedLevels;
+    }
+
+    BootstrapableCiphertext EncryptedObject::Wrap(const Ciphertext<DCRTPoly> &ciphertext,
+                                                  const int32_t additionsExecuted) const {
+        return BootstrapableCiphertext(ciphertext, this->ComputeRemainingLevels(ciphertext), additionsExecuted);
+    }
+
+    BootstrapableCiphertext EncryptedObject::Wrap(Ciphertext<DCRTPoly> &&ciphertext,
+                                                  const int32_t additionsExecuted) const {
+        const auto remainingLevels = this->ComputeRemainingLevels(ciphertext);
+        return BootstrapableCiphertext(std::move(ciphertext), remainingLevels, additionsExecuted);
+    }
+
+    void EncryptedObject::WriteCiphertext(std::ostream &out, const BootstrapableCiphertext &ciphertext) const {
+        if (!this->GetCtx().IsSimulated()) {
+            Serial::Serialize(ciphertext.GetCiphertext(), out, SerType::BINARY);
+            return;
+        }
+
+        const auto &values = ciphertext.GetValues();
+        out << ciphertext.GetRemainingLevels() << " " << ciphertext.GetAdditionsExecuted() << " " << values.size()
+                << std::setprecision(17);
+        for (const auto value: values) {
+            out << " " << value;
+        }
+        out << "\n";
+    }
+
+    BootstrapableCiphertext EncryptedObject::ReadCiphertext(std::istream &in) const {
+        if (!this->GetCtx().IsSimulated()) {
+            Ciphertext<DCRTPoly> ciphertext;
+            Serial::Deserialize(ciphertext, in, SerType::BINARY);
+            return this->Wrap(std::move(ciphertext));
+        }
+
+        int32_t remainingLevels, additionsExecuted;
+        size_t size;
+        in >> remainingLevels >> additionsExecuted >> size;
+        std::vector<double> values(size);
+        for (auto &value: values) {
+            in >> value;
+        }
+        in.get();
+
+        if (!in) {
+            throw std::runtime_error("Truncated simulated ciphertext");
+        }
+
+        return BootstrapableCiphertext(std::move(values), remainingLevels, additionsExecuted);
+    }
+
+    BootstrapableCiphertext EncryptedObject::SimulateEncrypt(const std::vector<double> &plaintext,
+                                                             const uint32_t slots, const uint32_t levels) const {
+        // Slots past the plaintext are zero, as in a packed plaintext shorter than the batch
+        std::vector values(slots > 0 ? slots : this->GetCtx().GetNumSlots(), 0.0);
+        std::copy_n(plaintext.begin(), std::min(plaintext.size(), values.size()), values.begin());
+
+        const auto fullDepth = this->GetCtx().GetMultiplicativeDepth();
+        const auto remainingLevels = static_cast<int32_t>(levels > 0 ? levels : fullDepth);
+        this->GetCtx().GetSimulation().Count(SIM_ENCRYPT, remainingLevels);
+        return BootstrapableCiphertext(std::move(values), remainingLevels);
+    }
+
+    BootstrapableCiphertext EncryptedObject::SimulateBinary(const BootstrapableCiphertext &ciphertext1,
+                                                            const BootstrapableCiphertext &ciphertext2,
+                                                            const std::function<double(double, double)> &op,
+                                                            const SimulatedOp counted,
+                                                            const int32_t additionsExecuted) const {
+        const auto &values1 = ciphertext1.GetValues();
+        const auto &values2 = ciphertext2.GetValues();
+
+        // A narrower operand repeats over the wider one, as a numSlots batch does across the ring
+        std::vector<double> values(std::max(values1.size(), values2.size()));
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i] = op(values1[i % values1.size()], values2[i % values2.size()]);
+        }
+
+        const auto inputLevels = std::min(ciphertext1.GetRemainingLevels(), ciphertext2.GetRemainingLevels());
+        this->GetCtx().GetSimulation().Count(counted, inputLevels);
+        const auto remainingLevels = inputLevels - (counted == SIM_MULT ? 1 : 0);
+        return BootstrapableCiphertext(std::move(values), remainingLevels, additionsExecuted);
+    }
+
+    BootstrapableCiphertext EncryptedObject::EncryptCKKSForDepth(const std::vector<double> &plaintext,
+                                                                 const uint32_t depth, const uint32_t slots) const {
+        TRACE_SCOPE("Encrypt");
+        const auto fullDepth = this->GetCtx().GetMultiplicativeDepth();
+        const auto levels = depth > 0
+                                ? std::min(fullDepth, depth + this->GetCtx().GetEarlyBootstrapping() + 2)
+                                : fullDepth;
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulateEncrypt(plaintext, slots, levels);
         }
-        return remainingLevels;
+
+        // Encrypting at a lower level drops the top RNS limbs, so every operation on it runs on fewer of them
+        const auto packed = this->GetCc()->MakeCKKSPackedPlaintext(plaintext, 1, fullDepth - levels, nullptr, slots);
+        return this->Wrap(this->EncryptPlaintext(packed));
     }
 
-    CryptoContext<DCRTPoly> EncryptedObject::GetCc() const {
+    Ciphertext<DCRTPoly> EncryptedObject::EncryptPlaintext(const Plaintext &plaintext) const {
+        if (this->GetCtx().GetEncryptionMode() == PUBLIC_KEY_ENCRYPTION) {
+            return this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), plaintext);
+        }
+
+        if (!this->GetCtx().GetPrivateKey()) {
+            throw std::runtime_error("Secret-key encryption needs a context that holds the private key");
+        }
+
+        return this->GetCc()->Encrypt(this->GetCtx().GetPrivateKey(), plaintext);
+    }
+
+    const CryptoContext<DCRTPoly> &EncryptedObject::GetCc() const {
         return this->cc;
     }
 
-    HEContext EncryptedObject::GetCtx() const {
+    const HEContext &EncryptedObject::GetCtx() const {
         return this->ctx;
     }
 
     BootstrapableCiphertext EncryptedObject::Encrypt(const std::vector<int64_t> &plaintext) const {
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulateEncrypt(std::vector<double>(plaintext.begin(), plaintext.end()));
+        }
+
         const auto packed = this->GetCc()->MakePackedPlaintext(plaintext);
-        const auto bCiphertext = BootstrapableCiphertext(this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), packed),
-                                                         static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-        return bCiphertext;
+        return this->Wrap(this->EncryptPlaintext(packed));
     }
 
     BootstrapableCiphertext EncryptedObject::EncryptCKKS(const std::vector<double> &plaintext) const {
+        TRACE_SCOPE("Encrypt");
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulateEncrypt(plaintext);
+        }
+
         const auto packed = this->GetCc()->MakeCKKSPackedPlaintext(plaintext);
-        const auto bCiphertext = BootstrapableCiphertext(this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), packed),
-                                                         static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-        return bCiphertext;
+        return this->Wrap(this->EncryptPlaintext(packed));
     }
 
     std::vector<BootstrapableCiphertext> EncryptedObject::EncryptCKKS(
@@ -42,11 +160,13 @@ namespace hermesml {
         std::vector<BootstrapableCiphertext> bCiphertexts;
 
         for (auto &row: plaintext) {
+            if (this->GetCtx().IsSimulated()) {
+                bCiphertexts.emplace_back(this->SimulateEncrypt(row));
+                continue;
+            }
+
             const auto packed = this->GetCc()->MakeCKKSPackedPlaintext(row);
-            const auto bCiphertext = BootstrapableCiphertext(
-                this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), packed),
-                static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth()));
-            bCiphertexts.emplace_back(bCiphertext);
+            bCiphertexts.emplace_back(this->Wrap(this->EncryptPlaintext(packed)));
         }
 
         return bCiphertexts;
@@ -68,24 +188,98 @@ namespace hermesml {
 
     BootstrapableCiphertext EncryptedObject::EvalAdd(const BootstrapableCiphertext &ciphertext1,
                                                      const BootstrapableCiphertext &ciphertext2) const {
-        const auto c = this->GetCc()->EvalAdd(ciphertext1.GetCiphertext(), ciphertext2.GetCiphertext());
+        // Operands at different levels are aligned by OpenFHE (FLEXIBLEAUTO) with a scalar adjustment of the upper
+        // one, which is far cheaper than refreshing anything
         const auto additionsExecuted = ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted();
-        return this->EvalBootstrap(
-            BootstrapableCiphertext(c, ComputeRemainingLevels(ciphertext1, ciphertext2), additionsExecuted + 1));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->EvalBootstrap(
+                this->SimulateBinary(ciphertext1, ciphertext2, std::plus<>(), SIM_ADD, additionsExecuted + 1));
+        }
+
+        auto c = this->GetCc()->EvalAdd(ciphertext1.GetCiphertext(), ciphertext2.GetCiphertext());
+        return this->EvalBootstrap(this->Wrap(std::move(c), additionsExecuted + 1));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalAdd(BootstrapableCiphertext &&ciphertext1,
+                                                     const BootstrapableCiphertext &ciphertext2) const {
+        this->EvalAddInPlace(ciphertext1, ciphertext2);
+        return std::move(ciphertext1);
+    }
+
+    void EncryptedObject::EvalAddInPlace(BootstrapableCiphertext &ciphertext1,
+                                         const BootstrapableCiphertext &ciphertext2) const {
+        if (this->GetCtx().IsSimulated()) {
+            ciphertext1 = this->SimulateBinary(ciphertext1, ciphertext2, std::plus<>(), SIM_ADD,
+                                               ciphertext1.GetAdditionsExecuted() +
+                                               ciphertext2.GetAdditionsExecuted() + 1);
+            this->EvalBootstrapInPlace(ciphertext1);
+            return;
+        }
+
+        auto &c = ciphertext1.GetMutableCiphertext();
+        this->GetCc()->EvalAddInPlace(c, ciphertext2.GetCiphertext());
+        ciphertext1.SetRemainingLevels(this->ComputeRemainingLevels(c));
+        ciphertext1.SetAdditionsExecuted(
+            ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted() + 1);
+        this->EvalBootstrapInPlace(ciphertext1);
     }
 
     BootstrapableCiphertext EncryptedObject::EvalSum(const BootstrapableCiphertext &ciphertext1) const {
-        const auto c = this->GetCc()->EvalSum(ciphertext1.GetCiphertext(), this->GetCtx().GetNumSlots());
+        TRACE_SCOPE("EvalSum");
         const auto additionsExecuted = ciphertext1.GetAdditionsExecuted();
-        return this->EvalBootstrap(BootstrapableCiphertext(c, ciphertext1.GetRemainingLevels(), additionsExecuted + 1));
+
+        if (this->GetCtx().IsSimulated()) {
+            // Every slot ends up with the total, after one rotate-and-add per halving of the batch
+            const auto &values = ciphertext1.GetValues();
+            const auto total = std::accumulate(values.begin(), values.end(), 0.0);
+            const auto steps = static_cast<uint64_t>(std::log2(this->GetCtx().GetNumSlots()));
+            this->GetCtx().GetSimulation().Count(SIM_ROTATE, ciphertext1.GetRemainingLevels(), steps);
+            this->GetCtx().GetSimulation().Count(SIM_ADD, ciphertext1.GetRemainingLevels(), steps);
+            return this->EvalBootstrap(BootstrapableCiphertext(std::vector(values.size(), total),
+                                                               ciphertext1.GetRemainingLevels(),
+                                                               additionsExecuted + 1));
+        }
+
+        auto c = this->GetCc()->EvalSum(ciphertext1.GetCiphertext(), this->GetCtx().GetNumSlots());
+        return this->EvalBootstrap(this->Wrap(std::move(c), additionsExecuted + 1));
     }
 
     BootstrapableCiphertext EncryptedObject::EvalSub(const BootstrapableCiphertext &ciphertext1,
                                                      const BootstrapableCiphertext &ciphertext2) const {
-        const auto c = this->GetCc()->EvalSub(ciphertext1.GetCiphertext(), ciphertext2.GetCiphertext());
         const auto additionsExecuted = ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted();
-        return this->EvalBootstrap(
-            BootstrapableCiphertext(c, ComputeRemainingLevels(ciphertext1, ciphertext2), additionsExecuted + 1));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->EvalBootstrap(
+                this->SimulateBinary(ciphertext1, ciphertext2, std::minus<>(), SIM_ADD, additionsExecuted + 1));
+        }
+
+        auto c = this->GetCc()->EvalSub(ciphertext1.GetCiphertext(), ciphertext2.GetCiphertext());
+        return this->EvalBootstrap(this->Wrap(std::move(c), additionsExecuted + 1));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalSub(BootstrapableCiphertext &&ciphertext1,
+                                                     const BootstrapableCiphertext &ciphertext2) const {
+        this->EvalSubInPlace(ciphertext1, ciphertext2);
+        return std::move(ciphertext1);
+    }
+
+    void EncryptedObject::EvalSubInPlace(BootstrapableCiphertext &ciphertext1,
+                                         const BootstrapableCiphertext &ciphertext2) const {
+        if (this->GetCtx().IsSimulated()) {
+            ciphertext1 = this->SimulateBinary(ciphertext1, ciphertext2, std::minus<>(), SIM_ADD,
+                                               ciphertext1.GetAdditionsExecuted() +
+                                               ciphertext2.GetAdditionsExecuted() + 1);
+            this->EvalBootstrapInPlace(ciphertext1);
+            return;
+        }
+
+        auto &c = ciphertext1.GetMutableCiphertext();
+        this->GetCc()->EvalSubInPlace(c, ciphertext2.GetCiphertext());
+        ciphertext1.SetRemainingLevels(this->ComputeRemainingLevels(c));
+        ciphertext1.SetAdditionsExecuted(
+            ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted() + 1);
+        this->EvalBootstrapInPlace(ciphertext1);
     }
 
     Ciphertext<DCRTPoly> EncryptedObject::SafeRescaling(const Ciphertext<DCRTPoly> &ciphertext) const {
@@ -95,26 +289,189 @@ namespace hermesml {
 
     BootstrapableCiphertext EncryptedObject::EvalMult(const BootstrapableCiphertext &ciphertext1,
                                                       const BootstrapableCiphertext &ciphertext2) const {
-        const auto ciphertext = this->GetCc()->EvalMult(ciphertext1.GetCiphertext(),
-                                                        ciphertext2.GetCiphertext());
+        TRACE_SCOPE("EvalMult");
         const auto additionsExecuted = ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted();
-        const int decLevels = ComputeRemainingLevels(ciphertext1, ciphertext2) - 1;
 
-        return this->EvalBootstrap(
-            BootstrapableCiphertext(ciphertext, static_cast<int8_t>(decLevels), additionsExecuted));
+        if (this->GetCtx().IsSimulated()) {
+            return this->EvalBootstrap(
+                this->SimulateBinary(ciphertext1, ciphertext2, std::multiplies<>(), SIM_MULT, additionsExecuted));
+        }
+
+        auto ciphertext = this->GetCc()->EvalMult(ciphertext1.GetCiphertext(), ciphertext2.GetCiphertext());
+        return this->EvalBootstrap(this->Wrap(std::move(ciphertext), additionsExecuted));
     }
 
-    BootstrapableCiphertext EncryptedObject::EvalBootstrap(const BootstrapableCiphertext &ciphertext) const {
-        if ((ciphertext.GetRemainingLevels() - this->GetCtx().GetEarlyBootstrapping()) <= 1) {
-            const auto ciphertext2 = this->GetCc()->EvalBootstrap(ciphertext.GetCiphertext());
-            return BootstrapableCiphertext(this->SafeRescaling(ciphertext2),
-                                           static_cast<int32_t>(this->GetCtx().GetLevelsAfterBootstrapping()));
+    void EncryptedObject::EvalMultInPlace(BootstrapableCiphertext &ciphertext1,
+                                          const BootstrapableCiphertext &ciphertext2) const {
+        TRACE_SCOPE("EvalMult");
+        const auto additionsExecuted = ciphertext1.GetAdditionsExecuted() + ciphertext2.GetAdditionsExecuted();
+
+        if (this->GetCtx().IsSimulated()) {
+            ciphertext1 = this->SimulateBinary(ciphertext1, ciphertext2, std::multiplies<>(), SIM_MULT,
+                                               additionsExecuted);
+        } else {
+            // Multiplies and relinearizes into the operand's own polynomials; FLEXIBLEAUTO rescales on its next use.
+            // Holding the second handle first makes a squaring clone, instead of overwriting its own input
+            const auto operand = ciphertext2.GetCiphertext();
+            auto &c = ciphertext1.GetMutableCiphertext();
+            this->GetCc()->EvalMultInPlace(c, operand);
+            ciphertext1.SetRemainingLevels(this->ComputeRemainingLevels(c));
+            ciphertext1.SetAdditionsExecuted(additionsExecuted);
         }
 
-        return ciphertext;
+        this->EvalBootstrapInPlace(ciphertext1);
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalInnerProduct(
+        const std::vector<BootstrapableCiphertext> &ciphertexts1,
+        const std::vector<BootstrapableCiphertext> &ciphertexts2) const {
+        TRACE_SCOPE("EvalInnerProduct");
+        if (ciphertexts1.empty() || ciphertexts1.size() != ciphertexts2.size()) {
+            throw std::invalid_argument("Cannot pair " + std::to_string(ciphertexts1.size()) + " ciphertexts with " +
+                                        std::to_string(ciphertexts2.size()));
+        }
+
+        int32_t additionsExecuted = static_cast<int32_t>(ciphertexts1.size()) - 1;
+        auto remainingLevels = std::numeric_limits<int32_t>::max();
+        for (size_t i = 0; i < ciphertexts1.size(); i++) {
+            additionsExecuted += ciphertexts1[i].GetAdditionsExecuted() + ciphertexts2[i].GetAdditionsExecuted();
+            remainingLevels = std::min({remainingLevels, ciphertexts1[i].GetRemainingLevels(),
+                                        ciphertexts2[i].GetRemainingLevels()});
+        }
+
+        if (this->GetCtx().IsSimulated()) {
+            auto sum = this->SimulateBinary(ciphertexts1[0], ciphertexts2[0], std::multiplies<>(), SIM_MULT,
+                                            additionsExecuted);
+            for (size_t i = 1; i < ciphertexts1.size(); i++) {
+                // Unrelinearized products cost about as much as additions; only the one key switch is a product
+                const auto product = this->SimulateBinary(ciphertexts1[i], ciphertexts2[i], std::multiplies<>(),
+                                                          SIM_ADD, 0);
+                sum = this->SimulateBinary(sum, product, std::plus<>(), SIM_ADD, additionsExecuted);
+            }
+            sum.SetRemainingLevels(remainingLevels - 1);
+            return this->EvalBootstrap(std::move(sum));
+        }
+
+        const auto &cc = this->GetCc();
+        auto sum = cc->EvalMultNoRelin(ciphertexts1[0].GetCiphertext(), ciphertexts2[0].GetCiphertext());
+        for (size_t i = 1; i < ciphertexts1.size(); i++) {
+            cc->EvalAddInPlace(sum, cc->EvalMultNoRelin(ciphertexts1[i].GetCiphertext(),
+                                                        ciphertexts2[i].GetCiphertext()));
+        }
+        cc->RelinearizeInPlace(sum);
+
+        return this->EvalBootstrap(this->Wrap(std::move(sum), additionsExecuted));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalLinearWSum(const std::vector<BootstrapableCiphertext> &ciphertexts,
+                                                            const std::vector<double> &weights) const {
+        TRACE_SCOPE("EvalLinearWSum");
+        if (ciphertexts.empty() || ciphertexts.size() != weights.size()) {
+            throw std::invalid_argument("Cannot weight " + std::to_string(ciphertexts.size()) + " ciphertexts with " +
+                                        std::to_string(weights.size()) + " weights");
+        }
+
+        int32_t additionsExecuted = static_cast<int32_t>(ciphertexts.size()) - 1;
+        auto remainingLevels = std::numeric_limits<int32_t>::max();
+        auto unitWeights = true;
+        for (size_t i = 0; i < ciphertexts.size(); i++) {
+            additionsExecuted += ciphertexts[i].GetAdditionsExecuted();
+            remainingLevels = std::min(remainingLevels, ciphertexts[i].GetRemainingLevels());
+            unitWeights = unitWeights && std::abs(weights[i]) == 1.0;
+        }
+
+        // The additions start from a positive term, so nothing needs negating
+        const auto first = static_cast<size_t>(std::find(weights.begin(), weights.end(), 1.0) - weights.begin());
+        unitWeights = unitWeights && first < weights.size();
+
+        if (this->GetCtx().IsSimulated()) {
+            size_t width = 0;
+            for (const auto &ciphertext: ciphertexts) {
+                width = std::max(width, ciphertext.GetValues().size());
+            }
+
+            std::vector values(width, 0.0);
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                const auto &terms = ciphertexts[i].GetValues();
+                for (size_t j = 0; j < width; j++) {
+                    values[j] += weights[i] * terms[j % terms.size()];
+                }
+            }
+
+            // Constant products cost about as much as additions
+            const auto terms = ciphertexts.size();
+            this->GetCtx().GetSimulation().Count(SIM_ADD, remainingLevels, unitWeights ? terms - 1 : 2 * terms - 1);
+            return this->EvalBootstrap(BootstrapableCiphertext(std::move(values),
+                                                               remainingLevels - (unitWeights ? 0 : 1),
+                                                               additionsExecuted));
+        }
+
+        const auto &cc = this->GetCc();
+
+        if (unitWeights) {
+            auto sum = ciphertexts[first].GetCiphertext()->Clone();
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                if (i == first) {
+                    continue;
+                }
+                if (weights[i] > 0) {
+                    cc->EvalAddInPlace(sum, ciphertexts[i].GetCiphertext());
+                } else {
+                    cc->EvalSubInPlace(sum, ciphertexts[i].GetCiphertext());
+                }
+            }
+            return this->EvalBootstrap(this->Wrap(std::move(sum), additionsExecuted));
+        }
+
+        std::vector<ConstCiphertext<DCRTPoly> > terms;
+        terms.reserve(ciphertexts.size());
+        for (const auto &ciphertext: ciphertexts) {
+            terms.emplace_back(ciphertext.GetCiphertext());
+        }
+
+        return this->EvalBootstrap(this->Wrap(cc->EvalLinearWSum(terms, weights), additionsExecuted));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalBootstrap(const BootstrapableCiphertext &ciphertext,
+                                                           const int32_t levelsRequired) const {
+        auto bootstrapped = ciphertext;
+        this->EvalBootstrapInPlace(bootstrapped, levelsRequired);
+        return bootstrapped;
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalBootstrap(BootstrapableCiphertext &&ciphertext,
+                                                           const int32_t levelsRequired) const {
+        this->EvalBootstrapInPlace(ciphertext, levelsRequired);
+        return std::move(ciphertext);
+    }
+
+    void EncryptedObject::EvalBootstrapInPlace(BootstrapableCiphertext &ciphertext,
+                                               const int32_t levelsRequired) const {
+        const auto remainingLevels = ciphertext.GetRemainingLevels() - levelsRequired;
+
+        if ((remainingLevels - static_cast<int32_t>(this->GetCtx().GetEarlyBootstrapping())) <= 1) {
+            TRACE_SCOPE("EvalBootstrap");
+            if (this->GetCtx().IsSimulated()) {
+                this->GetCtx().GetSimulation().Count(SIM_BOOTSTRAP, ciphertext.GetRemainingLevels());
+                ciphertext = BootstrapableCiphertext(
+                    this->GetCtx().GetRefreshStrategy().SimulateRefresh(ciphertext.GetValues()),
+                    static_cast<int32_t>(this->GetCtx().GetLevelsAfterBootstrapping()));
+                return;
+            }
+
+            const auto &refresh = this->GetCtx().GetRefreshStrategy();
+            ciphertext = this->Wrap(this->SafeRescaling(refresh.Refresh(this->GetCc(), ciphertext.GetCiphertext())));
+        }
     }
 
     void EncryptedObject::Snoop(const BootstrapableCiphertext &ciphertext) const {
+        if (this->GetCtx().IsSimulated()) {
+            const auto &values = ciphertext.GetValues();
+            const auto n = std::min<size_t>(this->GetCtx().GetNumFeatures(), values.size());
+            std::cout << std::vector(values.begin(), values.begin() + n) << std::endl;
+            return;
+        }
+
         Plaintext plaintext;
         this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), ciphertext.GetCiphertext(), &plaintext);
         std::cout << UnpackValues(plaintext) << std::endl;
@@ -128,6 +485,7 @@ namespace hermesml {
         const BootstrapableCiphertext &weights,
         const BootstrapableCiphertext &features,
         const BootstrapableCiphertext &bias) const {
+        TRACE_SCOPE("WeightedSum");
         /* Use only for debugging
         std::cout << "Features:" << std::flush;
         this->Snoop(features, 30);
@@ -146,34 +504,171 @@ namespace hermesml {
 
     BootstrapableCiphertext EncryptedObject::EvalMerge(
         const std::vector<BootstrapableCiphertext> &ciphertexts) const {
+        TRACE_SCOPE("EvalMerge");
+        if (this->GetCtx().IsSimulated()) {
+            // Slot i takes the first slot of input i, each masked, rotated into place and added
+            std::vector values(this->GetCtx().GetNumSlots(), 0.0);
+            auto remainingLevels = std::numeric_limits<int32_t>::max();
+            for (size_t i = 0; i < ciphertexts.size(); i++) {
+                if (i < values.size()) {
+                    values[i] = ciphertexts[i].GetValues()[0];
+                }
+                remainingLevels = std::min(remainingLevels, ciphertexts[i].GetRemainingLevels());
+            }
+
+            this->GetCtx().GetSimulation().Count(SIM_ROTATE, remainingLevels, ciphertexts.size());
+            this->GetCtx().GetSimulation().Count(SIM_ADD, remainingLevels, ciphertexts.size());
+            return BootstrapableCiphertext(std::move(values), remainingLevels - 1);
+        }
+
         std::vector<Ciphertext<DCRTPoly> > ciphertextsToMerge;
-        auto minRemainingLevel = static_cast<int32_t>(this->GetCtx().GetMultiplicativeDepth());
+        ciphertextsToMerge.reserve(ciphertexts.size());
         for (const auto &c: ciphertexts) {
             ciphertextsToMerge.emplace_back(c.GetCiphertext());
-            if (c.GetRemainingLevels() < minRemainingLevel) {
-                minRemainingLevel = c.GetRemainingLevels();
+        }
+
+        // Merging masks every input, so the result sits one level below the lowest input
+        return this->Wrap(this->GetCc()->EvalMerge(ciphertextsToMerge));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalFlatten(const BootstrapableCiphertext &ciphertext) const {
+        TRACE_SCOPE("EvalFlatten");
+        if (this->GetCtx().IsSimulated()) {
+            const auto slots = this->GetCtx().GetNumSlots();
+            this->GetCtx().GetSimulation().Count(SIM_ROTATE, ciphertext.GetRemainingLevels(), slots);
+            this->GetCtx().GetSimulation().Count(SIM_ADD, ciphertext.GetRemainingLevels(), slots);
+            return BootstrapableCiphertext(std::vector(slots, ciphertext.GetValues()[0]),
+                                           ciphertext.GetRemainingLevels() - 1);
+        }
+
+        // Replicate the handle only, not the wrapper: EvalMerge needs one entry per slot
+        const std::vector valuesToReplicate(this->GetCtx().GetNumSlots(), ciphertext.GetCiphertext());
+        return this->Wrap(this->GetCc()->EvalMerge(valuesToReplicate));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalMask(const BootstrapableCiphertext &ciphertext,
+                                                      const std::vector<double> &mask) const {
+        BootstrapableCiphertext masked;
+
+        if (this->GetCtx().IsSimulated()) {
+            auto values = ciphertext.GetValues();
+            for (size_t i = 0; i < values.size(); i++) {
+                values[i] *= i < mask.size() ? mask[i] : 0.0;
             }
+
+            // A plaintext product needs no key switch, so it costs about as much as an addition
+            this->GetCtx().GetSimulation().Count(SIM_ADD, ciphertext.GetRemainingLevels());
+            masked = BootstrapableCiphertext(std::move(values), ciphertext.GetRemainingLevels() - 1,
+                                             ciphertext.GetAdditionsExecuted());
+        } else {
+            const auto pMask = this->GetCc()->MakeCKKSPackedPlaintext(mask);
+            masked = this->Wrap(this->GetCc()->EvalMult(ciphertext.GetCiphertext(), pMask),
+                                ciphertext.GetAdditionsExecuted());
+        }
+
+        // Both paths share the bootstrap check, so simulations count the refreshes a real run makes
+        return this->EvalBootstrap(std::move(masked));
+    }
+
+    BootstrapableCiphertext EncryptedObject::EvalSegmentSum(const BootstrapableCiphertext &ciphertext,
+                                                            const uint32_t segmentSize) const {
+        // Rotate-and-sum within each segment: after log2(segmentSize) steps the first slot of every segment holds
+        // the sum of that segment
+        auto sum = ciphertext;
+        for (uint32_t step = 1; step < segmentSize; step <<= 1) {
+            this->EvalAddInPlace(sum, this->EvalRotate(sum, static_cast<int32_t>(step)));
         }
+        return sum;
+    }
 
-        const auto mergedCiphertexts = this->GetCc()->EvalMerge(ciphertextsToMerge);
-        const auto b = BootstrapableCiphertext(mergedCiphertexts, minRemainingLevel - 1);
+    BootstrapableCiphertext EncryptedObject::EvalReplicate(const BootstrapableCiphertext &ciphertext,
+                                                           const uint32_t count) const {
+        TRACE_SCOPE("EvalReplicate");
+        // `block` holds the value in its first `width` slots; the blocks matching the bits of count are laid side by
+        // side, so exactly count slots are filled
+        auto block = ciphertext;
+        BootstrapableCiphertext replicated;
+        uint32_t filled = 0;
+
+        for (uint32_t width = 1; width <= count; width <<= 1) {
+            if (count & width) {
+                auto placed = filled > 0 ? this->EvalRotate(block, -static_cast<int32_t>(filled)) : block;
+                if (filled == 0) {
+                    replicated = std::move(placed);
+                } else {
+                    this->EvalAddInPlace(replicated, placed);
+                }
+                filled += width;
+            }
 
-        return b;
+            if (width <= count / 2) {
+                this->EvalAddInPlace(block, this->EvalRotate(block, -static_cast<int32_t>(width)));
+            }
+        }
+
+        return filled > 0 ? replicated : ciphertext;
     }
 
-    BootstrapableCiphertext EncryptedObject::EvalFlatten(const BootstrapableCiphertext &ciphertext) const {
-        std::vector<BootstrapableCiphertext> valuesToReplicate;
+    BootstrapableCiphertext EncryptedObject::EvalMergePacked(
+        const std::vector<BootstrapableCiphertext> &ciphertexts, const uint32_t segmentSize) const {
+        const auto slots = this->GetCtx().GetPackingSlots();
+
+        if (slots == 0) {
+            throw std::runtime_error("Batched inference is not enabled in this context");
+        }
+
+        if (ciphertexts.empty() || ciphertexts.size() > segmentSize) {
+            throw std::invalid_argument(
+                "Cannot merge " + std::to_string(ciphertexts.size()) + " values into segments of " +
+                std::to_string(segmentSize) + " slots");
+        }
 
-        for (auto i = 0; i < this->GetCtx().GetNumSlots(); i++) {
-            valuesToReplicate.emplace_back(ciphertext);
+        // Keep the first slot of every segment, then shift value j to offset j inside its segment
+        std::vector mask(slots, 0.0);
+        for (size_t i = 0; i < slots; i += segmentSize) {
+            mask[i] = 1.0;
+        }
+        const auto simulated = this->GetCtx().IsSimulated();
+        const auto pMask = simulated ? Plaintext() : this->GetCc()->MakeCKKSPackedPlaintext(mask, 1, 0, nullptr, slots);
+        const auto sMask = BootstrapableCiphertext(mask, std::numeric_limits<int32_t>::max());
+
+        BootstrapableCiphertext merged;
+        for (size_t j = 0; j < ciphertexts.size(); j++) {
+            const auto source = this->EvalBootstrap(ciphertexts[j], 1);
+            auto masked = simulated
+                              ? this->SimulateBinary(source, sMask, std::multiplies<>(), SIM_MULT,
+                                                     source.GetAdditionsExecuted())
+                              : this->Wrap(this->GetCc()->EvalMult(source.GetCiphertext(), pMask),
+                                           source.GetAdditionsExecuted());
+
+            if (j == 0) {
+                merged = std::move(masked);
+            } else {
+                this->EvalAddInPlace(merged, this->EvalRotate(masked, -static_cast<int32_t>(j)));
+            }
         }
 
-        return this->EvalMerge(valuesToReplicate);
+        return this->EvalBootstrap(std::move(merged));
     }
 
     BootstrapableCiphertext EncryptedObject::EvalRotate(const BootstrapableCiphertext &ciphertext,
                                                         const int32_t index) const {
-        return BootstrapableCiphertext(this->GetCc()->EvalRotate(ciphertext.GetCiphertext(), index),
-                                       ciphertext.GetRemainingLevels());
+        TRACE_SCOPE("EvalRotate");
+        if (this->GetCtx().IsSimulated()) {
+            const auto &values = ciphertext.GetValues();
+            const auto n = static_cast<int64_t>(values.size());
+
+            std::vector<double> rotated(values.size());
+            for (int64_t i = 0; i < n; i++) {
+                rotated[i] = values[((i + index) % n + n) % n];
+            }
+
+            this->GetCtx().GetSimulation().Count(SIM_ROTATE, ciphertext.GetRemainingLevels());
+            return BootstrapableCiphertext(std::move(rotated), ciphertext.GetRemainingLevels(),
+                                           ciphertext.GetAdditionsExecuted());
+        }
+
+        return this->Wrap(this->GetCc()->EvalRotate(ciphertext.GetCiphertext(), index),
+                          ciphertext.GetAdditionsExecuted());
     }
 }
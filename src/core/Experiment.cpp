@@ -1,10 +1,15 @@
 #include <filesystem>
+#include <numeric>
 #include <utility>
 #include "core.h"
 #include "spdlog/sinks/basic_file_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
 namespace hermesml {
+    double RuntimeEstimate::GetTotalSeconds() const {
+        return this->encryptingSeconds + this->trainingSeconds + this->testingSeconds;
+    }
+
     Experiment::Experiment(std::string experimentId, Dataset &dataset) : experimentId(std::move(experimentId)),
                                                                          dataset(dataset) {
         auto console_sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
@@ -29,6 +34,148 @@ namespace hermesml {
         return this->contentPath + fileName;
     }
 
+    std::string Experiment::BuildCheckpointPath() const {
+        return std::filesystem::current_path().string() + "/Checkpoints/" + this->dataset.GetName() + "/" +
+               this->experimentId;
+    }
+
+    void Experiment::SampleMemory(const std::string &stage, const size_t liveCiphertextBytes) {
+        const auto sample = MemorySample{
+            stage, liveCiphertextBytes, MemoryFootprint::CurrentRss(), MemoryFootprint::PeakRss()
+        };
+        this->memorySamples.emplace_back(sample);
+
+        this->Info("Memory (" + stage + "): ciphertexts " + std::to_string(sample.liveCiphertextBytes) +
+                   " bytes, RSS " + std::to_string(sample.currentRss) + " bytes, peak RSS " +
+                   std::to_string(sample.peakRss) + " bytes");
+    }
+
+    const std::vector<MemorySample> &Experiment::GetMemorySamples() const {
+        return this->memorySamples;
+    }
+
+    ClassificationMetrics Experiment::WritePredictions(const std::vector<double> &predictions,
+                                                       const std::vector<double> &labels,
+                                                       const double threshold) const {
+        if (predictions.size() != labels.size()) {
+            throw std::invalid_argument(
+                "The number of predictions must match the number of labels. (" +
+                std::to_string(predictions.size()) + " vs " + std::to_string(labels.size()) + ")");
+        }
+
+        ClassificationMetrics metrics;
+        std::ostringstream buffer;
+
+        for (size_t i = 0; i < predictions.size(); i++) {
+            const auto predictedLabel = predictions[i] > threshold ? 1.0 : 0.0;
+            const auto positive = predictedLabel == 1.0;
+            const auto correct = predictedLabel == labels[i];
+
+            if (positive) {
+                correct ? metrics.truePositives++ : metrics.falsePositives++;
+            } else {
+                correct ? metrics.trueNegatives++ : metrics.falseNegatives++;
+            }
+
+            buffer << predictions[i] << "," << labels[i] << "," << predictedLabel << '\n';
+        }
+
+        const auto ratio = [](const size_t numerator, const size_t denominator) {
+            return denominator > 0 ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.0;
+        };
+
+        metrics.accuracy = ratio(metrics.truePositives + metrics.trueNegatives, predictions.size());
+        metrics.precision = ratio(metrics.truePositives, metrics.truePositives + metrics.falsePositives);
+        metrics.recall = ratio(metrics.truePositives, metrics.truePositives + metrics.falseNegatives);
+        metrics.f1 = metrics.precision + metrics.recall > 0.0
+                         ? 2.0 * metrics.precision * metrics.recall / (metrics.precision + metrics.recall)
+                         : 0.0;
+
+        const auto predictionsFileName = this->BuildFilePath("predictions.csv");
+        std::ofstream predictionsFile(predictionsFileName, std::ios::trunc);
+
+        if (!predictionsFile) {
+            this->Error("Could not open the file " + predictionsFileName + " for writing.\n");
+            return metrics;
+        }
+
+        predictionsFile << buffer.str();
+        predictionsFile.close();
+
+        this->Info("Accuracy: " + std::to_string(metrics.accuracy) + ", precision: " +
+                   std::to_string(metrics.precision) + ", recall: " + std::to_string(metrics.recall) + ", F1: " +
+                   std::to_string(metrics.f1));
+
+        return metrics;
+    }
+
+    void Experiment::WriteMetrics(std::ostream &out, const ClassificationMetrics &metrics) {
+        out << "accuracy = " << std::to_string(metrics.accuracy) << std::endl;
+        out << "precision = " << std::to_string(metrics.precision) << std::endl;
+        out << "recall = " << std::to_string(metrics.recall) << std::endl;
+        out << "f1 = " << std::to_string(metrics.f1) << std::endl;
+    }
+
+    ProgressCallback Experiment::TrackProgress(const std::string &stage, const double estimatedSeconds) const {
+        const auto start = std::chrono::steady_clock::now();
+        auto reported = std::make_shared<size_t>(0);
+
+        return [this, stage, estimatedSeconds, start, reported](const size_t done, const size_t total) {
+            // Every 5% is enough to follow a run of hours without flooding the log
+            const auto percent = total > 0 ? 100 * done / total : 0;
+            if (percent < *reported + 5 && done < total) {
+                return;
+            }
+            *reported = percent;
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const auto fraction = static_cast<double>(done) / static_cast<double>(total);
+            const auto measuredSeconds = elapsed.count() / fraction;
+            const auto projectedSeconds = estimatedSeconds > 0.0
+                                              ? fraction * measuredSeconds + (1.0 - fraction) * estimatedSeconds
+                                              : measuredSeconds;
+
+            this->Info(stage + ": " + std::to_string(percent) + "% (" + std::to_string(done) + "/" +
+                       std::to_string(total) + "), elapsed " + std::to_string(elapsed.count()) + " s, ETA " +
+                       std::to_string(std::max(0.0, projectedSeconds - elapsed.count())) + " s");
+        };
+    }
+
+    void Experiment::DumpMemory(const HEContext &ctx) const {
+        const auto memoryFileName = this->BuildFilePath("memory.csv");
+        std::ofstream memoryFile(memoryFileName, std::ios::trunc);
+
+        if (!memoryFile) {
+            this->Error("Could not open the file " + memoryFileName + " for writing.\n");
+            return;
+        }
+
+        memoryFile << "stage,liveCiphertextBytes,currentRss,peakRss" << std::endl;
+        for (const auto &sample: this->memorySamples) {
+            memoryFile << sample.stage << "," << sample.liveCiphertextBytes << "," << sample.currentRss << ","
+                    << sample.peakRss << std::endl;
+        }
+
+        memoryFile.close();
+
+        const auto levelsFileName = this->BuildFilePath("ciphertext_sizes.csv");
+        std::ofstream levelsFile(levelsFileName, std::ios::trunc);
+
+        if (!levelsFile) {
+            this->Error("Could not open the file " + levelsFileName + " for writing.\n");
+            return;
+        }
+
+        const auto bytesByLevel = MemoryFootprint::CiphertextBytesByLevel(ctx);
+
+        levelsFile << "level,serializedBytes" << std::endl;
+        for (size_t level = 0; level < bytesByLevel.size(); level++) {
+            levelsFile << level << "," << bytesByLevel[level] << std::endl;
+        }
+
+        levelsFile.close();
+    }
+
     Dataset &Experiment::GetDataset() const {
         return this->dataset;
     }
@@ -49,6 +196,102 @@ namespace hermesml {
         this->logger->error(message);
     }
 
+    RuntimeEstimate Experiment::Simulate(const CostModel &) const {
+        return {};
+    }
+
+    RuntimeEstimate Experiment::Estimate(const CostModel &costModel) {
+        this->estimate = costModel.IsCalibrated() ? this->Simulate(costModel) : RuntimeEstimate();
+        return this->estimate;
+    }
+
+    const RuntimeEstimate &Experiment::GetEstimate() const {
+        return this->estimate;
+    }
+
     void Experiment::Run() {
     }
+
+    //-----------------------------------------------------------------------------------------------------------------
+
+    void ExperimentSweep::Add(std::unique_ptr<Experiment> experiment) {
+        this->experiments.push_back(std::move(experiment));
+    }
+
+    void ExperimentSweep::Run() {
+        const auto *costsVariable = std::getenv("HERMESML_COSTS");
+        const auto costsFile = costsVariable ? std::string(costsVariable) : std::string("operation_costs.csv");
+
+        CostModel costModel;
+        if (costsVariable || std::filesystem::exists(costsFile)) {
+            costModel = CostModel::Load(costsFile);
+        }
+
+        uint32_t shard = 0, shards = 1;
+        if (const auto *shardVariable = std::getenv("HERMESML_SHARD")) {
+            const std::string value(shardVariable);
+            const auto separator = value.find('/');
+            if (separator == std::string::npos) {
+                throw std::invalid_argument("HERMESML_SHARD must be written as shard/shards, got " + value);
+            }
+            shard = std::stoul(value.substr(0, separator));
+            shards = std::stoul(value.substr(separator + 1));
+        }
+
+        this->Run(costModel, shard, shards);
+    }
+
+    void ExperimentSweep::Run(const CostModel &costModel, const uint32_t shard, const uint32_t shards) {
+        if (shards == 0 || shard >= shards) {
+            throw std::invalid_argument("Shard " + std::to_string(shard) + " is not one of " +
+                                        std::to_string(shards));
+        }
+
+        std::vector<double> seconds(this->experiments.size(), 0.0);
+        if (costModel.IsCalibrated()) {
+            for (size_t i = 0; i < this->experiments.size(); i++) {
+                seconds[i] = this->experiments[i]->Estimate(costModel).GetTotalSeconds();
+            }
+        }
+
+        // Longest processing time first: each experiment goes to the shard that is least loaded so far
+        std::vector<size_t> order(this->experiments.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (costModel.IsCalibrated()) {
+            std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+                return seconds[a] > seconds[b];
+            });
+        }
+
+        std::vector loads(shards, 0.0);
+        std::vector<size_t> assigned;
+        for (size_t k = 0; k < order.size(); k++) {
+            const auto target = costModel.IsCalibrated()
+                                    ? static_cast<uint32_t>(std::min_element(loads.begin(), loads.end()) -
+                                                            loads.begin())
+                                    : static_cast<uint32_t>(k % shards);
+            loads[target] += seconds[order[k]];
+            if (target == shard) {
+                assigned.push_back(order[k]);
+            }
+        }
+
+        if (costModel.IsCalibrated()) {
+            std::reverse(assigned.begin(), assigned.end());
+        }
+
+        for (const auto i: assigned) {
+            auto &experiment = *this->experiments[i];
+            if (costModel.IsCalibrated()) {
+                experiment.Info("Estimated run time of " + experiment.GetExperimentId() + ": " +
+                                std::to_string(seconds[i]) + " s, shard " + std::to_string(shard) + " total " +
+                                std::to_string(loads[shard]) + " s");
+            }
+            // Each experiment reports its own peak, not the largest one run before it in this process
+            if (!MemoryFootprint::ResetPeakRss()) {
+                experiment.Info("Could not reset the peak RSS; it covers the whole process");
+            }
+            experiment.Run();
+        }
+    }
 }
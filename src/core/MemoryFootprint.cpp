@@ -0,0 +1,96 @@
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "ciphertext-ser.h"
+#include "core.h"
+
+namespace hermesml {
+    size_t MemoryFootprint::CiphertextBytes(const Ciphertext<DCRTPoly> &ciphertext) {
+        if (!ciphertext) {
+            return 0;
+        }
+
+        // Every element is a DCRT polynomial: one 64-bit word per coefficient, per RNS tower
+        size_t bytes = 0;
+        for (const auto &element: ciphertext->GetElements()) {
+            bytes += element.GetNumOfElements() * element.GetRingDimension() * sizeof(uint64_t);
+        }
+
+        return bytes;
+    }
+
+    size_t MemoryFootprint::CiphertextBytes(const std::vector<BootstrapableCiphertext> &ciphertexts) {
+        size_t bytes = 0;
+        for (const auto &c: ciphertexts) {
+            bytes += c.GetSizeInBytes();
+        }
+        return bytes;
+    }
+
+    size_t MemoryFootprint::CiphertextBytes(const std::vector<std::vector<BootstrapableCiphertext> > &ciphertexts) {
+        size_t bytes = 0;
+        for (const auto &c: ciphertexts) {
+            bytes += CiphertextBytes(c);
+        }
+        return bytes;
+    }
+
+    std::vector<size_t> MemoryFootprint::CiphertextBytesByLevel(const HEContext &ctx) {
+        const auto cc = ctx.GetCc();
+        const auto packed = cc->MakeCKKSPackedPlaintext(std::vector(ctx.GetNumSlots(), 0.0));
+        auto ciphertext = cc->Encrypt(ctx.GetPublicKey(), packed);
+
+        // Measured rather than derived from the tower count, so metadata and serialization overhead are included
+        std::vector<size_t> bytesByLevel;
+        while (true) {
+            std::ostringstream out;
+            Serial::Serialize(ciphertext, out, SerType::BINARY);
+            bytesByLevel.push_back(out.str().size());
+
+            if (ciphertext->GetElements()[0].GetNumOfElements() <= 1) {
+                break;
+            }
+            cc->LevelReduceInPlace(ciphertext, nullptr, 1);
+        }
+
+        return bytesByLevel;
+    }
+
+    size_t MemoryFootprint::CurrentRss() {
+        std::ifstream statm("/proc/self/statm");
+        size_t totalPages = 0;
+        size_t residentPages = 0;
+
+        if (!(statm >> totalPages >> residentPages)) {
+            return 0;
+        }
+
+        return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    size_t MemoryFootprint::PeakRss() {
+        // VmHWM honours ResetPeakRss; ru_maxrss never goes down
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::stoull(line.substr(6)) * 1024;
+            }
+        }
+
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+
+        // ru_maxrss is reported in kilobytes on Linux
+        return static_cast<size_t>(usage.ru_maxrss) * 1024;
+    }
+
+    bool MemoryFootprint::ResetPeakRss() {
+        std::ofstream clearRefs("/proc/self/clear_refs");
+        clearRefs << "5";
+        clearRefs.flush();
+        return clearRefs.good();
+    }
+}
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "tracing.h"
+
+namespace hermesml {
+    namespace {
+        std::string Escape(const std::string &text) {
+            std::string escaped;
+            escaped.reserve(text.size());
+            for (const auto c: text) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                    escaped += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    // JSON strings may not hold control characters as they are
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+    }
+
+    Tracer::Tracer() : origin(std::chrono::steady_clock::now()) {
+    }
+
+    Tracer &Tracer::Get() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    Tracer::ThreadSpans &Tracer::GetThreadSpans() {
+        // Registered once per thread. On exit the thread hands its spans over and its buffer is freed, so short-lived
+        // workers do not pile up buffers over a long run
+        struct Registration {
+            ThreadSpans spans;
+            Tracer *tracer = nullptr;
+
+            ~Registration() {
+                if (this->tracer) {
+                    this->tracer->Retire(this->spans);
+                }
+            }
+        };
+        thread_local Registration registration;
+
+        if (!registration.tracer) {
+            std::lock_guard lock(this->mutex);
+            registration.spans.thread = this->nextThread++;
+            registration.tracer = this;
+            this->threads.push_back(&registration.spans);
+        }
+
+        return registration.spans;
+    }
+
+    void Tracer::Retire(ThreadSpans &spans) {
+        std::lock_guard lock(this->mutex);
+        this->threads.erase(std::find(this->threads.begin(), this->threads.end(), &spans));
+
+        if (!spans.spans.empty()) {
+            this->finished.push_back(std::move(spans));
+        }
+    }
+
+    int64_t Tracer::Now() const {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - this->origin).count();
+    }
+
+    void Tracer::Record(std::string name, const int64_t start, const int64_t end) {
+        this->GetThreadSpans().spans.push_back(Span{std::move(name), start, end - start});
+    }
+
+    void Tracer::Flush(const std::string &filePath) {
+        std::lock_guard lock(this->mutex);
+        std::ofstream out(filePath, std::ios::trunc);
+
+        if (!out) {
+            throw std::runtime_error("Could not open " + filePath + " for writing");
+        }
+
+        out << "{\"traceEvents\":[";
+
+        auto first = true;
+        const auto write = [&out, &first](const ThreadSpans &thread) {
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                    << thread.thread << ",\"args\":{\"name\":\"thread " << thread.thread << "\"}}";
+            first = false;
+
+            for (const auto &span: thread.spans) {
+                out << ",\n{\"name\":\"" << Escape(span.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                        << thread.thread << ",\"ts\":" << span.start << ",\"dur\":" << span.duration << "}";
+            }
+        };
+
+        for (const auto &thread: this->finished) {
+            write(thread);
+        }
+        this->finished.clear();
+
+        for (auto *thread: this->threads) {
+            write(*thread);
+            thread->spans.clear();
+        }
+
+        out << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+    }
+
+    TraceScope::TraceScope(std::string name) : name(std::move(name)), start(Tracer::Get().Now()) {
+    }
+
+    TraceScope::~TraceScope() {
+        auto &tracer = Tracer::Get();
+        tracer.Record(std::move(this->name), this->start, tracer.Now());
+    }
+}
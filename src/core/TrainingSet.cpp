@@ -0,0 +1,88 @@
+#include "core.h"
+
+namespace hermesml {
+    TrainingSet::TrainingSet(const HEContext &ctx, std::vector<BootstrapableCiphertext> features,
+                             std::vector<BootstrapableCiphertext> labels,
+                             const LabelEncoding encoding) : EncryptedObject(ctx), encoding(encoding),
+                                                             features(std::move(features)),
+                                                             labels(std::move(labels)) {
+        const auto slots = this->GetCtx().GetNumSlots();
+        const auto samples = this->features.size();
+
+        switch (this->encoding) {
+            case REPLICATED_LABELS:
+                if (this->labels.size() != samples) {
+                    throw std::invalid_argument("Expected " + std::to_string(samples) + " labels, got " +
+                                                std::to_string(this->labels.size()));
+                }
+                break;
+            case FEATURE_SLOT_LABELS:
+                if (this->GetCtx().GetNumFeatures() >= slots) {
+                    throw std::invalid_argument("No spare slot for the label: " +
+                                                std::to_string(this->GetCtx().GetNumFeatures()) +
+                                                " features fill all " + std::to_string(slots) + " slots");
+                }
+                break;
+            case PACKED_LABELS:
+                if (this->labels.size() != (samples + slots - 1) / slots) {
+                    throw std::invalid_argument("Expected " + std::to_string((samples + slots - 1) / slots) +
+                                                " packed label ciphertexts, got " +
+                                                std::to_string(this->labels.size()));
+                }
+                break;
+            default:
+                throw std::invalid_argument("Unknown label encoding " + std::to_string(this->encoding));
+        }
+    }
+
+    LabelEncoding TrainingSet::SupportedEncoding(const HEContext &ctx, const LabelEncoding encoding) {
+        if (encoding == FEATURE_SLOT_LABELS && ctx.GetNumFeatures() >= ctx.GetNumSlots()) {
+            return PACKED_LABELS;
+        }
+        return encoding;
+    }
+
+    LabelEncoding TrainingSet::GetEncoding() const {
+        return this->encoding;
+    }
+
+    size_t TrainingSet::GetSize() const {
+        return this->features.size();
+    }
+
+    BootstrapableCiphertext TrainingSet::GetFeatures(const size_t i) const {
+        if (this->encoding != FEATURE_SLOT_LABELS) {
+            return this->features.at(i);
+        }
+
+        // The label slot is cleared, or it would leak into every weight the features are multiplied into
+        return this->EvalMask(this->features.at(i), std::vector(this->GetCtx().GetNumFeatures(), 1.0));
+    }
+
+    BootstrapableCiphertext TrainingSet::GetLabel(const size_t i) const {
+        const auto slots = this->GetCtx().GetNumSlots();
+        const auto n_features = this->GetCtx().GetNumFeatures();
+
+        // The label is rotated to slot 0 and isolated there, then doubled into the n_features slots REPLICATED_LABELS
+        // fills. Only the mask spends a level; EvalFlatten would also merge numSlots rotated copies
+        const auto replicate = [this, n_features](const BootstrapableCiphertext &rotated) {
+            return this->EvalReplicate(this->EvalMask(rotated, {1.0}), n_features);
+        };
+
+        switch (this->encoding) {
+            case FEATURE_SLOT_LABELS:
+                return replicate(this->EvalRotate(this->features.at(i), static_cast<int32_t>(n_features)));
+            case PACKED_LABELS: {
+                const auto &packed = this->labels.at(i / slots);
+                const auto slot = static_cast<int32_t>(i % slots);
+                return replicate(slot > 0 ? this->EvalRotate(packed, slot) : packed);
+            }
+            default:
+                return this->labels.at(i);
+        }
+    }
+
+    size_t TrainingSet::GetCiphertextBytes() const {
+        return MemoryFootprint::CiphertextBytes(this->features) + MemoryFootprint::CiphertextBytes(this->labels);
+    }
+}
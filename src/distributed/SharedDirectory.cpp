@@ -0,0 +1,53 @@
+#include <filesystem>
+#include <thread>
+
+#include "distributed.h"
+
+namespace hermesml {
+    SharedDirectory::SharedDirectory(std::string directory) : directory(std::move(directory)) {
+        std::filesystem::create_directories(this->directory);
+    }
+
+    const std::string &SharedDirectory::GetDirectory() const {
+        return this->directory;
+    }
+
+    std::string SharedDirectory::Path(const std::string &name) const {
+        return this->directory + "/" + name;
+    }
+
+    std::string SharedDirectory::ShardPath(const uint32_t worker, const std::string &kind) const {
+        return this->Path("shard_" + std::to_string(worker) + "_" + kind + ".bin");
+    }
+
+    std::string SharedDirectory::ModelPath(const uint64_t round) const {
+        return this->Path("model_" + std::to_string(round) + ".bin");
+    }
+
+    std::string SharedDirectory::GradientsPath(const uint64_t round, const uint32_t worker) const {
+        return this->Path("gradients_" + std::to_string(round) + "_" + std::to_string(worker) + ".bin");
+    }
+
+    std::string SharedDirectory::FailurePath(const uint32_t worker) const {
+        return this->Path("failed_" + std::to_string(worker) + ".txt");
+    }
+
+    void SharedDirectory::Publish(const std::string &path,
+                                  const std::function<void(const std::string &)> &write) const {
+        const auto temporaryPath = path + ".tmp";
+        write(temporaryPath);
+        std::filesystem::rename(temporaryPath, path);
+    }
+
+    size_t SharedDirectory::WaitForAny(const std::vector<std::string> &paths, const uint32_t pollIntervalMs) const {
+        while (true) {
+            for (size_t i = 0; i < paths.size(); i++) {
+                if (std::filesystem::exists(paths[i])) {
+                    return i;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(pollIntervalMs));
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include <filesystem>
+
+#include "ciphertext-ser.h"
+#include "context.h"
+#include "distributed.h"
+
+namespace hermesml {
+    TrainingCoordinator::TrainingCoordinator(const HEContext &ctx, ShardedTrainingOptions options) : EncryptedObject(ctx),
+        options(std::move(options)), shared(SharedDirectory(this->options.directory)) {
+        if (this->options.workers == 0 || this->options.localBatchSize == 0) {
+            throw std::invalid_argument("Data-parallel training needs at least one worker and one sample per batch");
+        }
+    }
+
+    void TrainingCoordinator::Prepare(const std::vector<BootstrapableCiphertext> &x,
+                                      const std::vector<BootstrapableCiphertext> &y) const {
+        if (x.size() != y.size()) {
+            throw std::runtime_error(
+                "The size of x must be equal to the size of y. (" + std::to_string(x.size()) + " vs " +
+                std::to_string(y.size()) + ")");
+        }
+
+        // Leftovers of an interrupted run would be taken for this run's messages
+        for (const auto &entry: std::filesystem::directory_iterator(this->shared.GetDirectory())) {
+            const auto name = entry.path().filename().string();
+            if (name.rfind("model_", 0) == 0 || name.rfind("gradients_", 0) == 0 || name.rfind("failed_", 0) == 0 ||
+                name == "done") {
+                std::filesystem::remove(entry.path());
+            }
+        }
+
+        // A simulation has no keys to share; its workers run in this process, on the same context
+        if (!this->GetCtx().IsSimulated()) {
+            HEContextFactory::Save(this->GetCtx(), this->shared.GetDirectory());
+        }
+
+        const auto client = Client(this->GetCtx());
+        size_t largestShard = 0;
+
+        for (uint32_t w = 0; w < this->options.workers; w++) {
+            std::vector<BootstrapableCiphertext> xShard, yShard;
+            for (size_t i = w; i < x.size(); i += this->options.workers) {
+                xShard.push_back(x[i]);
+                yShard.push_back(y[i]);
+            }
+            largestShard = std::max(largestShard, xShard.size());
+
+            this->shared.Publish(this->shared.ShardPath(w, "x"), [&](const std::string &path) {
+                client.SerializeToFile(path, xShard);
+            });
+            this->shared.Publish(this->shared.ShardPath(w, "y"), [&](const std::string &path) {
+                client.SerializeToFile(path, yShard);
+            });
+        }
+
+        // An epoch lasts until the largest shard is consumed; smaller shards contribute zero gradients meanwhile
+        const auto roundsPerEpoch = (largestShard + this->options.localBatchSize - 1) / this->options.localBatchSize;
+
+        this->shared.Publish(this->shared.Path("training.txt"), [&](const std::string &path) {
+            std::ofstream out(path, std::ios::trunc);
+            out << this->options.workers << " " << this->options.localBatchSize << " " << roundsPerEpoch << "\n";
+        });
+    }
+
+    Gradients TrainingCoordinator::CollectGradients(const uint64_t round) const {
+        Gradients total;
+
+        for (uint32_t w = 0; w < this->options.workers; w++) {
+            const auto gradientsPath = this->shared.GradientsPath(round, w);
+
+            if (this->shared.WaitForAny({gradientsPath, this->shared.FailurePath(w)}, this->options.pollIntervalMs)
+                == 1) {
+                std::ifstream failure(this->shared.FailurePath(w));
+                std::string reason;
+                std::getline(failure, reason);
+                throw std::runtime_error("Training worker " + std::to_string(w) + " failed: " + reason);
+            }
+
+            std::ifstream in(gradientsPath, std::ios::binary);
+            auto eWeights = this->ReadCiphertext(in);
+            auto eBias = this->ReadCiphertext(in);
+
+            if (w == 0) {
+                total.eWeights = std::move(eWeights);
+                total.eBias = std::move(eBias);
+            } else {
+                this->EvalAddInPlace(total.eWeights, eWeights);
+                this->EvalAddInPlace(total.eBias, eBias);
+            }
+        }
+
+        return total;
+    }
+
+    void TrainingCoordinator::Train(CkksLogisticRegression &model, const uint16_t epochs) const {
+        std::ifstream manifest(this->shared.Path("training.txt"));
+        uint32_t workers, localBatchSize;
+        uint64_t roundsPerEpoch;
+
+        if (!(manifest >> workers >> localBatchSize >> roundsPerEpoch) || workers != this->options.workers) {
+            throw std::runtime_error("Training shards are missing or stale; call Prepare first");
+        }
+
+        model.Initialize();
+
+        const auto finish = [this] {
+            this->shared.Publish(this->shared.Path("done"), [](const std::string &path) {
+                std::ofstream out(path);
+            });
+        };
+
+        try {
+            const auto rounds = epochs * roundsPerEpoch;
+            for (uint64_t round = 0; round < rounds; round++) {
+                this->shared.Publish(this->shared.ModelPath(round), [&](const std::string &path) {
+                    model.Save(path);
+                });
+
+                // Workers send unscaled sums, so the schedule is applied here, at the round's point of the epoch
+                const auto epoch = static_cast<double>(round) / static_cast<double>(roundsPerEpoch);
+                model.ApplyGradients(this->CollectGradients(round), epoch);
+
+                // Every worker has answered, so nobody reads this round's files anymore
+                std::filesystem::remove(this->shared.ModelPath(round));
+                for (uint32_t w = 0; w < this->options.workers; w++) {
+                    std::filesystem::remove(this->shared.GradientsPath(round, w));
+                }
+            }
+        } catch (...) {
+            // Release the surviving workers before giving up
+            finish();
+            throw;
+        }
+
+        finish();
+    }
+}
@@ -0,0 +1,52 @@
+#include "ciphertext-ser.h"
+#include "distributed.h"
+
+namespace hermesml {
+    TrainingWorker::TrainingWorker(const HEContext &ctx, const std::string &directory, const uint32_t rank,
+                                   const uint32_t pollIntervalMs) : EncryptedObject(ctx),
+                                                                    shared(SharedDirectory(directory)), rank(rank),
+                                                                    pollIntervalMs(pollIntervalMs) {
+    }
+
+    void TrainingWorker::Run() const {
+        try {
+            std::ifstream manifest(this->shared.Path("training.txt"));
+            uint32_t workers, localBatchSize;
+            uint64_t roundsPerEpoch;
+
+            if (!(manifest >> workers >> localBatchSize >> roundsPerEpoch) || this->rank >= workers) {
+                throw std::runtime_error("No shard for worker " + std::to_string(this->rank));
+            }
+
+            const auto client = Client(this->GetCtx());
+            const auto x = client.DeserializeFromFile(this->shared.ShardPath(this->rank, "x"));
+            const auto y = client.DeserializeFromFile(this->shared.ShardPath(this->rank, "y"));
+
+            for (uint64_t round = 0;; round++) {
+                if (this->shared.WaitForAny({this->shared.ModelPath(round), this->shared.Path("done")},
+                                            this->pollIntervalMs) == 1) {
+                    return;
+                }
+
+                auto model = CkksLogisticRegression::Load(this->GetCtx(), this->shared.ModelPath(round));
+
+                const auto begin = std::min<size_t>(x.size(), (round % roundsPerEpoch) * localBatchSize);
+                const auto end = std::min<size_t>(x.size(), begin + localBatchSize);
+                const auto gradients = model.ComputeGradients(x, y, begin, end);
+
+                this->shared.Publish(this->shared.GradientsPath(round, this->rank), [&](const std::string &path) {
+                    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                    this->WriteCiphertext(out, gradients.eWeights);
+                    this->WriteCiphertext(out, gradients.eBias);
+                });
+            }
+        } catch (const std::exception &e) {
+            // Unblocks the coordinator, which would otherwise wait for this worker's gradients forever
+            this->shared.Publish(this->shared.FailurePath(this->rank), [&](const std::string &path) {
+                std::ofstream out(path, std::ios::trunc);
+                out << e.what() << std::endl;
+            });
+            throw;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "client.h"
+#include "datasets.h"
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    double Accuracy(const std::vector<double> &scores, const double threshold, const std::vector<double> &labels) {
+        size_t correct = 0;
+        for (size_t i = 0; i < scores.size(); i++) {
+            correct += (scores[i] > threshold ? 1.0 : 0.0) == labels[i];
+        }
+        return static_cast<double>(correct) / static_cast<double>(scores.size());
+    }
+
+    // Trains once under CKKS, then serves the same weights through both schemes
+    void Compare(Dataset &dataset, const uint16_t epochs) {
+        const auto trainingFeatures = dataset.GetTrainingFeatures();
+        const auto trainingLabels = dataset.GetTrainingLabels();
+        const auto testingFeatures = dataset.GetTestingFeatures();
+        const auto testingLabels = dataset.GetTestingLabels();
+        const auto n_features = trainingFeatures[0].size();
+
+        // C K K S ----------------------------------------------------------------------------------------------------
+        const auto ckksCtx = HEContextFactory::ckksHeContext(n_features);
+        const auto ckksClient = Client(ckksCtx);
+
+        auto ckksModel = CkksLogisticRegression(ckksCtx, n_features, epochs);
+        ckksModel.Fit(ckksClient.EncryptCKKS(trainingFeatures), ckksClient.EncryptCKKS(trainingLabels, n_features));
+
+        const auto eCkksTesting = ckksClient.EncryptCKKS(testingFeatures);
+        auto start = std::chrono::steady_clock::now();
+        const auto ckksPredictions = ckksModel.PredictAll(eCkksTesting);
+        const std::chrono::duration<double> ckksTime = std::chrono::steady_clock::now() - start;
+        const auto ckksScores = ckksClient.DecryptCKKS(ckksPredictions);
+
+        Plaintext plaintext;
+        ckksCtx.GetCc()->Decrypt(ckksCtx.GetPrivateKey(), ckksModel.GetWeights().GetCiphertext(), &plaintext);
+        plaintext->SetLength(n_features);
+        const auto weights = plaintext->GetRealPackedValue();
+        const auto bias = ckksClient.DecryptCKKS({ckksModel.GetBias()})[0];
+
+        // B F V ------------------------------------------------------------------------------------------------------
+        const auto bfvCtx = HEContextFactory::bfvHeContext(n_features);
+        const auto bfvClient = Client(bfvCtx);
+        const auto bfvModel = QuantizedLogisticRegression(bfvCtx, weights, bias);
+
+        const auto eBfvTesting = bfvClient.Encrypt(Quantizer::Quantize(testingFeatures));
+        start = std::chrono::steady_clock::now();
+        const auto bfvPredictions = bfvModel.PredictAll(eBfvTesting);
+        const std::chrono::duration<double> bfvTime = std::chrono::steady_clock::now() - start;
+
+        std::vector<double> bfvLogits;
+        for (const auto logit: bfvClient.Decrypt(bfvPredictions)) {
+            bfvLogits.push_back(QuantizedLogisticRegression::Dequantize(logit));
+        }
+
+        // Both models share the weights, so their decisions should agree up to CKKS noise near the boundary
+        const auto threshold = Calculus::DecisionThreshold(TANH);
+        size_t agreements = 0;
+        for (size_t i = 0; i < bfvLogits.size(); i++) {
+            agreements += (ckksScores[i] > threshold) == (bfvLogits[i] > 0.0);
+        }
+
+        // The integer kernel is exact, so only quantization separates it from the plaintext distance
+        const CalculusQuant calculus(bfvCtx);
+        const auto eDistance = calculus.Euclidean(eBfvTesting[0], eBfvTesting[1]);
+        const auto distance = static_cast<double>(bfvClient.Decrypt({eDistance})[0]) /
+                              (QUANTIZE_SCALE_FACTOR * QUANTIZE_SCALE_FACTOR);
+        double expectedDistance = 0.0;
+        for (size_t j = 0; j < n_features; j++) {
+            const auto difference = testingFeatures[0][j] - testingFeatures[1][j];
+            expectedDistance += difference * difference;
+        }
+
+        const auto samples = static_cast<double>(testingFeatures.size());
+        std::cout << dataset.GetName() << ",ckks," << ckksTime.count() << "," << samples / ckksTime.count() << ","
+                << Accuracy(ckksScores, threshold, testingLabels) << ",," << std::endl;
+        std::cout << dataset.GetName() << ",bfv," << bfvTime.count() << "," << samples / bfvTime.count() << ","
+                << Accuracy(bfvLogits, 0.0, testingLabels) << ","
+                << static_cast<double>(agreements) / samples << ","
+                << std::abs(distance - expectedDistance) << std::endl;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    const auto epochs = argc > 1 ? std::stoi(argv[1]) : 1;
+
+    std::vector<std::unique_ptr<Dataset> > datasets;
+    datasets.emplace_back(std::make_unique<BreastCancerDataset>(FM11));
+    datasets.emplace_back(std::make_unique<DiabetesDataset>(FM11));
+    datasets.emplace_back(std::make_unique<GliomaGradingDataset>(FM11));
+    datasets.emplace_back(std::make_unique<DifferentiatedThyroidDataset>(FM11));
+    datasets.emplace_back(std::make_unique<CirrhosisPatientDataset>(FM11));
+
+    std::cout << "dataset,scheme,inference_s,samples_per_s,accuracy,decision_agreement,squared_distance_error"
+            << std::endl;
+
+    for (const auto &dataset: datasets) {
+        Compare(*dataset, epochs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "datasets.h"
+#include "distributed.h"
+
+using namespace hermesml;
+
+namespace {
+    void Usage() {
+        std::cerr << "Usage:" << std::endl;
+        std::cerr << "  CkksDistributedTraining <sharedDir> [workers] [epochs] [localBatchSize] [breast|credit]"
+                << std::endl;
+        std::cerr << "  CkksDistributedTraining worker <sharedDir> <rank>" << std::endl;
+    }
+
+    std::unique_ptr<Dataset> MakeDataset(const std::string &name) {
+        if (name == "credit") {
+            return std::make_unique<CreditCardFraudDataset>(FM11);
+        }
+        return std::make_unique<BreastCancerDataset>(FM11);
+    }
+
+    int Worker(const std::string &sharedDir, const uint32_t rank) {
+        const auto ctx = HEContextFactory::Load(sharedDir);
+        TrainingWorker(ctx, sharedDir, rank).Run();
+        return 0;
+    }
+
+    int Coordinator(char *self, const std::string &sharedDir, const ShardedTrainingOptions &options,
+                    const uint16_t epochs, const std::string &datasetName) {
+        const auto dataset = MakeDataset(datasetName);
+
+        const auto trainingFeatures = dataset->GetTrainingFeatures();
+        const auto trainingLabels = dataset->GetTrainingLabels();
+        const auto testingFeatures = dataset->GetTestingFeatures();
+        const auto testingLabels = dataset->GetTestingLabels();
+        const auto n_features = trainingFeatures[0].size();
+
+        const auto ctx = HEContextFactory::ckksHeContext(n_features);
+        const auto client = Client(ctx);
+        const TrainingCoordinator coordinator(ctx, options);
+
+        coordinator.Prepare(client.EncryptCKKS(trainingFeatures), client.EncryptCKKS(trainingLabels, n_features));
+
+        // Workers are fresh processes of this same binary; they only see the public material in the shared directory
+        std::vector<pid_t> workers;
+        for (uint32_t w = 0; w < options.workers; w++) {
+            const auto rank = std::to_string(w);
+            const auto pid = fork();
+
+            if (pid == 0) {
+                execl("/proc/self/exe", self, "worker", sharedDir.c_str(), rank.c_str(), nullptr);
+                _exit(127);
+            }
+            if (pid < 0) {
+                throw std::runtime_error("Could not start training worker " + rank);
+            }
+            workers.push_back(pid);
+        }
+
+        auto model = CkksLogisticRegression(ctx, n_features, epochs);
+
+        const auto start = std::chrono::steady_clock::now();
+        coordinator.Train(model, epochs);
+        const std::chrono::duration<double> trainingTime = std::chrono::steady_clock::now() - start;
+
+        for (const auto pid: workers) {
+            waitpid(pid, nullptr, 0);
+        }
+
+        const auto predictions = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(testingFeatures)));
+        const auto threshold = Calculus::DecisionThreshold(TANH);
+
+        size_t correct = 0;
+        for (size_t i = 0; i < predictions.size(); i++) {
+            correct += (predictions[i] > threshold ? 1.0 : 0.0) == testingLabels[i];
+        }
+
+        std::cout << "dataset = " << dataset->GetName() << std::endl;
+        std::cout << "workers = " << options.workers << std::endl;
+        std::cout << "localBatchSize = " << options.localBatchSize << std::endl;
+        std::cout << "epochs = " << epochs << std::endl;
+        std::cout << "trainingTime = " << trainingTime.count() << " s" << std::endl;
+        std::cout << "accuracy = " << static_cast<double>(correct) / static_cast<double>(predictions.size())
+                << std::endl;
+
+        return 0;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    if (argc < 2) {
+        Usage();
+        return 1;
+    }
+
+    try {
+        if (std::string(argv[1]) == "worker") {
+            if (argc < 4) {
+                Usage();
+                return 1;
+            }
+            return Worker(argv[2], std::stoul(argv[3]));
+        }
+
+        ShardedTrainingOptions options;
+        options.directory = argv[1];
+        options.workers = argc > 2 ? std::stoul(argv[2]) : 2;
+        options.localBatchSize = argc > 4 ? std::stoul(argv[4]) : 1;
+
+        const auto epochs = argc > 3 ? std::stoi(argv[3]) : 1;
+        const auto datasetName = argc > 5 ? std::string(argv[5]) : "breast";
+
+        return Coordinator(argv[0], options.directory, options, epochs, datasetName);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,147 @@
+#include "client.h"
+#include "datasets.h"
+#include "serving.h"
+
+using namespace hermesml;
+
+namespace {
+    void Usage() {
+        std::cerr << "Usage:" << std::endl;
+        std::cerr << "  CkksInferenceService prepare <modelDir> [epochs]" << std::endl;
+        std::cerr << "  CkksInferenceService serve <modelDir> <socket> [maxBatchWaitMs]" << std::endl;
+        std::cerr << "  CkksInferenceService bench <modelDir> <socket> [clients] [--shutdown]" << std::endl;
+    }
+
+    // Generates keys, trains a logistic regression on the breast cancer dataset and stores everything the server
+    // and the harness need. The secret key is written too, as the harness plays the data owner
+    int Prepare(const std::string &modelDir, const uint16_t epochs) {
+        BreastCancerDataset dataset(FM11);
+
+        const auto trainingFeatures = dataset.GetTrainingFeatures();
+        const auto trainingLabels = dataset.GetTrainingLabels();
+        const auto n_features = trainingFeatures[0].size();
+
+        const auto ctx = HEContextFactory::ckksHeContext(n_features, true);
+        const auto client = Client(ctx);
+
+        auto model = CkksLogisticRegression(ctx, n_features, epochs);
+        model.Fit(client.EncryptCKKS(trainingFeatures), client.EncryptCKKS(trainingLabels, n_features));
+
+        HEContextFactory::Save(ctx, modelDir, true);
+        model.Save(modelDir + "/model.bin");
+
+        std::cout << "Model stored in " << modelDir << std::endl;
+        return 0;
+    }
+
+    int Serve(const std::string &modelDir, const std::string &socketPath, const uint32_t maxBatchWaitMs) {
+        const auto ctx = HEContextFactory::Load(modelDir);
+        const auto model = CkksLogisticRegression::Load(ctx, modelDir + "/model.bin");
+
+        InferenceServerOptions options;
+        options.socketPath = socketPath;
+        options.maxBatchWaitMs = maxBatchWaitMs;
+
+        InferenceServer server(ctx, model, options);
+
+        std::cout << "Serving on " << socketPath << " (" << ctx.GetSamplesPerCiphertext() << " queries per batch)"
+                << std::endl;
+        server.Serve();
+
+        std::cout << server.GetStats();
+        return 0;
+    }
+
+    // Replays the testing split through concurrent connections and reports end-to-end latency
+    int Bench(const std::string &modelDir, const std::string &socketPath, const uint32_t nClients,
+              const bool shutdown) {
+        const auto ctx = HEContextFactory::Load(modelDir, true);
+
+        BreastCancerDataset dataset(FM11);
+        const auto testingFeatures = dataset.GetTestingFeatures();
+        const auto testingLabels = dataset.GetTestingLabels();
+
+        std::vector<double> predictions(testingFeatures.size());
+        LatencyRecorder latency;
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> clients;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t c = 0; c < nClients; c++) {
+            clients.emplace_back([&] {
+                const InferenceClient client(ctx, socketPath);
+                for (auto i = next.fetch_add(1); i < testingFeatures.size(); i = next.fetch_add(1)) {
+                    const auto requestStart = std::chrono::steady_clock::now();
+                    predictions[i] = client.Predict(testingFeatures[i]);
+                    const std::chrono::duration<double, std::milli> elapsed =
+                            std::chrono::steady_clock::now() - requestStart;
+                    latency.Record(elapsed.count());
+                }
+            });
+        }
+
+        for (auto &client: clients) {
+            client.join();
+        }
+
+        const std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+
+        const auto threshold = Calculus::DecisionThreshold(TANH);
+        size_t correct = 0;
+        for (size_t i = 0; i < predictions.size(); i++) {
+            correct += (predictions[i] > threshold ? 1.0 : 0.0) == testingLabels[i];
+        }
+
+        const auto summary = latency.Summarize();
+        std::cout << "clients = " << nClients << std::endl;
+        std::cout << "requests = " << summary.count << std::endl;
+        std::cout << "throughput = " << static_cast<double>(summary.count) / total.count() << " req/s" << std::endl;
+        std::cout << "meanLatencyMs = " << summary.mean << std::endl;
+        std::cout << "p50LatencyMs = " << summary.p50 << std::endl;
+        std::cout << "p99LatencyMs = " << summary.p99 << std::endl;
+        std::cout << "accuracy = " << static_cast<double>(correct) / static_cast<double>(predictions.size())
+                << std::endl;
+
+        const InferenceClient control(ctx, socketPath);
+        std::cout << "Server side:" << std::endl << control.Stats();
+
+        if (shutdown) {
+            control.Shutdown();
+        }
+
+        return 0;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    if (argc < 3) {
+        Usage();
+        return 1;
+    }
+
+    const std::string mode = argv[1];
+    const std::string modelDir = argv[2];
+
+    try {
+        if (mode == "prepare") {
+            return Prepare(modelDir, argc > 3 ? std::stoi(argv[3]) : 1);
+        }
+
+        if (mode == "serve" && argc > 3) {
+            return Serve(modelDir, argv[3], argc > 4 ? std::stoul(argv[4]) : 5);
+        }
+
+        if (mode == "bench" && argc > 3) {
+            const auto nClients = argc > 4 && std::string(argv[4]) != "--shutdown" ? std::stoul(argv[4]) : 32;
+            const auto shutdown = std::string(argv[argc - 1]) == "--shutdown";
+            return Bench(modelDir, argv[3], nClients, shutdown);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    Usage();
+    return 1;
+}
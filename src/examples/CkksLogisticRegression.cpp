@@ -14,6 +14,7 @@ int main() {
     datasets11.emplace_back(std::make_unique<CirrhosisPatientDataset>(FM11));
 
     CkksExperimentParams params{};
+    ExperimentSweep sweep;
 
     for (auto i = 1; i <= epochs; i++) {
         for (auto j = 0; j < datasets11.size(); j++) {
@@ -21,44 +22,69 @@ int main() {
             params.approximation = CHEBYSHEV;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_tanh_chebyshev_" + std::to_string(params.epochs), *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_tanh_chebyshev_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = TANH;
             params.approximation = TAYLOR;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_tanh_taylor_" + std::to_string(params.epochs), *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_tanh_taylor_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = TANH;
             params.approximation = LEAST_SQUARES;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_tanh_least_squares_" + std::to_string(params.epochs), *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_tanh_least_squares_" + std::to_string(params.epochs), *datasets11[j], params));
+
+            params.activation = TANH;
+            params.approximation = MINIMAX;
+            params.epochs = i;
+            params.earlyBootstrapping = 0;
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_tanh_minimax_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = CHEBYSHEV;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_sigmoid_chebyshev_" + std::to_string(params.epochs), *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_sigmoid_chebyshev_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = TAYLOR;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_sigmoid_taylor_" + std::to_string(params.epochs), *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_sigmoid_taylor_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = LEAST_SQUARES;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksLogisticRegressionExperiment("ckks_sigmoid_least_squares_" + std::to_string(params.epochs),
-                                             *datasets11[j],
-                                             params).Run();
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_sigmoid_least_squares_" + std::to_string(params.epochs), *datasets11[j], params));
+
+            params.activation = SIGMOID;
+            params.approximation = MINIMAX;
+            params.epochs = i;
+            params.earlyBootstrapping = 0;
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_sigmoid_minimax_" + std::to_string(params.epochs), *datasets11[j], params));
+
+            // Nesterov momentum under a decaying rate, against the plain SGD runs above
+            params.activation = TANH;
+            params.approximation = CHEBYSHEV;
+            params.epochs = i;
+            params.earlyBootstrapping = 0;
+            params.optimizer = {NESTEROV, 0.005, 0.9, INVERSE_TIME_DECAY, 0.5, 1.0};
+            sweep.Add(std::make_unique<CkksLogisticRegressionExperiment>(
+                "ckks_tanh_chebyshev_nesterov_" + std::to_string(params.epochs), *datasets11[j], params));
+            params.optimizer = {};
         }
     }
+
+    sweep.Run();
 }
@@ -26,6 +26,7 @@ int main(int argc, char *argv[]) {
     }
 
     CkksExperimentParams params{};
+    ExperimentSweep sweep;
 
     for (auto i = 1; i <= epochs; i++) {
         for (auto j = 0; j < datasets11.size(); j++) {
@@ -33,44 +34,59 @@ int main(int argc, char *argv[]) {
             params.approximation = CHEBYSHEV;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_tanh_chebyshev_" + std::to_string(params.epochs), *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_tanh_chebyshev_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = TANH;
             params.approximation = TAYLOR;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_tanh_taylor_" + std::to_string(params.epochs), *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_tanh_taylor_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = TANH;
             params.approximation = LEAST_SQUARES;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_tanh_least_squares_" + std::to_string(params.epochs), *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_tanh_least_squares_" + std::to_string(params.epochs), *datasets11[j], params));
+
+            params.activation = TANH;
+            params.approximation = MINIMAX;
+            params.epochs = i;
+            params.earlyBootstrapping = 0;
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_tanh_minimax_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = CHEBYSHEV;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_sigmoid_chebyshev_" + std::to_string(params.epochs), *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_sigmoid_chebyshev_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = TAYLOR;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_sigmoid_taylor_" + std::to_string(params.epochs), *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_sigmoid_taylor_" + std::to_string(params.epochs), *datasets11[j], params));
 
             params.activation = SIGMOID;
             params.approximation = LEAST_SQUARES;
             params.epochs = i;
             params.earlyBootstrapping = 0;
-            CkksNeuralNetworkExperiment("nn_ckks_sigmoid_least_squares_" + std::to_string(params.epochs),
-                                        *datasets11[j],
-                                        params).Run();
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_sigmoid_least_squares_" + std::to_string(params.epochs), *datasets11[j], params));
+
+            params.activation = SIGMOID;
+            params.approximation = MINIMAX;
+            params.epochs = i;
+            params.earlyBootstrapping = 0;
+            sweep.Add(std::make_unique<CkksNeuralNetworkExperiment>(
+                "nn_ckks_sigmoid_minimax_" + std::to_string(params.epochs), *datasets11[j], params));
         }
     }
+
+    sweep.Run();
 }
@@ -0,0 +1,171 @@
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <filesystem>
+
+#include "client.h"
+#include "datasets.h"
+#include "serving.h"
+
+using namespace hermesml;
+
+namespace {
+    void Usage() {
+        std::cerr << "Usage:" << std::endl;
+        std::cerr << "  CkksRefreshBenchmark [workDir] [iterations] [--fit]" << std::endl;
+        std::cerr << "  CkksRefreshBenchmark keyholder <workDir> <socket>" << std::endl;
+    }
+
+    struct RefreshSummary {
+        double meanMs = 0.0;
+        double maxError = 0.0;
+    };
+
+    RefreshSummary MeasureRefresh(const HEContext &ctx, const RefreshStrategy &strategy,
+                                  const Ciphertext<DCRTPoly> &ciphertext, const std::vector<double> &expected,
+                                  const uint32_t iterations) {
+        const auto &cc = ctx.GetCc();
+        RefreshSummary summary;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            const auto refreshed = strategy.Refresh(cc, ciphertext);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            summary.meanMs += elapsed.count() / iterations;
+
+            Plaintext plaintext;
+            cc->Decrypt(ctx.GetPrivateKey(), refreshed, &plaintext);
+            plaintext->SetLength(expected.size());
+
+            const auto values = plaintext->GetRealPackedValue();
+            for (size_t j = 0; j < expected.size(); j++) {
+                summary.maxError = std::max(summary.maxError, std::abs(values[j] - expected[j]));
+            }
+        }
+
+        return summary;
+    }
+
+    // One epoch of logistic regression, so the refresh cost shows up in an actual training loop
+    std::pair<double, double> MeasureFit(const HEContext &ctx, Dataset &dataset) {
+        const auto client = Client(ctx);
+        const auto trainingFeatures = dataset.GetTrainingFeatures();
+        const auto testingFeatures = dataset.GetTestingFeatures();
+        const auto testingLabels = dataset.GetTestingLabels();
+        const auto n_features = trainingFeatures[0].size();
+
+        const auto eTrainingFeatures = client.EncryptCKKS(trainingFeatures);
+        const auto eTrainingLabels = client.EncryptCKKS(dataset.GetTrainingLabels(), n_features);
+
+        auto model = CkksLogisticRegression(ctx, n_features, 1);
+
+        const auto start = std::chrono::steady_clock::now();
+        model.Fit(eTrainingFeatures, eTrainingLabels);
+        const std::chrono::duration<double> trainingTime = std::chrono::steady_clock::now() - start;
+
+        const auto predictions = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(testingFeatures)));
+        const auto threshold = Calculus::DecisionThreshold(TANH);
+
+        size_t correct = 0;
+        for (size_t i = 0; i < predictions.size(); i++) {
+            correct += (predictions[i] > threshold ? 1.0 : 0.0) == testingLabels[i];
+        }
+
+        return {trainingTime.count(), static_cast<double>(correct) / static_cast<double>(predictions.size())};
+    }
+
+    int Benchmark(char *self, const std::string &workDir, const uint32_t iterations, const bool fit) {
+        BreastCancerDataset dataset(FM11);
+        const auto sample = dataset.GetTrainingFeatures()[0];
+        const auto n_features = sample.size();
+
+        const auto ctx = HEContextFactory::ckksHeContext(n_features);
+        HEContextFactory::Save(ctx, workDir, true);
+
+        // The key holder is a separate process that only shares the saved context with this one
+        const auto socketPath = workDir + "/refresh.sock";
+        std::filesystem::remove(socketPath);
+
+        const auto keyHolder = fork();
+        if (keyHolder == 0) {
+            execl("/proc/self/exe", self, "keyholder", workDir.c_str(), socketPath.c_str(), nullptr);
+            _exit(127);
+        }
+        if (keyHolder < 0) {
+            throw std::runtime_error("Could not start the key holder");
+        }
+
+        while (!std::filesystem::exists(socketPath)) {
+            if (waitpid(keyHolder, nullptr, WNOHANG) == keyHolder) {
+                throw std::runtime_error("The key holder exited before listening");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        const auto clientAided = std::make_shared<ClientAidedRefresh>(socketPath);
+        const BootstrapRefresh bootstrap;
+
+        // Spend a few levels first, as the training loop does before it asks for a refresh
+        constexpr auto squarings = 3;
+        const auto &cc = ctx.GetCc();
+        auto ciphertext = cc->Encrypt(ctx.GetPublicKey(), cc->MakeCKKSPackedPlaintext(sample));
+        auto expected = sample;
+        for (auto k = 0; k < squarings; k++) {
+            ciphertext = cc->EvalMult(ciphertext, ciphertext);
+            for (auto &v: expected) {
+                v *= v;
+            }
+        }
+
+        const auto bootstrapSummary = MeasureRefresh(ctx, bootstrap, ciphertext, expected, iterations);
+        const auto clientAidedSummary = MeasureRefresh(ctx, *clientAided, ciphertext, expected, iterations);
+
+        std::cout << "strategy,mean_ms,max_error" << std::endl;
+        std::cout << "bootstrap," << bootstrapSummary.meanMs << "," << bootstrapSummary.maxError << std::endl;
+        std::cout << "client_aided," << clientAidedSummary.meanMs << "," << clientAidedSummary.maxError << std::endl;
+        std::cout << "speedup = " << bootstrapSummary.meanMs / clientAidedSummary.meanMs << "x" << std::endl;
+
+        if (fit) {
+            auto aidedCtx = ctx;
+            aidedCtx.SetRefreshStrategy(clientAided);
+
+            const auto [bootstrapTime, bootstrapAccuracy] = MeasureFit(ctx, dataset);
+            const auto before = clientAided->GetRefreshes();
+            const auto [aidedTime, aidedAccuracy] = MeasureFit(aidedCtx, dataset);
+
+            std::cout << "strategy,training_s,accuracy" << std::endl;
+            std::cout << "bootstrap," << bootstrapTime << "," << bootstrapAccuracy << std::endl;
+            std::cout << "client_aided," << aidedTime << "," << aidedAccuracy << std::endl;
+            std::cout << "round trips = " << clientAided->GetRefreshes() - before << std::endl;
+        }
+
+        clientAided->Shutdown();
+        waitpid(keyHolder, nullptr, 0);
+
+        return 0;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    try {
+        if (argc > 1 && std::string(argv[1]) == "keyholder") {
+            if (argc < 4) {
+                Usage();
+                return 1;
+            }
+
+            const auto ctx = HEContextFactory::Load(argv[2], true);
+            RefreshService(ctx, argv[3]).Serve();
+            return 0;
+        }
+
+        const auto workDir = argc > 1 ? std::string(argv[1]) : std::string("refresh_benchmark");
+        const auto iterations = argc > 2 ? std::stoul(argv[2]) : 20;
+        const auto fit = std::string(argv[argc - 1]) == "--fit";
+
+        return Benchmark(argv[0], workDir, iterations, fit);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,153 @@
+#include <filesystem>
+
+#include "client.h"
+#include "datasets.h"
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    void Usage() {
+        std::cerr << "Usage:" << std::endl;
+        std::cerr << "  CkksSimulation calibrate [costsFile] [repetitions]" << std::endl;
+        std::cerr << "  CkksSimulation [costsFile] [epochs]" << std::endl;
+    }
+
+    std::string ActivationName(const ActivationFn activation) {
+        switch (activation) {
+            case TANH: return "tanh";
+            case SIGMOID: return "sigmoid";
+            case SQUARE: return "square";
+            case SCALED_SQUARE: return "scaled_square";
+            default: return "odd_poly";
+        }
+    }
+
+    std::string ApproximationName(const ApproximationFn approximation) {
+        switch (approximation) {
+            case CHEBYSHEV: return "chebyshev";
+            case TAYLOR: return "taylor";
+            case LEAST_SQUARES: return "least_squares";
+            default: return "minimax";
+        }
+    }
+
+    // Runs one configuration end to end over plain values, as the experiment would over ciphertexts
+    void Simulate(Dataset &dataset, const std::string &modelName, const ActivationFn activation,
+                  const ApproximationFn approximation, const uint16_t epochs, const int8_t earlyBootstrapping,
+                  const CostModel &costModel) {
+        const auto trainingFeatures = dataset.GetTrainingFeatures();
+        const auto testingFeatures = dataset.GetTestingFeatures();
+        const auto testingLabels = dataset.GetTestingLabels();
+        const auto n_features = trainingFeatures[0].size();
+
+        auto ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+        ctx.SetEarlyBootstrapping(earlyBootstrapping);
+        ctx.GetSimulation().SetCostModel(costModel);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        const auto client = Client(ctx);
+        const auto eTrainingFeatures = client.EncryptCKKS(trainingFeatures);
+        const auto eTrainingLabels = client.EncryptCKKS(dataset.GetTrainingLabels(), n_features);
+        const auto eTestingFeatures = client.EncryptCKKS(testingFeatures);
+
+        std::vector<double> predictions;
+        if (modelName == "lr") {
+            auto model = CkksLogisticRegression(ctx, n_features, epochs, 42, activation, approximation);
+            model.Fit(eTrainingFeatures, eTrainingLabels);
+            predictions = client.DecryptCKKS(model.PredictAll(eTestingFeatures));
+        } else {
+            auto model = CkksNeuralNetwork(ctx, n_features, epochs, {n_features, 5, 2, 1}, 42, activation,
+                                           approximation);
+            model.Fit(eTrainingFeatures, eTrainingLabels);
+            predictions = client.DecryptCKKS(model.PredictAll(eTestingFeatures));
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto threshold = Calculus::DecisionThreshold(activation);
+        size_t correct = 0;
+        for (size_t i = 0; i < predictions.size(); i++) {
+            correct += (predictions[i] > threshold ? 1.0 : 0.0) == testingLabels[i];
+        }
+
+        const auto &simulation = ctx.GetSimulation();
+        std::cout << dataset.GetName() << "," << modelName << "," << ActivationName(activation) << ","
+                << (Calculus::IsPolynomial(activation) ? "exact" : ApproximationName(approximation)) << ","
+                << epochs << ","
+                << static_cast<int>(earlyBootstrapping) << "," << simulation.GetTotalCount() << ","
+                << simulation.GetCount(SIM_MULT) << "," << simulation.GetCount(SIM_BOOTSTRAP) << ","
+                << simulation.EstimateSeconds() << ","
+                << static_cast<double>(correct) / static_cast<double>(predictions.size()) << ","
+                << elapsed.count() << std::endl;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    std::vector<std::unique_ptr<Dataset> > datasets;
+    datasets.emplace_back(std::make_unique<BreastCancerDataset>(FM11));
+    datasets.emplace_back(std::make_unique<DiabetesDataset>(FM11));
+    datasets.emplace_back(std::make_unique<GliomaGradingDataset>(FM11));
+    datasets.emplace_back(std::make_unique<DifferentiatedThyroidDataset>(FM11));
+    datasets.emplace_back(std::make_unique<CirrhosisPatientDataset>(FM11));
+
+    try {
+        if (argc > 1 && std::string(argv[1]) == "calibrate") {
+            // Costs depend on the ring dimension, which every dataset shares
+            const auto costsFile = argc > 2 ? std::string(argv[2]) : std::string("operation_costs.csv");
+            const auto repetitions = argc > 3 ? std::stoul(argv[3]) : 10;
+
+            const auto n_features = datasets[0]->GetTrainingFeatures()[0].size();
+            const auto costModel = CostModel::Calibrate(HEContextFactory::ckksHeContext(n_features), repetitions);
+            costModel.Save(costsFile);
+
+            for (uint32_t level = 0; level <= costModel.GetLevels(); level++) {
+                std::cout << "level " << level << ":";
+                for (auto op = 0; op < SIM_OPS; op++) {
+                    const auto simulatedOp = static_cast<SimulatedOp>(op);
+                    std::cout << " " << Simulation::GetName(simulatedOp) << " = "
+                            << costModel.GetCost(simulatedOp, static_cast<int32_t>(level)) << " ms";
+                }
+                std::cout << std::endl;
+            }
+            return 0;
+        }
+
+        const auto costsFile = argc > 1 ? std::string(argv[1]) : std::string("operation_costs.csv");
+        const auto epochs = argc > 2 ? std::stoi(argv[2]) : 1;
+
+        CostModel costModel;
+        if (std::filesystem::exists(costsFile)) {
+            costModel = CostModel::Load(costsFile);
+        } else {
+            std::cerr << costsFile << " not found, run calibrate first; estimated times will be zero" << std::endl;
+        }
+
+        std::cout << "dataset,model,activation,approximation,epochs,early_bootstrapping,operations,multiplications,"
+                "bootstraps,estimated_s,accuracy,simulated_s" << std::endl;
+
+        for (const auto &dataset: datasets) {
+            for (const auto &modelName: {"lr", "nn"}) {
+                for (const auto activation: {TANH, SIGMOID, SQUARE, SCALED_SQUARE, ODD_POLY}) {
+                    // Polynomial activations are evaluated exactly, so one pass covers every approximation
+                    const auto approximations = Calculus::IsPolynomial(activation)
+                                                    ? std::vector{CHEBYSHEV}
+                                                    : std::vector{CHEBYSHEV, TAYLOR, LEAST_SQUARES, MINIMAX};
+                    for (const auto approximation: approximations) {
+                        for (const int8_t earlyBootstrapping: {0, 1, 2}) {
+                            Simulate(*dataset, modelName, activation, approximation, epochs, earlyBootstrapping,
+                                     costModel);
+                        }
+                    }
+                }
+            }
+        }
+
+        return 0;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        Usage();
+        return 1;
+    }
+}
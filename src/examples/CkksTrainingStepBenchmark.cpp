@@ -0,0 +1,96 @@
+#include "client.h"
+#include "datasets.h"
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    void Usage() {
+        std::cerr << "Usage:" << std::endl;
+        std::cerr << "  CkksTrainingStepBenchmark [iterations]" << std::endl;
+    }
+
+    // Mean milliseconds of `timed`, each run on an operand freshly made by the untimed `prepare`
+    double MeasureMs(const uint32_t iterations, const std::function<BootstrapableCiphertext()> &prepare,
+                     const std::function<void(BootstrapableCiphertext &)> &timed) {
+        double meanMs = 0.0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            auto operand = prepare();
+
+            const auto start = std::chrono::steady_clock::now();
+            timed(operand);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            meanMs += elapsed.count() / iterations;
+        }
+
+        return meanMs;
+    }
+
+    int Benchmark(const uint32_t iterations) {
+        BreastCancerDataset dataset(FM11);
+        const auto trainingFeatures = dataset.GetTrainingFeatures();
+        const auto n_features = trainingFeatures[0].size();
+
+        const auto ctx = HEContextFactory::ckksHeContext(n_features);
+        const auto client = Client(ctx);
+        const EncryptedObject he(ctx);
+
+        const auto samples = std::min<size_t>(iterations, trainingFeatures.size());
+        const auto eFeatures = client.EncryptCKKS(
+            std::vector(trainingFeatures.begin(), trainingFeatures.begin() + static_cast<std::ptrdiff_t>(samples)));
+        const auto trainingLabels = dataset.GetTrainingLabels();
+        const auto eLabels = client.EncryptCKKS(
+            std::vector(trainingLabels.begin(), trainingLabels.begin() + static_cast<std::ptrdiff_t>(samples)),
+            n_features);
+
+        // The operands are products owned by the loop, as the weights and accumulators of Fit are, so the in-place
+        // variants never have to clone a shared ciphertext
+        const auto &x = eFeatures.front();
+        const auto product = [&he, &x] { return he.EvalMult(x, x); };
+
+        std::cout << "operation,mean_ms" << std::endl;
+        std::cout << "mult," << MeasureMs(iterations, product, [&he, &x](auto &c) { c = he.EvalMult(c, x); })
+                << std::endl;
+        std::cout << "mult_in_place," << MeasureMs(iterations, product, [&he, &x](auto &c) {
+            he.EvalMultInPlace(c, x);
+        }) << std::endl;
+        std::cout << "add," << MeasureMs(iterations, product, [&he, &x](auto &c) { c = he.EvalAdd(c, x); })
+                << std::endl;
+        std::cout << "add_in_place," << MeasureMs(iterations, product, [&he, &x](auto &c) {
+            he.EvalAddInPlace(c, x);
+        }) << std::endl;
+
+        // One sample of the logistic regression inner loop: forward pass, error, weight and bias update
+        auto model = CkksLogisticRegression(ctx, n_features, 1);
+        model.Initialize();
+
+        double stepMs = 0.0;
+        for (size_t i = 0; i < samples; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            model.ApplyGradients(model.ComputeGradients(eFeatures, eLabels, i, i + 1), 0.0);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            stepMs += elapsed.count() / static_cast<double>(samples);
+        }
+
+        std::cout << "training_step," << stepMs << std::endl;
+
+        return 0;
+    }
+}
+
+int main(const int argc, char *argv[]) {
+    try {
+        if (argc > 2) {
+            Usage();
+            return 1;
+        }
+
+        const auto iterations = argc > 1 ? std::stoul(argv[1]) : 20;
+
+        return Benchmark(iterations);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
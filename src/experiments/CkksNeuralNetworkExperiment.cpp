@@ -16,6 +16,43 @@ namespace hermesml {
                                                                        params(params) {
     }
 
+    RuntimeEstimate CkksNeuralNetworkExperiment::Simulate(const CostModel &costModel) const {
+        const auto trainingFeatures = this->GetDataset().GetTrainingFeatures();
+        const auto testingFeatures = this->GetDataset().GetTestingFeatures();
+        const auto n_features = trainingFeatures[0].size();
+        const std::vector<size_t> layers = {n_features, 5, 2, 1};
+
+        // The same steps as RunMemory, over plain values, with the operations of each stage charged separately
+        auto ctx = HEContextFactory::simulatedCkksHeContext(n_features, this->params.batchedInference);
+        const auto labelEncoding = TrainingSet::SupportedEncoding(ctx, this->params.labelEncoding);
+        ctx.SetEarlyBootstrapping(this->params.earlyBootstrapping);
+        auto &simulation = ctx.GetSimulation();
+        simulation.SetCostModel(costModel);
+
+        RuntimeEstimate estimate;
+        const auto client = Client(ctx);
+        const auto eTrainingSet = client.EncryptTrainingSet(trainingFeatures, this->GetDataset().GetTrainingLabels(),
+                                                            labelEncoding);
+        const auto inferenceDepth = CkksNeuralNetwork::InferenceDepth(ctx, layers, this->params.activation,
+                                                                      this->params.approximation);
+        const auto eTestingData = this->params.batchedInference
+                                      ? client.EncryptCKKSPacked(testingFeatures, inferenceDepth)
+                                      : client.EncryptCKKS(testingFeatures, inferenceDepth);
+        estimate.encryptingSeconds = simulation.EstimateSeconds();
+        simulation.Reset();
+
+        auto clf = CkksNeuralNetwork(ctx, n_features, this->params.epochs, layers, 42, this->params.activation,
+                                     this->params.approximation);
+        clf.Fit(eTrainingSet);
+        estimate.trainingSeconds = simulation.EstimateSeconds();
+        simulation.Reset();
+
+        (void) (this->params.batchedInference ? clf.PredictAllPacked(eTestingData) : clf.PredictAll(eTestingData));
+        estimate.testingSeconds = simulation.EstimateSeconds();
+
+        return estimate;
+    }
+
     void CkksNeuralNetworkExperiment::Run() {
         RunMemory();
     }
@@ -35,6 +72,13 @@ namespace hermesml {
         }
 
         this->Info("Initiating experiment " + this->GetExperimentId());
+
+        if (const auto &estimate = this->GetEstimate(); estimate.GetTotalSeconds() > 0.0) {
+            this->Info("Estimated time: encrypting " + std::to_string(estimate.encryptingSeconds) + " s, training " +
+                       std::to_string(estimate.trainingSeconds) + " s, testing " +
+                       std::to_string(estimate.testingSeconds) + " s");
+        }
+
         this->Info(">>>>> CLIENT SIDE PROCESSING");
 
         // Step 01 - read and normalize data
@@ -73,8 +117,19 @@ namespace hermesml {
 
         this->Info("Generate crypto context");
 
-        auto ckksCtx = HEContextFactory::ckksHeContext(n_features);
+        // A checkpointed run keeps its keys on disk, so an interrupted training can be resumed under them
+        auto ckksCtx = this->params.checkpointing
+                           ? HEContextFactory::LoadOrCreate(this->BuildCheckpointPath(), n_features,
+                                                            this->params.batchedInference)
+                           : HEContextFactory::ckksHeContext(n_features, this->params.batchedInference);
         ckksCtx.SetEarlyBootstrapping(this->params.earlyBootstrapping);
+        ckksCtx.SetEncryptionMode(this->params.secretKeyEncryption ? SECRET_KEY_ENCRYPTION : PUBLIC_KEY_ENCRYPTION);
+
+        if (const auto supported = TrainingSet::SupportedEncoding(ckksCtx, this->params.labelEncoding);
+            supported != this->params.labelEncoding) {
+            this->Info("The features fill every slot, so the labels are packed instead");
+            this->params.labelEncoding = supported;
+        }
 
         auto ckksClient = Client(ckksCtx);
         auto cc = ckksCtx.GetCc();
@@ -87,27 +142,37 @@ namespace hermesml {
         this->Info("Modulus: " + cc->GetModulus().ToString());
         this->Info("Multiplicative depth: " + std::to_string(ckksCtx.GetMultiplicativeDepth()));
         this->Info("Early Boostrapping: " + std::to_string(ckksCtx.GetEarlyBootstrapping()));
+        this->Info("Secret-key encryption: " + std::to_string(this->params.secretKeyEncryption));
         this->Info("Number of Slots: " + std::to_string(ckksCtx.GetNumSlots()));
+        this->Info("Samples per testing ciphertext: " + std::to_string(
+                       this->params.batchedInference ? ckksCtx.GetSamplesPerCiphertext() : 1));
 
         //-----------------------------------------------------------------------------------------------------------------
 
         // Step 03 - Encrypt training data
 
+        const std::vector<size_t> layers = {n_features, 5, 2, 1};
+
         start = std::chrono::high_resolution_clock::now();
 
-        std::vector<BootstrapableCiphertext> eTrainingData, eTrainingLabels, eTestingData, eTestingLabels;
+        std::vector<BootstrapableCiphertext> eTestingData, eTestingLabels;
 
         this->Info("Encrypting training data");
-        eTrainingData = ckksClient.EncryptCKKS(trainingFeatures);
-        eTrainingLabels = ckksClient.EncryptCKKS(trainingLabels, trainingFeatures[0].size());
-        eTestingData = ckksClient.EncryptCKKS(testingFeatures);
-        eTestingLabels = ckksClient.EncryptCKKS(testingLabels, testingFeatures[0].size());
-
-        if (eTrainingData.size() != eTrainingLabels.size()) {
-            throw std::runtime_error("Wrong number of encrypted training features and labels provided!");
-        }
-
-        if (eTestingData.size() != eTestingLabels.size()) {
+        const auto eTrainingSet = ckksClient.EncryptTrainingSet(trainingFeatures, trainingLabels,
+                                                                this->params.labelEncoding);
+        // Testing data only goes through Predict, so it is encrypted with just the levels that takes. Batched inference
+        // packs several testing samples into each ciphertext
+        const auto inferenceDepth = CkksNeuralNetwork::InferenceDepth(ckksCtx, layers, this->params.activation,
+                                                                      this->params.approximation);
+        eTestingData = this->params.batchedInference
+                           ? ckksClient.EncryptCKKSPacked(testingFeatures, inferenceDepth)
+                           : ckksClient.EncryptCKKS(testingFeatures, inferenceDepth);
+        eTestingLabels = this->params.labelEncoding == REPLICATED_LABELS
+                             ? ckksClient.EncryptCKKS(testingLabels, testingFeatures[0].size())
+                             : ckksClient.EncryptCKKSLabels(testingLabels);
+
+        if (!this->params.batchedInference && this->params.labelEncoding == REPLICATED_LABELS &&
+            eTestingData.size() != eTestingLabels.size()) {
             throw std::runtime_error("Wrong number of encrypted testing features and labels provided!");
         }
 
@@ -116,82 +181,69 @@ namespace hermesml {
 
         this->Info("Elapsed time: " + std::to_string(this->encryptingTime.count()) + " ms");
 
+        const auto eDataBytes = eTrainingSet.GetCiphertextBytes() +
+                                MemoryFootprint::CiphertextBytes(eTestingData) +
+                                MemoryFootprint::CiphertextBytes(eTestingLabels);
+        this->SampleMemory("encrypting", eDataBytes);
+
         // S E R V E R   S I D E   P R O C E S S I N G --------------------------------------------------------------------
 
         this->Info(">>>>> SERVER SIDE PROCESSING");
 
-        std::vector<size_t> layers = {n_features, 5, 2, 1};
         auto clf = CkksNeuralNetwork(ckksCtx, n_features, params.epochs, layers, 42, params.activation,
                                      params.approximation);
 
+        if (this->params.checkpointing) {
+            clf.SetCheckpointOptions({this->BuildCheckpointPath(), this->params.checkpointEverySamples, 1});
+        }
+
         // Step 04 - Train the model
 
         this->Info("Train model");
 
         start = std::chrono::high_resolution_clock::now();
 
-        clf.Fit(eTrainingData, eTrainingLabels);
+        clf.SetProgressCallback(this->TrackProgress("Training", this->GetEstimate().trainingSeconds));
+        clf.Fit(eTrainingSet);
 
         end = std::chrono::high_resolution_clock::now();
         this->trainingTime = end - start;
 
         this->Info("Elapsed time: " + std::to_string(this->trainingTime.count()) + " ms");
 
+        this->SampleMemory("training", eDataBytes + clf.GetCiphertextBytes());
+
         // Step 05 - Test the model
 
         this->Info("Test model");
 
-        // Open the file in write mode
-        auto predictionsFileName = this->BuildFilePath("predictions.csv");
-
-        if (std::filesystem::exists(predictionsFileName)) {
-            std::filesystem::remove(predictionsFileName);
-        }
-
-        std::ofstream predictionsFile(predictionsFileName);
-
-        if (!predictionsFile) {
-            this->Error("Could not open the file " + predictionsFileName + " for writing.\n");
-            return;
-        }
-
         start = std::chrono::high_resolution_clock::now();
 
-        Plaintext plain_label;
-
-        for (size_t i = 0; i < eTestingData.size(); i++) {
-            const auto &eFeatures = eTestingData[i];
-            const auto ePredictedLabel = clf.Predict(eFeatures).GetCiphertext();
-            cc->Decrypt(ckksCtx.GetPrivateKey(), ePredictedLabel, &plain_label);
-            const auto pPrediction = plain_label->GetCKKSPackedValue()[0].real();
+        const auto ePredictions = this->params.batchedInference
+                                      ? clf.PredictAllPacked(eTestingData)
+                                      : clf.PredictAll(eTestingData);
 
-            double pPredictedLabel = 0.0;
-            switch (this->params.activation) {
-                case TANH:
-                    pPredictedLabel = pPrediction > 0.0 ? 1.0 : 0.0;
-                    break;
-
-                case SIGMOID:
-                    pPredictedLabel = pPrediction > 0.5 ? 1.0 : 0.0;
-                    break;
-
-                default:
-                    pPredictedLabel = pPrediction > 0.5 ? 1.0 : 0.0;
-                    break;
-            }
+        end = std::chrono::high_resolution_clock::now();
+        this->testingTime = end - start;
 
-            const auto realLabel = testingLabels[i];
+        this->Info("Elapsed time: " + std::to_string(this->testingTime.count()) + " ms");
 
-            predictionsFile << pPrediction << "," << realLabel << "," << pPredictedLabel << std::endl;
-        }
+        // Decrypting and writing the predictions is client-side work, so it is timed apart from the model
+        start = std::chrono::high_resolution_clock::now();
 
-        // Close the file
-        predictionsFile.close();
+        const auto pPredictions = this->params.batchedInference
+                                      ? ckksClient.DecryptPacked(ePredictions, testingLabels.size())
+                                      : ckksClient.DecryptCKKS(ePredictions);
+        this->metrics = this->WritePredictions(pPredictions, testingLabels,
+                                               Calculus::DecisionThreshold(this->params.activation));
 
         end = std::chrono::high_resolution_clock::now();
-        this->testingTime = end - start;
+        this->collectingTime = end - start;
 
-        this->Info("Elapsed time: " + std::to_string(this->testingTime.count()) + " ms");
+        this->Info("Collecting time: " + std::to_string(this->collectingTime.count()) + " ms");
+
+        this->SampleMemory("testing", eDataBytes + clf.GetCiphertextBytes() +
+                                      MemoryFootprint::CiphertextBytes(ePredictions));
 
         //-------------------------------------------------------------------------------------------------------------
 
@@ -206,7 +258,7 @@ namespace hermesml {
         std::ofstream parametersFile(parametersFileName);
 
         if (!parametersFile) {
-            this->Error("Could not open the file " + predictionsFileName + " for writing.\n");
+            this->Error("Could not open the file " + parametersFileName + " for writing.\n");
             return;
         }
 
@@ -218,6 +270,10 @@ namespace hermesml {
 
         // Write the data to the file
         parametersFile << "epochs = " << this->params.epochs << std::endl;
+        parametersFile << "batchedInference = " << this->params.batchedInference << std::endl;
+        parametersFile << "secretKeyEncryption = " << this->params.secretKeyEncryption << std::endl;
+        parametersFile << "labelEncoding = " << this->params.labelEncoding << std::endl;
+        parametersFile << "testingCiphertexts = " << eTestingData.size() << std::endl;
         parametersFile << "datasetLength = " << this->datasetLength << std::endl;
         parametersFile << "trainingRatio = " << this->trainingRatio << std::endl;
         parametersFile << "trainingLength = " << this->trainingLength << std::endl;
@@ -227,10 +283,21 @@ namespace hermesml {
         parametersFile << "encryptingTime = " << std::to_string(this->encryptingTime.count()) << std::endl;
         parametersFile << "trainingTime = " << std::to_string(this->trainingTime.count()) << std::endl;
         parametersFile << "testingTime = " << std::to_string(this->testingTime.count()) << std::endl;
+        parametersFile << "collectingTime = " << std::to_string(this->collectingTime.count()) << std::endl;
+        parametersFile << "estimatedTime = " << std::to_string(this->GetEstimate().GetTotalSeconds()) << std::endl;
+        WriteMetrics(parametersFile, this->metrics);
+        parametersFile << "ciphertextBytes = " << std::to_string(eDataBytes + clf.GetCiphertextBytes()) << std::endl;
+        parametersFile << "peakRss = " << std::to_string(MemoryFootprint::PeakRss()) << std::endl;
 
         // Close the file
         parametersFile.close();
 
+        this->DumpMemory(ckksCtx);
+
+        if constexpr (Tracer::IsEnabled()) {
+            Tracer::Get().Flush(this->BuildFilePath("trace.json"));
+        }
+
         this->Info("Experiment " + this->GetExperimentId() + " completed!");
     }
 
@@ -279,8 +346,12 @@ namespace hermesml {
 
         this->Info("Generate crypto context");
 
-        auto ckksCtx = HEContextFactory::ckksHeContext(n_features);
+        // A checkpointed run keeps its keys on disk, so an interrupted training can be resumed under them
+        auto ckksCtx = this->params.checkpointing
+                           ? HEContextFactory::LoadOrCreate(this->BuildCheckpointPath(), n_features)
+                           : HEContextFactory::ckksHeContext(n_features);
         ckksCtx.SetEarlyBootstrapping(this->params.earlyBootstrapping);
+        ckksCtx.SetEncryptionMode(this->params.secretKeyEncryption ? SECRET_KEY_ENCRYPTION : PUBLIC_KEY_ENCRYPTION);
 
         auto ckksClient = Client(ckksCtx);
         auto cc = ckksCtx.GetCc();
@@ -292,6 +363,7 @@ namespace hermesml {
         this->Info("Modulus: " + cc->GetModulus().ToString());
         this->Info("Multiplicative depth: " + std::to_string(ckksCtx.GetMultiplicativeDepth()));
         this->Info("Early Boostrapping: " + std::to_string(ckksCtx.GetEarlyBootstrapping()));
+        this->Info("Secret-key encryption: " + std::to_string(this->params.secretKeyEncryption));
         this->Info("Number of Slots: " + std::to_string(ckksCtx.GetNumSlots()));
 
         //-----------------------------------------------------------------------------------------------------------------
@@ -320,6 +392,12 @@ namespace hermesml {
 
         this->Info("Elapsed time: " + std::to_string(this->encryptingTime.count()) + " ms");
 
+        const auto eFileBytes = std::filesystem::file_size(eTrainingFeaturesFilePath) +
+                                std::filesystem::file_size(eTrainingLabelsFilePath) +
+                                std::filesystem::file_size(eTestingFeaturesFilePath) +
+                                std::filesystem::file_size(eTestingLabelsFilePath);
+        this->SampleMemory("encrypting", 0);
+
         // S E R V E R   S I D E   P R O C E S S I N G --------------------------------------------------------------------
 
         this->Info(">>>>> SERVER SIDE PROCESSING");
@@ -328,6 +406,10 @@ namespace hermesml {
         auto clf = CkksNeuralNetwork(ckksCtx, n_features, params.epochs, layers, 42, params.activation,
                                      params.approximation);
 
+        if (this->params.checkpointing) {
+            clf.SetCheckpointOptions({this->BuildCheckpointPath(), this->params.checkpointEverySamples, 1});
+        }
+
         // Step 04 - Train the model
 
         this->Info("Train model");
@@ -341,62 +423,34 @@ namespace hermesml {
 
         this->Info("Elapsed time: " + std::to_string(this->trainingTime.count()) + " ms");
 
+        this->SampleMemory("training", clf.GetCiphertextBytes());
+
         // Step 05 - Test the model
 
         this->Info("Test model");
 
-        // Open the file in write mode
-        auto predictionsFileName = this->BuildFilePath("predictions.csv");
-
-        if (std::filesystem::exists(predictionsFileName)) {
-            std::filesystem::remove(predictionsFileName);
-        }
-
-        std::ofstream predictionsFile(predictionsFileName);
-
-        if (!predictionsFile) {
-            this->Error("Could not open the file " + predictionsFileName + " for writing.\n");
-            return;
-        }
-
         start = std::chrono::high_resolution_clock::now();
 
-        auto i = 0;
         const auto ePredictions = clf.PredictAll(eTestingFeaturesFilePath);
 
-        for (const auto &ePrediction: ePredictions) {
-            Plaintext plain_label;
-            cc->Decrypt(ckksCtx.GetPrivateKey(), ePrediction.GetCiphertext(), &plain_label);
-            const auto pPrediction = plain_label->GetCKKSPackedValue()[0].real();
-
-            double pPredictedLabel = 0.0;
-            switch (this->params.activation) {
-                case TANH:
-                    pPredictedLabel = pPrediction > 0.0 ? 1.0 : 0.0;
-                    break;
-
-                case SIGMOID:
-                    pPredictedLabel = pPrediction > 0.5 ? 1.0 : 0.0;
-                    break;
-
-                default:
-                    pPredictedLabel = pPrediction > 0.5 ? 1.0 : 0.0;
-                    break;
-            }
+        end = std::chrono::high_resolution_clock::now();
+        this->testingTime = end - start;
 
-            const auto realLabel = testingLabels[i];
-            predictionsFile << pPrediction << "," << realLabel << "," << pPredictedLabel << std::endl;
+        this->Info("Elapsed time: " + std::to_string(this->testingTime.count()) + " ms");
 
-            i++;
-        }
+        // Decrypting and writing the predictions is client-side work, so it is timed apart from the model
+        start = std::chrono::high_resolution_clock::now();
 
-        // Close the file
-        predictionsFile.close();
+        const auto pPredictions = ckksClient.DecryptCKKS(ePredictions);
+        this->metrics = this->WritePredictions(pPredictions, testingLabels,
+                                               Calculus::DecisionThreshold(this->params.activation));
 
         end = std::chrono::high_resolution_clock::now();
-        this->testingTime = end - start;
+        this->collectingTime = end - start;
 
-        this->Info("Elapsed time: " + std::to_string(this->testingTime.count()) + " ms");
+        this->Info("Collecting time: " + std::to_string(this->collectingTime.count()) + " ms");
+
+        this->SampleMemory("testing", clf.GetCiphertextBytes() + MemoryFootprint::CiphertextBytes(ePredictions));
 
         //-------------------------------------------------------------------------------------------------------------
 
@@ -411,7 +465,7 @@ namespace hermesml {
         std::ofstream parametersFile(parametersFileName);
 
         if (!parametersFile) {
-            this->Error("Could not open the file " + predictionsFileName + " for writing.\n");
+            this->Error("Could not open the file " + parametersFileName + " for writing.\n");
             return;
         }
 
@@ -432,10 +486,21 @@ namespace hermesml {
         parametersFile << "encryptingTime = " << std::to_string(this->encryptingTime.count()) << std::endl;
         parametersFile << "trainingTime = " << std::to_string(this->trainingTime.count()) << std::endl;
         parametersFile << "testingTime = " << std::to_string(this->testingTime.count()) << std::endl;
+        parametersFile << "collectingTime = " << std::to_string(this->collectingTime.count()) << std::endl;
+        WriteMetrics(parametersFile, this->metrics);
+        parametersFile << "ciphertextBytes = " << std::to_string(clf.GetCiphertextBytes()) << std::endl;
+        parametersFile << "ciphertextFileBytes = " << std::to_string(eFileBytes) << std::endl;
+        parametersFile << "peakRss = " << std::to_string(MemoryFootprint::PeakRss()) << std::endl;
 
         // Close the file
         parametersFile.close();
 
+        this->DumpMemory(ckksCtx);
+
+        if constexpr (Tracer::IsEnabled()) {
+            Tracer::Get().Flush(this->BuildFilePath("trace.json"));
+        }
+
         /*
         std::remove(eTrainingFeaturesFilePath.c_str());
         std::remove(eTrainingLabelsFilePath.c_str());
@@ -0,0 +1,101 @@
+#include "graph.h"
+
+namespace hermesml {
+    ComputationGraph::ComputationGraph(const HEContext &ctx) : EncryptedObject(ctx) {
+    }
+
+    NodeId ComputationGraph::Record(std::string label, Operation operation, std::vector<NodeId> inputs) {
+        for (const auto input: inputs) {
+            if (input >= this->nodes.size()) {
+                throw std::invalid_argument("Unknown graph node " + std::to_string(input));
+            }
+        }
+
+        this->nodes.push_back(Node{
+            std::move(operation), std::move(inputs), BootstrapableCiphertext(), std::move(label)
+        });
+        return this->nodes.size() - 1;
+    }
+
+    NodeId ComputationGraph::Input(const BootstrapableCiphertext &ciphertext) {
+        this->nodes.push_back(Node{Operation(), {}, ciphertext, "Input"});
+        return this->nodes.size() - 1;
+    }
+
+    NodeId ComputationGraph::Add(const NodeId a, const NodeId b) {
+        return this->Record("Add", [this](const auto &in) { return this->EvalAdd(*in[0], *in[1]); }, {a, b});
+    }
+
+    NodeId ComputationGraph::Sub(const NodeId a, const NodeId b) {
+        return this->Record("Sub", [this](const auto &in) { return this->EvalSub(*in[0], *in[1]); }, {a, b});
+    }
+
+    NodeId ComputationGraph::Mult(const NodeId a, const NodeId b) {
+        return this->Record("Mult", [this](const auto &in) { return this->EvalMult(*in[0], *in[1]); }, {a, b});
+    }
+
+    NodeId ComputationGraph::Sum(const NodeId a) {
+        return this->Record("Sum", [this](const auto &in) { return this->EvalSum(*in[0]); }, {a});
+    }
+
+    NodeId ComputationGraph::Rotate(const NodeId a, const int32_t index) {
+        return this->Record("Rotate", [this, index](const auto &in) { return this->EvalRotate(*in[0], index); }, {a});
+    }
+
+    NodeId ComputationGraph::Flatten(const NodeId a) {
+        return this->Record("Flatten", [this](const auto &in) { return this->EvalFlatten(*in[0]); }, {a});
+    }
+
+    NodeId ComputationGraph::Merge(const std::vector<NodeId> &inputs) {
+        return this->Record("Merge", [this](const auto &in) {
+            std::vector<BootstrapableCiphertext> ciphertexts;
+            ciphertexts.reserve(in.size());
+            for (const auto *c: in) {
+                ciphertexts.push_back(*c);
+            }
+            return this->EvalMerge(ciphertexts);
+        }, inputs);
+    }
+
+    NodeId ComputationGraph::InnerProduct(const std::vector<NodeId> &a, const std::vector<NodeId> &b) {
+        if (a.size() != b.size()) {
+            throw std::invalid_argument("Cannot pair " + std::to_string(a.size()) + " values with " +
+                                        std::to_string(b.size()));
+        }
+
+        // Both operand lists travel as one input list: the first half pairs with the second
+        auto inputs = a;
+        inputs.insert(inputs.end(), b.begin(), b.end());
+
+        return this->Record("InnerProduct", [this](const auto &in) {
+            const auto half = in.size() / 2;
+            std::vector<BootstrapableCiphertext> ciphertexts1, ciphertexts2;
+            ciphertexts1.reserve(half);
+            ciphertexts2.reserve(half);
+            for (size_t i = 0; i < half; i++) {
+                ciphertexts1.push_back(*in[i]);
+                ciphertexts2.push_back(*in[half + i]);
+            }
+            return this->EvalInnerProduct(ciphertexts1, ciphertexts2);
+        }, std::move(inputs));
+    }
+
+    NodeId ComputationGraph::WeightedSum(const NodeId weights, const NodeId features, const NodeId bias) {
+        return this->Record("WeightedSum", [this](const auto &in) {
+            return this->EncryptedObject::WeightedSum(*in[0], *in[1], *in[2]);
+        }, {weights, features, bias});
+    }
+
+    NodeId ComputationGraph::Apply(const NodeId a,
+                                   std::function<BootstrapableCiphertext(const BootstrapableCiphertext &)> fn) {
+        return this->Record("Apply", [fn = std::move(fn)](const auto &in) { return fn(*in[0]); }, {a});
+    }
+
+    void ComputationGraph::Label(const NodeId a, std::string label) {
+        this->nodes.at(a).label = std::move(label);
+    }
+
+    const std::vector<ComputationGraph::Node> &ComputationGraph::GetNodes() const {
+        return this->nodes;
+    }
+}
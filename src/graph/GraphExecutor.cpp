@@ -0,0 +1,211 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "graph.h"
+
+namespace hermesml {
+    namespace {
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<NodeId> nodes;
+        };
+    }
+
+    GraphExecutor::GraphExecutor(const uint32_t workers) : workers(workers) {
+    }
+
+    std::vector<BootstrapableCiphertext> GraphExecutor::Run(const ComputationGraph &graph,
+                                                            const std::vector<NodeId> &outputs) const {
+        const auto &nodes = graph.GetNodes();
+
+        // Only what the outputs depend on is evaluated
+        std::vector needed(nodes.size(), false);
+        std::vector<NodeId> stack(outputs.begin(), outputs.end());
+        while (!stack.empty()) {
+            const auto id = stack.back();
+            stack.pop_back();
+
+            if (id >= nodes.size()) {
+                throw std::invalid_argument("Unknown graph node " + std::to_string(id));
+            }
+            if (needed[id]) {
+                continue;
+            }
+
+            needed[id] = true;
+            stack.insert(stack.end(), nodes[id].inputs.begin(), nodes[id].inputs.end());
+        }
+
+        // A node is ready once all its inputs ran, and its value is dropped once all its consumers ran. Outputs hold
+        // one extra reference, so they survive until they are returned
+        std::vector<std::atomic<size_t> > pending(nodes.size());
+        std::vector<std::atomic<size_t> > consumers(nodes.size());
+        std::vector<std::vector<NodeId> > dependents(nodes.size());
+        size_t total = 0;
+
+        for (NodeId id = 0; id < nodes.size(); id++) {
+            if (!needed[id]) {
+                continue;
+            }
+
+            total++;
+            pending[id] = nodes[id].inputs.size();
+            for (const auto input: nodes[id].inputs) {
+                ++consumers[input];
+                dependents[input].push_back(id);
+            }
+        }
+        for (const auto id: outputs) {
+            ++consumers[id];
+        }
+
+        const auto &policy = graph.GetCtx().GetThreadingPolicy();
+        const auto nWorkers = policy.ResolveWorkers(this->workers, total);
+
+        std::vector<BootstrapableCiphertext> values(nodes.size());
+        std::vector<WorkQueue> queues(nWorkers);
+        std::atomic<size_t> queued{0};
+        std::atomic<size_t> completed{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex idleMutex;
+        std::condition_variable idle;
+
+        const auto push = [&](const uint32_t worker, const NodeId id) {
+            {
+                // Counted before it is visible, so a thief can never take the count below zero. The idle lock keeps
+                // the notification from slipping between a worker's check and its wait
+                std::lock_guard lock(idleMutex);
+                ++queued;
+            }
+            {
+                std::lock_guard lock(queues[worker].mutex);
+                queues[worker].nodes.push_back(id);
+            }
+            idle.notify_one();
+        };
+
+        const auto pop = [&](const uint32_t worker, NodeId &id) {
+            // Newest first from our own queue, so a chain stays on one core; oldest first from the others
+            for (uint32_t k = 0; k < nWorkers; k++) {
+                auto &queue = queues[(worker + k) % nWorkers];
+                std::lock_guard lock(queue.mutex);
+
+                if (queue.nodes.empty()) {
+                    continue;
+                }
+
+                if (k == 0) {
+                    id = queue.nodes.back();
+                    queue.nodes.pop_back();
+                } else {
+                    id = queue.nodes.front();
+                    queue.nodes.pop_front();
+                }
+                --queued;
+                return true;
+            }
+            return false;
+        };
+
+        const auto release = [&](const NodeId id) {
+            if (--consumers[id] == 0) {
+                values[id] = BootstrapableCiphertext();
+            }
+        };
+
+        const auto execute = [&](const uint32_t worker, const NodeId id) {
+            const auto &node = nodes[id];
+
+            if (node.operation) {
+                TRACE_SCOPE(node.label);
+                std::vector<const BootstrapableCiphertext *> inputs;
+                inputs.reserve(node.inputs.size());
+                for (const auto input: node.inputs) {
+                    inputs.push_back(&values[input]);
+                }
+
+                values[id] = node.operation(inputs);
+
+                for (const auto input: node.inputs) {
+                    release(input);
+                }
+            } else {
+                values[id] = node.value;
+            }
+
+            for (const auto dependent: dependents[id]) {
+                if (--pending[dependent] == 0) {
+                    push(worker, dependent);
+                }
+            }
+
+            if (++completed == total) {
+                std::lock_guard lock(idleMutex);
+                idle.notify_all();
+            }
+        };
+
+        const auto work = [&](const uint32_t worker) {
+            while (!failed && completed < total) {
+                NodeId id;
+                if (!pop(worker, id)) {
+                    std::unique_lock lock(idleMutex);
+                    idle.wait(lock, [&] { return failed || completed == total || queued > 0; });
+                    continue;
+                }
+
+                try {
+                    execute(worker, id);
+                } catch (...) {
+                    std::lock_guard lock(idleMutex);
+                    if (!failed.exchange(true)) {
+                        error = std::current_exception();
+                    }
+                    idle.notify_all();
+                }
+            }
+        };
+
+        uint32_t next = 0;
+        for (NodeId id = 0; id < nodes.size(); id++) {
+            if (needed[id] && pending[id] == 0) {
+                push(next, id);
+                next = (next + 1) % nWorkers;
+            }
+        }
+
+        if (nWorkers == 1) {
+            work(0);
+        } else {
+            // Every worker gets its own thread, so that pinning one never touches the caller's affinity
+            std::vector<std::thread> pool;
+            pool.reserve(nWorkers);
+            for (uint32_t w = 0; w < nWorkers; w++) {
+                pool.emplace_back([&policy, &work, nWorkers, w] {
+                    policy.EnterWorker(w, nWorkers);
+                    work(w);
+                });
+            }
+
+            for (auto &t: pool) {
+                t.join();
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        std::vector<BootstrapableCiphertext> results;
+        results.reserve(outputs.size());
+        for (const auto id: outputs) {
+            results.push_back(values[id]);
+        }
+
+        return results;
+    }
+}
@@ -0,0 +1,291 @@
+#include <iomanip>
+
+#include "hemath.h"
+
+namespace hermesml {
+    namespace {
+        // Chebyshev polynomials T_0..T_degree evaluated at t in [-1, 1]
+        std::vector<double> ChebyshevBasis(const double t, const uint32_t degree) {
+            std::vector<double> basis(degree + 1);
+            basis[0] = 1.0;
+            if (degree > 0) {
+                basis[1] = t;
+            }
+            for (uint32_t k = 2; k <= degree; k++) {
+                basis[k] = 2.0 * t * basis[k - 1] - basis[k - 2];
+            }
+            return basis;
+        }
+
+        double MapToInterval(const double t, const double lowerBound, const double upperBound) {
+            return 0.5 * (upperBound + lowerBound) + 0.5 * (upperBound - lowerBound) * t;
+        }
+
+        // Clenshaw recurrence over plain Chebyshev coefficients (c_0 not halved)
+        double EvaluateSeries(const std::vector<double> &coefficients, const double t) {
+            double b1 = 0.0;
+            double b2 = 0.0;
+            for (auto k = static_cast<int64_t>(coefficients.size()) - 1; k >= 1; k--) {
+                const double b0 = coefficients[k] + 2.0 * t * b1 - b2;
+                b2 = b1;
+                b1 = b0;
+            }
+            return coefficients[0] + t * b1 - b2;
+        }
+
+        // Gaussian elimination with partial pivoting; returns false on a singular system
+        bool Solve(std::vector<std::vector<double> > &a, std::vector<double> &b) {
+            const auto n = b.size();
+
+            for (size_t col = 0; col < n; col++) {
+                size_t pivot = col;
+                for (size_t row = col + 1; row < n; row++) {
+                    if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+                        pivot = row;
+                    }
+                }
+
+                if (std::abs(a[pivot][col]) < 1e-14) {
+                    return false;
+                }
+
+                std::swap(a[col], a[pivot]);
+                std::swap(b[col], b[pivot]);
+
+                for (size_t row = col + 1; row < n; row++) {
+                    const double factor = a[row][col] / a[col][col];
+                    for (size_t k = col; k < n; k++) {
+                        a[row][k] -= factor * a[col][k];
+                    }
+                    b[row] -= factor * b[col];
+                }
+            }
+
+            for (auto row = static_cast<int64_t>(n) - 1; row >= 0; row--) {
+                double sum = b[row];
+                for (size_t k = row + 1; k < n; k++) {
+                    sum -= a[row][k] * b[k];
+                }
+                b[row] = sum / a[row][row];
+            }
+
+            return true;
+        }
+    }
+
+    std::map<std::string, PolynomialApproximation> ApproximationFitter::cache;
+    std::mutex ApproximationFitter::cacheMutex;
+
+    std::vector<double> ApproximationFitter::LeastSquares(const std::function<double(double)> &f,
+                                                          const double lowerBound, const double upperBound,
+                                                          const uint32_t degree) {
+        // On Chebyshev nodes the discrete least-squares problem is orthogonal, so the projection is exact
+        const uint32_t numNodes = std::max<uint32_t>(4 * (degree + 1), 256);
+        std::vector<double> coefficients(degree + 1, 0.0);
+
+        for (uint32_t j = 0; j < numNodes; j++) {
+            const double t = std::cos(M_PI * (j + 0.5) / numNodes);
+            const double y = f(MapToInterval(t, lowerBound, upperBound));
+            const auto basis = ChebyshevBasis(t, degree);
+            for (uint32_t k = 0; k <= degree; k++) {
+                coefficients[k] += y * basis[k];
+            }
+        }
+
+        for (uint32_t k = 0; k <= degree; k++) {
+            coefficients[k] *= (k == 0 ? 1.0 : 2.0) / numNodes;
+        }
+
+        return coefficients;
+    }
+
+    std::vector<double> ApproximationFitter::Remez(const std::function<double(double)> &f, const double lowerBound,
+                                                   const double upperBound, const uint32_t degree) {
+        constexpr uint32_t maxIterations = 50;
+        constexpr uint32_t gridSize = 8192;
+        const uint32_t numPoints = degree + 2;
+
+        // Start from the Chebyshev extrema, which are already close to the optimal reference
+        std::vector<double> reference(numPoints);
+        for (uint32_t i = 0; i < numPoints; i++) {
+            reference[i] = -std::cos(M_PI * i / (numPoints - 1));
+        }
+
+        auto best = LeastSquares(f, lowerBound, upperBound, degree);
+        auto bestError = MaxError(f, lowerBound, upperBound, best);
+
+        for (uint32_t iteration = 0; iteration < maxIterations; iteration++) {
+            // Solve p(t_i) + (-1)^i E = f(t_i) for the coefficients and the levelled error E
+            std::vector a(numPoints, std::vector<double>(numPoints));
+            std::vector<double> b(numPoints);
+            for (uint32_t i = 0; i < numPoints; i++) {
+                const auto basis = ChebyshevBasis(reference[i], degree);
+                std::copy(basis.begin(), basis.end(), a[i].begin());
+                a[i][degree + 1] = (i % 2 == 0) ? 1.0 : -1.0;
+                b[i] = f(MapToInterval(reference[i], lowerBound, upperBound));
+            }
+
+            if (!Solve(a, b)) {
+                break;
+            }
+
+            const std::vector coefficients(b.begin(), b.begin() + degree + 1);
+            const double levelledError = std::abs(b[degree + 1]);
+
+            // Locate the extrema of the error, one per interval of constant sign
+            std::vector<double> extrema;
+            std::vector<double> extremaErrors;
+            double segmentBest = 0.0;
+            double segmentBestT = -1.0;
+            for (uint32_t j = 0; j <= gridSize; j++) {
+                const double t = -1.0 + 2.0 * j / gridSize;
+                const double e = f(MapToInterval(t, lowerBound, upperBound)) - EvaluateSeries(coefficients, t);
+
+                if (j > 0 && std::signbit(e) != std::signbit(segmentBest) && segmentBest != 0.0) {
+                    extrema.push_back(segmentBestT);
+                    extremaErrors.push_back(segmentBest);
+                    segmentBest = 0.0;
+                }
+
+                if (std::abs(e) >= std::abs(segmentBest)) {
+                    segmentBest = e;
+                    segmentBestT = t;
+                }
+            }
+            extrema.push_back(segmentBestT);
+            extremaErrors.push_back(segmentBest);
+
+            // Too many alternations: drop the weakest end until the reference has the right size
+            while (extrema.size() > numPoints) {
+                if (std::abs(extremaErrors.front()) < std::abs(extremaErrors.back())) {
+                    extrema.erase(extrema.begin());
+                    extremaErrors.erase(extremaErrors.begin());
+                } else {
+                    extrema.pop_back();
+                    extremaErrors.pop_back();
+                }
+            }
+
+            double maxError = 0.0;
+            for (const auto e: extremaErrors) {
+                maxError = std::max(maxError, std::abs(e));
+            }
+
+            if (maxError < bestError) {
+                best = coefficients;
+                bestError = maxError;
+            }
+
+            // Degenerate alternation (e.g. even degree of an odd function) or converged equioscillation
+            if (extrema.size() < numPoints || maxError - levelledError <= 1e-6 * maxError) {
+                break;
+            }
+
+            reference = extrema;
+        }
+
+        return best;
+    }
+
+    double ApproximationFitter::MaxError(const std::function<double(double)> &f, const double lowerBound,
+                                         const double upperBound, const std::vector<double> &coefficients) {
+        constexpr uint32_t gridSize = 8192;
+        double maxError = 0.0;
+
+        for (uint32_t j = 0; j <= gridSize; j++) {
+            const double t = -1.0 + 2.0 * j / gridSize;
+            const double e = f(MapToInterval(t, lowerBound, upperBound)) - EvaluateSeries(coefficients, t);
+            maxError = std::max(maxError, std::abs(e));
+        }
+
+        return maxError;
+    }
+
+    uint32_t ApproximationFitter::MaxDegree(const uint32_t depth) {
+        uint32_t degree = 1;
+        while (Calculus::ChebyshevDepth(degree + 1) <= depth && degree + 1 < 2031) {
+            degree++;
+        }
+        return degree;
+    }
+
+    PolynomialApproximation ApproximationFitter::Fit(const std::string &name, const std::function<double(double)> &f,
+                                                     const double lowerBound, const double upperBound,
+                                                     const double errorTarget, const uint32_t maxDepth,
+                                                     const FitCriterion criterion) {
+        // Full precision, so that targets such as 1e-7 and 1e-8 do not share an entry
+        std::ostringstream configuration;
+        configuration << std::setprecision(17) << name << "|" << lowerBound << "|" << upperBound << "|" << errorTarget
+                << "|" << maxDepth << "|" << criterion;
+        const auto key = configuration.str();
+
+        {
+            std::lock_guard lock(cacheMutex);
+            if (const auto it = cache.find(key); it != cache.end()) {
+                return it->second;
+            }
+        }
+
+        if (maxDepth < Calculus::ChebyshevDepth(1)) {
+            throw std::invalid_argument("Not enough depth to evaluate any Chebyshev series: " +
+                                        std::to_string(maxDepth));
+        }
+
+        // Walk up the degrees and keep the first one that meets the target
+        PolynomialApproximation approximation{};
+        const auto maxDegree = MaxDegree(maxDepth);
+        for (uint32_t degree = 1; degree <= maxDegree; degree++) {
+            const auto coefficients = criterion == FIT_MINIMAX
+                                          ? Remez(f, lowerBound, upperBound, degree)
+                                          : LeastSquares(f, lowerBound, upperBound, degree);
+
+            approximation.coefficients = coefficients;
+            approximation.lowerBound = lowerBound;
+            approximation.upperBound = upperBound;
+            approximation.degree = degree;
+            approximation.depth = Calculus::ChebyshevDepth(degree);
+            approximation.maxError = MaxError(f, lowerBound, upperBound, coefficients);
+
+            if (approximation.maxError <= errorTarget) {
+                break;
+            }
+        }
+
+        if (approximation.maxError > errorTarget) {
+            throw std::invalid_argument("No " + name + " approximation within depth " + std::to_string(maxDepth) +
+                                        " meets the error target " + std::to_string(errorTarget) +
+                                        "; degree " + std::to_string(approximation.degree) + " reaches " +
+                                        std::to_string(approximation.maxError));
+        }
+
+        // OpenFHE evaluates c_0 / 2 + sum c_k T_k, so the constant term is stored doubled
+        approximation.coefficients[0] *= 2.0;
+
+        std::lock_guard lock(cacheMutex);
+        cache.emplace(key, approximation);
+        return approximation;
+    }
+
+    double ApproximationFitter::Evaluate(const PolynomialApproximation &approximation, const double x) {
+        auto coefficients = approximation.coefficients;
+        coefficients[0] *= 0.5;
+
+        const double t = (2.0 * x - approximation.lowerBound - approximation.upperBound) /
+                         (approximation.upperBound - approximation.lowerBound);
+        return EvaluateSeries(coefficients, t);
+    }
+
+    PolynomialApproximation ApproximationFitter::Interpolate(const std::function<double(double)> &f,
+                                                             const double lowerBound, const double upperBound,
+                                                             const uint32_t degree) {
+        PolynomialApproximation approximation{};
+        approximation.coefficients = LeastSquares(f, lowerBound, upperBound, degree);
+        approximation.lowerBound = lowerBound;
+        approximation.upperBound = upperBound;
+        approximation.degree = degree;
+        approximation.depth = Calculus::ChebyshevDepth(degree);
+        approximation.maxError = MaxError(f, lowerBound, upperBound, approximation.coefficients);
+        approximation.coefficients[0] *= 2.0;
+        return approximation;
+    }
+}
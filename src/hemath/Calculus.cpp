@@ -1,28 +1,109 @@
+#include "expressions.h"
 #include "hemath.h"
 
 namespace hermesml {
+    namespace {
+        // Non-scalar products of a Paterson-Stockmeyer evaluation: the baby-step powers plus the giant steps
+        uint32_t ChebyshevProducts(const uint32_t degree) {
+            return static_cast<uint32_t>(std::ceil(std::sqrt(2.0 * degree)) + std::ceil(std::log2(degree)));
+        }
+
+        std::function<double(double)> PowerSeries(const std::vector<double> &coefficients) {
+            return [coefficients](const double x) {
+                double result = 0.0;
+                for (auto k = coefficients.rbegin(); k != coefficients.rend(); ++k) {
+                    result = result * x + *k;
+                }
+                return result;
+            };
+        }
+    }
+
     Calculus::Calculus(const HEContext &ctx) : EncryptedObject(ctx), constants(Constants(ctx)) {
     }
 
-    BootstrapableCiphertext Calculus::SigmoidChebyshev(const BootstrapableCiphertext &x) const {
-        constexpr auto levels = 4;
-        const auto decLevels = x.GetRemainingLevels() - levels;
+    uint32_t Calculus::ChebyshevDepth(const uint32_t degree) {
+        // Paterson-Stockmeyer depth of OpenFHE's Chebyshev series evaluation (see FUNCTION_EVALUATION.md)
+        const std::vector<std::pair<uint32_t, uint32_t> > depthByDegree = {
+            {5, 3}, {13, 4}, {27, 5}, {59, 6}, {119, 7}, {247, 8}, {495, 9}, {1007, 10}, {2031, 11}
+        };
+
+        for (const auto &[maxDegree, depth]: depthByDegree) {
+            if (degree <= maxDegree) {
+                return depth;
+            }
+        }
+
+        throw std::invalid_argument("Unsupported Chebyshev degree: " + std::to_string(degree));
+    }
+
+    uint32_t Calculus::PolyLinearDepth(const uint32_t degree) {
+        // Powers are built by repeated squaring, plus one level for the coefficient products
+        uint32_t depth = 0;
+        while ((1u << depth) < degree) {
+            depth++;
+        }
+        return depth + 1;
+    }
+
+    uint32_t Calculus::ActivationDepth(const HEContext &ctx, const ActivationFn activation,
+                                       const ApproximationFn approximation) {
+        if (IsPolynomial(activation)) {
+            return PolynomialDepth(activation);
+        }
+
+        switch (approximation) {
+            case TAYLOR:
+            case LEAST_SQUARES: return PolyLinearDepth(powerSeriesDegree);
+            case MINIMAX: return MinimaxApproximation(ctx, activation).depth;
+            default: return ChebyshevDepth(activation == SIGMOID ? sigmoidChebyshevDegree : tanhChebyshevDegree);
+        }
+    }
+
+    double Calculus::DecisionThreshold(const ActivationFn activation) {
+        switch (activation) {
+            case TANH:
+            case ODD_POLY: return 0.0;
+            default: return 0.5;
+        }
+    }
+
+    BootstrapableCiphertext Calculus::SimulatePolynomial(const BootstrapableCiphertext &x,
+                                                         const std::function<double(double)> &polynomial,
+                                                         const uint32_t products, const uint32_t depth) const {
+        auto values = x.GetValues();
+        std::transform(values.begin(), values.end(), values.begin(), polynomial);
+
+        // The products are spread over the levels the evaluation goes through
+        auto &simulation = this->GetCtx().GetSimulation();
+        const auto levels = std::max(depth, 1u);
+        for (uint32_t level = 0; level < levels; level++) {
+            const auto share = products / levels + (level < products % levels ? 1 : 0);
+            simulation.Count(SIM_MULT, x.GetRemainingLevels() - static_cast<int32_t>(level), share);
+        }
+        return BootstrapableCiphertext(std::move(values), x.GetRemainingLevels() - static_cast<int32_t>(depth),
+                                       x.GetAdditionsExecuted());
+    }
 
-        const auto b = this->
-                EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                      x.GetAdditionsExecuted()));
+    BootstrapableCiphertext Calculus::SigmoidChebyshev(const BootstrapableCiphertext &x) const {
+        constexpr auto degree = sigmoidChebyshevDegree;
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(ChebyshevDepth(degree)));
+
+        if (this->GetCtx().IsSimulated()) {
+            static const auto logistic = ApproximationFitter::Interpolate(
+                [](const double x1) { return 1.0 / (1.0 + exp(-x1)); }, -6.0, 6.0, degree);
+            return this->SimulatePolynomial(
+                b, [](const double x1) { return ApproximationFitter::Evaluate(logistic, x1); },
+                ChebyshevProducts(degree), ChebyshevDepth(degree));
+        }
 
-        auto c = this->GetCc()->EvalLogistic(b.GetCiphertext(), -6.0, 6.0, 5);
+        auto c = this->GetCc()->EvalLogistic(b.GetCiphertext(), -6.0, 6.0, degree);
         c = this->SafeRescaling(c);
 
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
     }
 
     BootstrapableCiphertext Calculus::SigmoidTaylor(const BootstrapableCiphertext &x) const {
-        const int decLevels = x.GetRemainingLevels() - 4;
-        const auto b = this->EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                                   x.GetAdditionsExecuted()));
-
         const std::vector<double> coefficients = {
             0.5,
             0.25,
@@ -32,16 +113,19 @@ namespace hermesml {
             0.00208333333333
         };
 
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(PolyLinearDepth(coefficients.size() - 1)));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(coefficients), coefficients.size() - 2,
+                                            PolyLinearDepth(coefficients.size() - 1));
+        }
+
         auto c = this->GetCc()->EvalPolyLinear(b.GetCiphertext(), coefficients);
         c = this->SafeRescaling(c);
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
     }
 
     BootstrapableCiphertext Calculus::SigmoidLeastSquares(const BootstrapableCiphertext &x) const {
-        const int decLevels = x.GetRemainingLevels() - 4;
-        const auto b = this->EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                                   x.GetAdditionsExecuted()));
-
         const std::vector<double> coefficients = {
             0.5,
             0.21703267840379,
@@ -51,32 +135,40 @@ namespace hermesml {
             0.000117906071735
         };
 
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(PolyLinearDepth(coefficients.size() - 1)));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(coefficients), coefficients.size() - 2,
+                                            PolyLinearDepth(coefficients.size() - 1));
+        }
+
         auto c = this->GetCc()->EvalPolyLinear(b.GetCiphertext(), coefficients);
         c = this->SafeRescaling(c);
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
     }
 
     BootstrapableCiphertext Calculus::TanhChebyshev(const BootstrapableCiphertext &x) const {
-        const int decLevels = x.GetRemainingLevels() - 7;
-
-        const auto b = this->
-                EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                      x.GetAdditionsExecuted()));
+        constexpr auto degree = tanhChebyshevDegree;
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(ChebyshevDepth(degree)));
+
+        if (this->GetCtx().IsSimulated()) {
+            static const auto hyperbolicTangent = ApproximationFitter::Interpolate(
+                [](const double x1) { return tanh(x1); }, -6.0, 6.0, degree);
+            return this->SimulatePolynomial(
+                b, [](const double x1) { return ApproximationFitter::Evaluate(hyperbolicTangent, x1); },
+                ChebyshevProducts(degree), ChebyshevDepth(degree));
+        }
 
         auto c = this->GetCc()->EvalChebyshevFunction(
             [](const double x1) { return tanh(x1); }, b.GetCiphertext(),
             -6, 6,
-            59);
+            degree);
         c = this->SafeRescaling(c);
 
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
     }
 
     BootstrapableCiphertext Calculus::TanhTaylor(const BootstrapableCiphertext &x) const {
-        const int decLevels = x.GetRemainingLevels() - 4;
-        const auto b = this->EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                                   x.GetAdditionsExecuted()));
-
         const std::vector<double> coefficients = {
             0.0,
             1.0,
@@ -86,16 +178,19 @@ namespace hermesml {
             0.1333333333333333,
         };
 
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(PolyLinearDepth(coefficients.size() - 1)));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(coefficients), coefficients.size() - 2,
+                                            PolyLinearDepth(coefficients.size() - 1));
+        }
+
         auto c = this->GetCc()->EvalPolyLinear(b.GetCiphertext(), coefficients);
         c = this->SafeRescaling(c);
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
     }
 
     BootstrapableCiphertext Calculus::TanhLeastSquares(const BootstrapableCiphertext &x) const {
-        const int decLevels = x.GetRemainingLevels() - 4;
-        const auto b = this->EvalBootstrap(BootstrapableCiphertext(x.GetCiphertext(), static_cast<int8_t>(decLevels),
-                                                                   x.GetAdditionsExecuted()));
-
         const std::vector<double> coefficients = {
             0.0,
             0.590585129666859,
@@ -105,71 +200,213 @@ namespace hermesml {
             0.000501961286007
         };
 
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(PolyLinearDepth(coefficients.size() - 1)));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(coefficients), coefficients.size() - 2,
+                                            PolyLinearDepth(coefficients.size() - 1));
+        }
+
         auto c = this->GetCc()->EvalPolyLinear(b.GetCiphertext(), coefficients);
         c = this->SafeRescaling(c);
-        return BootstrapableCiphertext(c, b.GetRemainingLevels(), b.GetAdditionsExecuted());
+        return this->Wrap(c, b.GetAdditionsExecuted());
+    }
+
+    BootstrapableCiphertext Calculus::EvalApproximation(const BootstrapableCiphertext &x,
+                                                        const PolynomialApproximation &approximation) const {
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(approximation.depth));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(
+                b, [&approximation](const double x1) { return ApproximationFitter::Evaluate(approximation, x1); },
+                ChebyshevProducts(approximation.degree), approximation.depth);
+        }
+
+        auto c = this->GetCc()->EvalChebyshevSeries(b.GetCiphertext(), approximation.coefficients,
+                                                    approximation.lowerBound, approximation.upperBound);
+        c = this->SafeRescaling(c);
+
+        return this->Wrap(c, b.GetAdditionsExecuted());
+    }
+
+    PolynomialApproximation Calculus::MinimaxApproximation(const HEContext &ctx, const ActivationFn activation) {
+        // Two levels stay in reserve for the operations around the series; the subtraction is unsigned
+        const auto levels = ctx.GetLevelsAfterBootstrapping();
+        if (levels <= 2) {
+            throw std::invalid_argument("A minimax approximation needs more than 2 levels after bootstrapping, got " +
+                                        std::to_string(levels));
+        }
+        const auto maxDepth = levels - 2;
+
+        if (activation == SIGMOID) {
+            return ApproximationFitter::Fit("sigmoid", [](const double x1) { return 1.0 / (1.0 + exp(-x1)); },
+                                            -6.0, 6.0, approximationErrorTarget, maxDepth);
+        }
+
+        return ApproximationFitter::Fit("tanh", [](const double x1) { return tanh(x1); },
+                                        -6.0, 6.0, approximationErrorTarget, maxDepth);
+    }
+
+    BootstrapableCiphertext Calculus::SigmoidMinimax(const BootstrapableCiphertext &x) const {
+        return this->EvalApproximation(x, MinimaxApproximation(this->GetCtx(), SIGMOID));
+    }
+
+    BootstrapableCiphertext Calculus::TanhMinimax(const BootstrapableCiphertext &x) const {
+        return this->EvalApproximation(x, MinimaxApproximation(this->GetCtx(), TANH));
     }
 
     BootstrapableCiphertext Calculus::Sigmoid(const BootstrapableCiphertext &x,
                                               const ApproximationFn approximation) const {
+        TRACE_SCOPE("Sigmoid");
         switch (approximation) {
             case CHEBYSHEV: return this->SigmoidChebyshev(x);
             case TAYLOR: return this->SigmoidTaylor(x);
             case LEAST_SQUARES: return this->SigmoidLeastSquares(x);
+            case MINIMAX: return this->SigmoidMinimax(x);
             default: return this->SigmoidChebyshev(x);
         }
     }
 
     BootstrapableCiphertext Calculus::SigmoidDerivative(const BootstrapableCiphertext &x,
                                                         const ApproximationFn approximation) const {
-        BootstrapableCiphertext s;
+        return this->SigmoidWithDerivative(x, approximation).derivative;
+    }
 
-        switch (approximation) {
-            case CHEBYSHEV:
-                s = this->SigmoidChebyshev(x);
-                break;
-            case TAYLOR:
-                s = this->SigmoidTaylor(x);
-                break;
-            case LEAST_SQUARES:
-                s = this->SigmoidLeastSquares(x);
-                break;
-        }
+    BootstrapableCiphertext Calculus::SigmoidDerivativeFromActivation(const BootstrapableCiphertext &s) const {
+        TRACE_SCOPE("SigmoidDerivative");
+        // s'(x) = s(x) * (1 - s(x)), expanded so that it is one product and one subtraction
+        return Evaluate(*this, s - s * s);
+    }
 
-        const auto term1 = this->EvalSub(this->constants.One(), s);
-        const auto d = this->EvalMult(term1, s);
-        return d;
+    ActivationOutput Calculus::SigmoidWithDerivative(const BootstrapableCiphertext &x,
+                                                     const ApproximationFn approximation) const {
+        auto s = this->Sigmoid(x, approximation);
+        auto d = this->SigmoidDerivativeFromActivation(s);
+        return ActivationOutput{std::move(s), std::move(d)};
     }
 
     BootstrapableCiphertext Calculus::Tanh(const BootstrapableCiphertext &x,
                                            const ApproximationFn approximation) const {
+        TRACE_SCOPE("Tanh");
         switch (approximation) {
             case CHEBYSHEV: return this->TanhChebyshev(x);
             case TAYLOR: return this->TanhTaylor(x);
             case LEAST_SQUARES: return this->TanhLeastSquares(x);
+            case MINIMAX: return this->TanhMinimax(x);
             default: return this->TanhChebyshev(x);
         }
     }
 
     BootstrapableCiphertext Calculus::TanhDerivative(const BootstrapableCiphertext &x,
                                                      const ApproximationFn approximation) const {
-        BootstrapableCiphertext s;
+        return this->TanhWithDerivative(x, approximation).derivative;
+    }
 
-        switch (approximation) {
-            case CHEBYSHEV:
-                s = this->TanhChebyshev(x);
+    BootstrapableCiphertext Calculus::TanhDerivativeFromActivation(const BootstrapableCiphertext &t) const {
+        TRACE_SCOPE("TanhDerivative");
+        // tanh'(x) = 1 - tanh(x)^2
+        return Evaluate(*this, this->constants.One() - t * t);
+    }
+
+    ActivationOutput Calculus::TanhWithDerivative(const BootstrapableCiphertext &x,
+                                                  const ApproximationFn approximation) const {
+        auto t = this->Tanh(x, approximation);
+        auto d = this->TanhDerivativeFromActivation(t);
+        return ActivationOutput{std::move(t), std::move(d)};
+    }
+
+    bool Calculus::IsPolynomial(const ActivationFn activation) {
+        return activation == SQUARE || activation == SCALED_SQUARE || activation == ODD_POLY;
+    }
+
+    uint32_t Calculus::PolynomialDepth(const ActivationFn activation) {
+        // The scalar products run on other operands than the square, so they share its levels
+        return activation == SQUARE ? 1 : 2;
+    }
+
+    std::vector<double> Calculus::DefaultCoefficients(const ActivationFn activation) {
+        switch (activation) {
+            case SQUARE: return {0.0, 0.0, 1.0};
+            case SCALED_SQUARE: return {0.1875, 0.5, 0.234375};
+            case ODD_POLY: return {0.0, 0.600460220878746, 0.0, -0.025485153088268};
+            default: throw std::invalid_argument("Not a polynomial activation: " + std::to_string(activation));
+        }
+    }
+
+    void Calculus::CheckCoefficients(const ActivationFn activation, const std::vector<double> &coefficients) {
+        const auto defaults = DefaultCoefficients(activation);
+
+        if (coefficients.size() != defaults.size()) {
+            throw std::invalid_argument("Activation " + std::to_string(activation) + " takes " +
+                                        std::to_string(defaults.size()) + " coefficients, got " +
+                                        std::to_string(coefficients.size()));
+        }
+        if (activation == SQUARE && coefficients != defaults) {
+            throw std::invalid_argument("SQUARE is x^2; scaled squares are SCALED_SQUARE");
+        }
+        if (activation == ODD_POLY && (coefficients[0] != 0.0 || coefficients[2] != 0.0)) {
+            throw std::invalid_argument("ODD_POLY only takes the coefficients of x and x^3");
+        }
+    }
+
+    BootstrapableCiphertext Calculus::Polynomial(const BootstrapableCiphertext &x, const ActivationFn activation,
+                                                 const std::vector<double> &coefficients) const {
+        TRACE_SCOPE("Polynomial");
+        const auto depth = PolynomialDepth(activation);
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(depth));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(coefficients), activation == ODD_POLY ? 2 : 1, depth);
+        }
+
+        const auto &cc = this->GetCc();
+        const auto &c = b.GetCiphertext();
+        Ciphertext<DCRTPoly> y;
+
+        switch (activation) {
+            case SQUARE:
+                y = cc->EvalSquare(c);
                 break;
-            case TAYLOR:
-                s = this->TanhTaylor(x);
+            case SCALED_SQUARE:
+                // (c_2 x) x + c_1 x + c_0
+                y = cc->EvalMult(cc->EvalMult(c, coefficients[2]), c);
+                y = cc->EvalAdd(y, cc->EvalMult(c, coefficients[1]));
+                y = cc->EvalAdd(y, coefficients[0]);
                 break;
-            case LEAST_SQUARES:
-                s = this->TanhLeastSquares(x);
+            default:
+                // (c_3 x) x^2 + c_1 x
+                y = cc->EvalMult(cc->EvalMult(c, coefficients[3]), cc->EvalSquare(c));
+                y = cc->EvalAdd(y, cc->EvalMult(c, coefficients[1]));
                 break;
         }
+        y = this->SafeRescaling(y);
+
+        return this->Wrap(y, b.GetAdditionsExecuted());
+    }
+
+    BootstrapableCiphertext Calculus::PolynomialDerivative(const BootstrapableCiphertext &x,
+                                                           const ActivationFn activation,
+                                                           const std::vector<double> &coefficients) const {
+        TRACE_SCOPE("PolynomialDerivative");
+        // c_1 + 2 c_2 x, or c_1 + 3 c_3 x^2
+        const auto odd = activation == ODD_POLY;
+        const auto derivative = odd
+                                    ? std::vector{coefficients[1], 0.0, 3.0 * coefficients[3]}
+                                    : std::vector{coefficients[1], 2.0 * coefficients[2]};
+        const auto depth = odd ? 2u : 1u;
+        const auto b = this->EvalBootstrap(x, static_cast<int32_t>(depth));
+
+        if (this->GetCtx().IsSimulated()) {
+            return this->SimulatePolynomial(b, PowerSeries(derivative), odd ? 1 : 0, depth);
+        }
+
+        const auto &cc = this->GetCc();
+        const auto &c = b.GetCiphertext();
+        auto y = odd ? cc->EvalMult(cc->EvalMult(c, derivative[2]), c) : cc->EvalMult(c, derivative[1]);
+        y = cc->EvalAdd(y, derivative[0]);
+        y = this->SafeRescaling(y);
 
-        const auto tanh_squared = this->EvalMult(s, s);
-        const auto d = this->EvalSub(this->constants.One(), tanh_squared);
-        return d;
+        return this->Wrap(y, b.GetAdditionsExecuted());
     }
 
     std::vector<std::vector<double> > Calculus::Transpose(const std::vector<std::vector<double> > &mat) {
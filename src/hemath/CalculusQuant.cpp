@@ -1,53 +1,57 @@
 #include "hemath.h"
 
 namespace hermesml {
+    static_assert(TAYLOR_SQRT_PRECISION >= 1 && TAYLOR_SQRT_PRECISION <= 3,
+                  "TAYLOR_SQRT_PRECISION must be between 1 and 3");
 
-    CalculusQuant::CalculusQuant( HEContext ctx) : EncryptedObject(ctx), constants(Constants(ctx)) {}
+    CalculusQuant::CalculusQuant(const HEContext &ctx) : EncryptedObject(ctx) {
+    }
 
-    Ciphertext<DCRTPoly> CalculusQuant::TaylorSqrt( Ciphertext<DCRTPoly> x) {
+    Plaintext CalculusQuant::Constant(const double value) const {
+        // Constants are multiplied in as plaintexts, replicated over every feature slot
+        const auto quantized = static_cast<int64_t>(std::llround(value));
+        return this->GetCc()->MakePackedPlaintext(std::vector(this->GetCtx().GetNumSlots(), quantized));
+    }
 
-        Plaintext plaintext;
-        Ciphertext<DCRTPoly> ciphertext;
+    double CalculusQuant::TaylorSqrtScale() {
+        return std::pow(QUANTIZE_SCALE_FACTOR, TAYLOR_SQRT_PRECISION + 1);
+    }
 
+    BootstrapableCiphertext CalculusQuant::TaylorSqrt(const BootstrapableCiphertext &x) const {
         // Taylor Series approximation for sqrt(1 + x)
         // sqrt(1 + x) ≈ 1 + x/2 - x^2/8 + x^3/16 - ...
-
-        plaintext = this->GetCc()->MakePackedPlaintext({static_cast<int64_t>(0.5 * QUANTIZE_SCALE_FACTOR)});
-        ciphertext = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), plaintext);
-
-        auto term = this->GetCc()->EvalMult(x,  ciphertext);                // First term: x/2
-        auto result = this->GetCc()->EvalAdd(this->constants.One(), term);  // result += 1 + x/2
-
-        if expr (TAYLOR_SQRT_PRECISION > 1) {
-            plaintext = this->GetCc()->MakePackedPlaintext({static_cast<int64_t>( (-1.0 / 8.0) * QUANTIZE_SCALE_FACTOR )});
-            ciphertext = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), plaintext);
-
-             auto x2 = this->GetCc()->EvalMult(x, x);  // x^2
-            term = this->GetCc()->EvalMult(x2, ciphertext);             // - x^2 / 8
-            result = this->GetCc()->EvalAdd(result, term);              // result += -x^2 / 8
-
-            if expr (TAYLOR_SQRT_PRECISION > 2) {
-                plaintext = this->GetCc()->MakePackedPlaintext({static_cast<int64_t>( (1.0 / 16.0) * QUANTIZE_SCALE_FACTOR )});
-                ciphertext = this->GetCc()->Encrypt(this->GetCtx().GetPublicKey(), plaintext);
-
-                 auto x3 = this->GetCc()->EvalMult(x2, x);  // x^3
-                term = this->GetCc()->EvalMult(x3, ciphertext);             // x^3 / 16
-                result = this->GetCc()->EvalAdd(result, term);              // result += x^3 / 16
+        //
+        // x^k carries QUANTIZE_SCALE_FACTOR^k, so each coefficient is scaled by the power that brings its term to
+        // the common TaylorSqrtScale()
+
+        const auto &cc = this->GetCc();
+        const auto &eX = x.GetCiphertext();
+        constexpr auto precision = TAYLOR_SQRT_PRECISION;
+
+        auto term = cc->EvalMult(eX, this->Constant(0.5 * std::pow(QUANTIZE_SCALE_FACTOR, precision))); // x/2
+        auto result = cc->EvalAdd(term, this->Constant(TaylorSqrtScale())); // result = 1 + x/2
+
+        if constexpr (precision > 1) {
+            const auto x2 = cc->EvalMult(eX, eX); // x^2
+            term = cc->EvalMult(x2, this->Constant(-std::pow(QUANTIZE_SCALE_FACTOR, precision - 1) / 8.0));
+            cc->EvalAddInPlace(result, term); // result += -x^2 / 8
+
+            if constexpr (precision > 2) {
+                const auto x3 = cc->EvalMult(x2, eX); // x^3
+                term = cc->EvalMult(x3, this->Constant(std::pow(QUANTIZE_SCALE_FACTOR, precision - 2) / 16.0));
+                cc->EvalAddInPlace(result, term); // result += x^3 / 16
             }
-
-            // You can continue adding more terms for higher accuracy ...
         }
 
-        return result;
+        return this->Wrap(std::move(result));
     }
 
-    Ciphertext<DCRTPoly> CalculusQuant::Euclidean( Ciphertext<DCRTPoly> point1,
-                                              Ciphertext<DCRTPoly> point2) {
+    BootstrapableCiphertext CalculusQuant::Euclidean(const BootstrapableCiphertext &point1,
+                                                     const BootstrapableCiphertext &point2) const {
+        const auto &cc = this->GetCc();
 
-        auto subb = this->GetCc()->EvalSub(point1, point2);
-        auto abss = this->GetCc()->EvalSquare(subb);
-        auto summ = this->GetCc()->EvalSum(abss, this->GetCtx().GetNumSlots());
-        auto sqrtt = this->TaylorSqrt(summ);
-        return summ;
+        const auto difference = cc->EvalSub(point1.GetCiphertext(), point2.GetCiphertext());
+        const auto squared = cc->EvalSquare(difference);
+        return this->Wrap(cc->EvalSum(squared, this->GetCtx().GetNumSlots()));
     }
-}
\ No newline at end of file
+}
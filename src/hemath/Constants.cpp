@@ -22,75 +22,75 @@ namespace hermesml {
         this->c0_0000011959 = this->EncryptCKKS(std::vector(ctx.GetNumFeatures(), 0.0000011959));
     }
 
-    BootstrapableCiphertext Constants::Zero() const {
+    const BootstrapableCiphertext &Constants::Zero() const {
         return this->zero;
     }
 
-    BootstrapableCiphertext Constants::One() const {
+    const BootstrapableCiphertext &Constants::One() const {
         return this->one;
     }
 
-    BootstrapableCiphertext Constants::Two() const {
+    const BootstrapableCiphertext &Constants::Two() const {
         return this->two;
     }
 
-    BootstrapableCiphertext Constants::C0_9580() const {
+    const BootstrapableCiphertext &Constants::C0_9580() const {
         return this->c0_9580;
     }
 
-    BootstrapableCiphertext Constants::C0_625() const {
+    const BootstrapableCiphertext &Constants::C0_625() const {
         return this->c0_625;
     }
 
-    BootstrapableCiphertext Constants::C0_5() const {
+    const BootstrapableCiphertext &Constants::C0_5() const {
         return this->c0_5;
     }
 
-    BootstrapableCiphertext Constants::C0_333333() const {
+    const BootstrapableCiphertext &Constants::C0_333333() const {
         return this->c0_333333;
     }
 
-    BootstrapableCiphertext Constants::C0_25() const {
+    const BootstrapableCiphertext &Constants::C0_25() const {
         return this->c0_25;
     }
 
-    BootstrapableCiphertext Constants::C0_21689() const {
+    const BootstrapableCiphertext &Constants::C0_21689() const {
         return this->c0_21689;
     }
 
-    BootstrapableCiphertext Constants::C0_2125() const {
+    const BootstrapableCiphertext &Constants::C0_2125() const {
         return this->c0_2125;
     }
 
-    BootstrapableCiphertext Constants::C0_125() const {
+    const BootstrapableCiphertext &Constants::C0_125() const {
         return this->c0_125;
     }
 
-    BootstrapableCiphertext Constants::C0_133333() const {
+    const BootstrapableCiphertext &Constants::C0_133333() const {
         return this->c0_133333;
     }
 
-    BootstrapableCiphertext Constants::C0_0240() const {
+    const BootstrapableCiphertext &Constants::C0_0240() const {
         return this->c0_0240;
     }
 
-    BootstrapableCiphertext Constants::C0_020833() const {
+    const BootstrapableCiphertext &Constants::C0_020833() const {
         return this->c0_020833;
     }
 
-    BootstrapableCiphertext Constants::C0_002083() const {
+    const BootstrapableCiphertext &Constants::C0_002083() const {
         return this->c0_002083;
     }
 
-    BootstrapableCiphertext Constants::C0_0081934() const {
+    const BootstrapableCiphertext &Constants::C0_0081934() const {
         return this->c0_0081934;
     }
 
-    BootstrapableCiphertext Constants::C0_00016588() const {
+    const BootstrapableCiphertext &Constants::C0_00016588() const {
         return this->c0_00016588;
     }
 
-    BootstrapableCiphertext Constants::C0_0000011959() const {
+    const BootstrapableCiphertext &Constants::C0_0000011959() const {
         return this->c0_0000011959;
     }
 }
@@ -1,3 +1,5 @@
+#include <iomanip>
+
 #include "model.h"
 
 namespace hermesml {
@@ -12,17 +14,38 @@ namespace hermesml {
         n_features(n_features),
         epochs(epochs),
         eWeights(this->constants.Zero()),
-        eBias(this->constants.Zero()) {
+        eBias(this->constants.Zero()),
+        optimizer(Optimizer(ctx)) {
+        if (Calculus::IsPolynomial(activation)) {
+            this->activationCoefficients = Calculus::DefaultCoefficients(activation);
+        }
     }
 
     BootstrapableCiphertext CkksLogisticRegression::GetLearningRate() const {
-        constexpr auto lr = 0.005;
-        return this->EncryptCKKS(std::vector(this->n_features, lr));
+        return this->EncryptCKKS(std::vector(this->n_features, this->optimizer.GetOptions().learningRate));
+    }
+
+    void CkksLogisticRegression::SetOptimizer(const OptimizerOptions &options) {
+        this->optimizer = Optimizer(this->GetCtx(), options);
+    }
+
+    const Optimizer &CkksLogisticRegression::GetOptimizer() const {
+        return this->optimizer;
+    }
+
+    void CkksLogisticRegression::Update(const BootstrapableCiphertext &eFeatures, const BootstrapableCiphertext &eError,
+                                        const double epoch) {
+        // The weights move by features * error and the bias by the error itself
+        this->optimizer.Step({&this->eWeights, &this->eBias}, {this->EvalMult(eFeatures, eError), eError},
+                             this->optimizer.GetLearningRate(epoch));
     }
 
     BootstrapableCiphertext CkksLogisticRegression::Activation(const BootstrapableCiphertext &x) const {
         switch (this->activation) {
             case SIGMOID: return this->calculus.Sigmoid(x, this->approximation);
+            case SQUARE:
+            case SCALED_SQUARE:
+            case ODD_POLY: return this->calculus.Polynomial(x, this->activation, this->activationCoefficients);
             default: return this->calculus.Tanh(x, this->approximation);
         }
     }
@@ -38,12 +61,10 @@ namespace hermesml {
         /**/
 
         std::vector<double> weights(this->n_features);
-        std::random_device rd;
-        std::mt19937 gen(rd());
         std::uniform_real_distribution<double> dist(-0.1, 0.1);
 
         for (double &w: weights) {
-            w = dist(gen);
+            w = dist(this->GetRng());
         }
 
         this->eWeights = this->EncryptCKKS(weights);
@@ -57,39 +78,42 @@ namespace hermesml {
                 std::to_string(y.size()) + ")");
         }
 
-        const auto eLr = this->GetLearningRate();
+        this->Fit(TrainingSet(this->GetCtx(), x, y));
+    }
+
+    void CkksLogisticRegression::Fit(const TrainingSet &samples) {
+        TRACE_SCOPE("Fit");
+        const Checkpointer checkpointer(this->GetCtx(), this->GetCheckpointOptions(), "logistic_regression");
 
-        // Initialize weights and bias
-        this->InitWeights();
-        this->eBias = this->constants.Zero();
+        // Initialize weights and bias, unless an earlier run left a checkpoint behind
+        TrainingCursor cursor;
+        if (!this->RestoreCheckpoint(checkpointer, cursor)) {
+            this->Initialize();
+        }
 
-        for (int32_t epoch = 0; epoch < this->epochs; epoch++) {
+        for (int32_t epoch = cursor.epoch; epoch < this->epochs; epoch++) {
             // Compute encrypted gradients using plain 'y' values
-            for (size_t i = 0; i < x.size(); i++) {
-                const auto &eFeatures = x[i];
+            for (size_t i = epoch == cursor.epoch ? cursor.sample : 0; i < samples.GetSize(); i++) {
+                TRACE_SCOPE("Sample");
+                const auto eFeatures = samples.GetFeatures(i);
+                const auto eLabel = samples.GetLabel(i);
 
                 // Execute the activation function
                 const auto eActivation = this->Predict(eFeatures);
 
                 // Compute the error
-                const auto eError = this->EvalSub(y[i], eActivation);
-
-                // Compute the delta
-                auto eDelta = this->EvalMult(eError, eLr);
-
-                // Update the weights
-                auto eNewWeights = this->EvalMult(eFeatures, eDelta);
-                this->eWeights = this->EvalAdd(this->eWeights, eNewWeights);
+                const auto eError = this->EvalSub(eLabel, eActivation);
 
-                // Update the bias
-                this->eBias = this->EvalAdd(this->eBias, eDelta);
+                // Update the weights and the bias, at the rate scheduled for this point of the epoch
+                const auto progress = static_cast<double>(i) / static_cast<double>(samples.GetSize());
+                this->Update(eFeatures, eError, epoch + progress);
 
                 /* Use only for debugging purpose
                 std::cout << "Features: " << std::flush;
                 this->Snoop(eFeatures, this->n_features);
 
                 std::cout << "Label: " << std::flush;
-                this->Snoop(y[i], this->n_features);
+                this->Snoop(eLabel, this->n_features);
 
                 std::cout << "eActivation: " << std::flush;
                 this->Snoop(eActivation, this->n_features);
@@ -97,12 +121,6 @@ namespace hermesml {
                 std::cout << "Error: " << std::flush;
                 this->Snoop(eError, this->n_features);
 
-                std::cout << "eDelta: " << std::flush;
-                this->Snoop(eDelta, this->n_features);
-
-                std::cout << "eNewWeights: " << std::flush;
-                this->Snoop(eNewWeights, this->n_features);
-
                 std::cout << "this->eWeights: " << std::flush;
                 this->Snoop(this->eWeights, this->n_features);
 
@@ -113,30 +131,44 @@ namespace hermesml {
                 // std::cout << "Press any key to continue: ";
                 // std::cin >> key;
                 /* */
+
+                const TrainingCursor reached{static_cast<uint16_t>(epoch), i + 1};
+                if (checkpointer.IsDue(reached, samples.GetSize())) {
+                    this->StoreCheckpoint(checkpointer, reached);
+                }
+                this->ReportProgress(reached, samples.GetSize(), this->epochs);
             }
         }
     }
 
     void CkksLogisticRegression::Fit(const std::string &eTrainingFeaturesFilePath,
                                      const std::string &eTrainingLabelsFilePath) {
-        const auto eLr = this->GetLearningRate();
+        const Checkpointer checkpointer(this->GetCtx(), this->GetCheckpointOptions(), "logistic_regression");
 
-        // Initialize weights and bias
-        this->InitWeights();
-        this->eBias = this->constants.Zero();
+        // Initialize weights and bias, unless an earlier run left a checkpoint behind
+        TrainingCursor cursor;
+        if (!this->RestoreCheckpoint(checkpointer, cursor)) {
+            this->Initialize();
+        }
 
-        for (int32_t epoch = 0; epoch < this->epochs; epoch++) {
+        for (int32_t epoch = cursor.epoch; epoch < this->epochs; epoch++) {
             std::ifstream eFeaturesStream(eTrainingFeaturesFilePath, std::ios::binary);
             std::ifstream eLabelsStream(eTrainingLabelsFilePath, std::ios::binary);
 
-            while (eFeaturesStream.peek() != EOF) {
+            for (size_t i = 0; eFeaturesStream.peek() != EOF; i++) {
                 Ciphertext<DCRTPoly> cipherFeatures;
                 Serial::Deserialize(cipherFeatures, eFeaturesStream, SerType::BINARY);
-                const auto eFeatures = BootstrapableCiphertext(cipherFeatures, this->GetCtx().GetMultiplicativeDepth());
 
                 Ciphertext<DCRTPoly> cipherLabels;
                 Serial::Deserialize(cipherLabels, eLabelsStream, SerType::BINARY);
-                const auto eLabels = BootstrapableCiphertext(cipherLabels, this->GetCtx().GetMultiplicativeDepth());
+
+                // Samples already trained on before the checkpoint
+                if (epoch == cursor.epoch && i < cursor.sample) {
+                    continue;
+                }
+
+                const auto eFeatures = this->Wrap(cipherFeatures);
+                const auto eLabels = this->Wrap(cipherLabels);
 
                 // Execute the activation function
                 const auto eActivation = this->Predict(eFeatures);
@@ -144,15 +176,8 @@ namespace hermesml {
                 // Compute the error
                 const auto eError = this->EvalSub(eLabels, eActivation);
 
-                // Compute the delta
-                auto eDelta = this->EvalMult(eError, eLr);
-
-                // Update the weights
-                auto eNewWeights = this->EvalMult(eFeatures, eDelta);
-                this->eWeights = this->EvalAdd(this->eWeights, eNewWeights);
-
-                // Update the bias
-                this->eBias = this->EvalAdd(this->eBias, eDelta);
+                // Update the weights and the bias. The stream length is unknown, so the rate follows whole epochs
+                this->Update(eFeatures, eError, epoch);
 
                 /* Use only for debugging purpose
                 std::cout << "label: " << std::flush;
@@ -164,12 +189,6 @@ namespace hermesml {
                 std::cout << "Error: " << std::flush;
                 this->Snoop(eError, this->n_features);
 
-                std::cout << "eDelta: " << std::flush;
-                this->Snoop(eDelta, this->n_features);
-
-                std::cout << "eNewWeights: " << std::flush;
-                this->Snoop(eNewWeights, this->n_features);
-
                 std::cout << "this->eWeights: " << std::flush;
                 this->Snoop(this->eWeights, this->n_features);
 
@@ -180,6 +199,13 @@ namespace hermesml {
                 std::cout << "Press any key to continue: ";
                 std::cin >> key;
                 /* */
+
+                // The stream length is unknown up front, but the epoch ends where the stream does
+                const auto samplesPerEpoch = eFeaturesStream.peek() == EOF ? i + 1 : 0;
+                if (const TrainingCursor reached{static_cast<uint16_t>(epoch), i + 1};
+                    checkpointer.IsDue(reached, samplesPerEpoch)) {
+                    this->StoreCheckpoint(checkpointer, reached);
+                }
             }
 
             eFeaturesStream.close();
@@ -187,7 +213,84 @@ namespace hermesml {
         }
     }
 
+    bool CkksLogisticRegression::RestoreCheckpoint(const Checkpointer &checkpointer, TrainingCursor &cursor) {
+        std::vector<BootstrapableCiphertext> parameters;
+        std::vector<double> coefficients;
+        if (!checkpointer.Load(cursor, this->GetRng(), parameters, coefficients)) {
+            return false;
+        }
+
+        // Checkpoints of the approximated activations carry no coefficients
+        if (!coefficients.empty()) {
+            this->SetActivationCoefficients(coefficients);
+        }
+
+        // Weights and bias, followed by their velocities once a momentum optimizer has taken a step
+        if (parameters.size() != 2 && parameters.size() != 4) {
+            throw std::runtime_error("Expected weights and bias in the checkpoint, found " +
+                                     std::to_string(parameters.size()) + " ciphertexts");
+        }
+
+        this->eWeights = std::move(parameters[0]);
+        this->eBias = std::move(parameters[1]);
+        this->optimizer.SetVelocities(std::vector(std::make_move_iterator(parameters.begin() + 2),
+                                                  std::make_move_iterator(parameters.end())));
+        return true;
+    }
+
+    void CkksLogisticRegression::StoreCheckpoint(const Checkpointer &checkpointer, const TrainingCursor &cursor) {
+        std::vector parameters{this->eWeights, this->eBias};
+        const auto &eVelocities = this->optimizer.GetVelocities();
+        parameters.insert(parameters.end(), eVelocities.begin(), eVelocities.end());
+        checkpointer.Save(cursor, this->GetRng(), parameters, this->activationCoefficients);
+    }
+
+    void CkksLogisticRegression::Initialize() {
+        this->InitWeights();
+        this->eBias = this->constants.Zero();
+        this->optimizer.Reset();
+    }
+
+    Gradients CkksLogisticRegression::ComputeGradients(const std::vector<BootstrapableCiphertext> &x,
+                                                       const std::vector<BootstrapableCiphertext> &y,
+                                                       const size_t begin, const size_t end) {
+        if (x.size() != y.size() || begin > end || end > x.size()) {
+            throw std::invalid_argument(
+                "Invalid gradient range [" + std::to_string(begin) + ", " + std::to_string(end) + ") over " +
+                std::to_string(x.size()) + " samples and " + std::to_string(y.size()) + " labels");
+        }
+
+        Gradients gradients{this->constants.Zero(), this->constants.Zero()};
+
+        if (begin == end) {
+            return gradients;
+        }
+
+        std::vector<BootstrapableCiphertext> eErrors;
+        eErrors.reserve(end - begin);
+
+        for (size_t i = begin; i < end; i++) {
+            const auto eActivation = this->Predict(x[i]);
+            eErrors.emplace_back(this->EvalSub(y[i], eActivation));
+
+            this->EvalAddInPlace(gradients.eBias, eErrors.back());
+        }
+
+        // Every error is taken against the same weights, so the weight direction is one inner product
+        const std::vector eSamples(x.begin() + static_cast<std::ptrdiff_t>(begin),
+                                   x.begin() + static_cast<std::ptrdiff_t>(end));
+        gradients.eWeights = this->EvalInnerProduct(eSamples, eErrors);
+
+        return gradients;
+    }
+
+    void CkksLogisticRegression::ApplyGradients(const Gradients &gradients, const double epoch) {
+        this->optimizer.Step({&this->eWeights, &this->eBias}, {gradients.eWeights, gradients.eBias},
+                             this->optimizer.GetLearningRate(epoch));
+    }
+
     BootstrapableCiphertext CkksLogisticRegression::Predict(const BootstrapableCiphertext &x) {
+        TRACE_SCOPE("Predict");
         const auto linearDot = this->EvalMult(this->eWeights, x);
         const auto sumLinearDot = this->EvalSum(linearDot);
         const auto sumLinearDotBias = this->EvalAdd(sumLinearDot, this->eBias);
@@ -216,6 +319,7 @@ namespace hermesml {
 
     std::vector<BootstrapableCiphertext> CkksLogisticRegression::PredictAll(
         const std::vector<BootstrapableCiphertext> &x) {
+        TRACE_SCOPE("PredictAll");
         std::vector<BootstrapableCiphertext> predictions(x.size());
 
         for (size_t i = 0; i < x.size(); ++i) {
@@ -235,11 +339,110 @@ namespace hermesml {
             Ciphertext<DCRTPoly> eFeatures;
             Serial::Deserialize(eFeatures, eFeaturesStream, SerType::BINARY);
             predictions.emplace_back(
-                this->Predict(BootstrapableCiphertext(eFeatures, this->GetCtx().GetMultiplicativeDepth())));
+                this->Predict(this->Wrap(eFeatures)));
         }
 
         eFeaturesStream.close();
 
         return predictions;
     }
+
+    BootstrapableCiphertext CkksLogisticRegression::PredictBatch(const BootstrapableCiphertext &xPacked) const {
+        TRACE_SCOPE("PredictBatch");
+        // The weights are encoded with numSlots slots, so they repeat over every sample block of the packed input
+        const auto linearDot = this->EvalMult(xPacked, this->eWeights);
+        const auto sumLinearDot = this->EvalSegmentSum(linearDot, this->GetCtx().GetNumSlots());
+        return this->Activation(this->EvalAdd(sumLinearDot, this->eBias));
+    }
+
+    std::vector<BootstrapableCiphertext> CkksLogisticRegression::PredictAllPacked(
+        const std::vector<BootstrapableCiphertext> &xPacked) const {
+        TRACE_SCOPE("PredictAllPacked");
+        std::vector<BootstrapableCiphertext> predictions;
+        predictions.reserve(xPacked.size());
+
+        for (const auto &batch: xPacked) {
+            predictions.emplace_back(this->PredictBatch(batch));
+        }
+
+        return predictions;
+    }
+
+    void CkksLogisticRegression::Save(const std::string &filePath) const {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+            throw std::runtime_error("Failed to open file for serialization: " + filePath);
+
+        out << this->n_features << " " << this->activation << " " << this->approximation;
+        for (const auto coefficient: this->activationCoefficients) {
+            out << " " << std::setprecision(17) << coefficient;
+        }
+        out << "\n";
+        this->WriteCiphertext(out, this->eWeights);
+        this->WriteCiphertext(out, this->eBias);
+
+        out.close();
+    }
+
+    CkksLogisticRegression CkksLogisticRegression::Load(const HEContext &ctx, const std::string &filePath) {
+        std::ifstream in(filePath, std::ios::binary);
+
+        if (!in.is_open())
+            throw std::runtime_error("Failed to open file for deserialization: " + filePath);
+
+        uint16_t n_features;
+        int activation, approximation;
+        in >> n_features >> activation >> approximation;
+
+        // Polynomial activations carry their coefficients on the same line
+        std::vector<double> coefficients;
+        if (Calculus::IsPolynomial(static_cast<ActivationFn>(activation))) {
+            coefficients.resize(Calculus::DefaultCoefficients(static_cast<ActivationFn>(activation)).size());
+            for (auto &coefficient: coefficients) {
+                in >> coefficient;
+            }
+        }
+        in.get();
+
+        auto model = CkksLogisticRegression(ctx, n_features, 0, 42, static_cast<ActivationFn>(activation),
+                                            static_cast<ApproximationFn>(approximation));
+        if (!coefficients.empty()) {
+            model.SetActivationCoefficients(coefficients);
+        }
+
+        model.eWeights = model.ReadCiphertext(in);
+        model.eBias = model.ReadCiphertext(in);
+
+        in.close();
+
+        return model;
+    }
+
+    const BootstrapableCiphertext &CkksLogisticRegression::GetWeights() const {
+        return this->eWeights;
+    }
+
+    const BootstrapableCiphertext &CkksLogisticRegression::GetBias() const {
+        return this->eBias;
+    }
+
+    void CkksLogisticRegression::SetActivationCoefficients(const std::vector<double> &coefficients) {
+        Calculus::CheckCoefficients(this->activation, coefficients);
+        this->activationCoefficients = coefficients;
+    }
+
+    const std::vector<double> &CkksLogisticRegression::GetActivationCoefficients() const {
+        return this->activationCoefficients;
+    }
+
+    size_t CkksLogisticRegression::GetCiphertextBytes() const {
+        return this->eWeights.GetSizeInBytes() + this->eBias.GetSizeInBytes();
+    }
+
+    uint32_t CkksLogisticRegression::InferenceDepth(const HEContext &ctx, const ActivationFn activation,
+                                                    const ApproximationFn approximation) {
+        // The weights product, then the activation; sums and the bias cost no level
+        return 1 + Calculus::ActivationDepth(ctx, activation, approximation);
+    }
 }
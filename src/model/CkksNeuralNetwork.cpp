@@ -1,3 +1,4 @@
+#include "graph.h"
 #include "model.h"
 
 namespace hermesml {
@@ -12,6 +13,10 @@ namespace hermesml {
                                                                         layerSizes(sizes),
                                                                         n_features(n_features),
                                                                         epochs(epochs) {
+        if (Calculus::IsPolynomial(activation)) {
+            this->activationCoefficients = Calculus::DefaultCoefficients(activation);
+        }
+
         InitWeights();
     }
 
@@ -23,14 +28,23 @@ namespace hermesml {
     BootstrapableCiphertext CkksNeuralNetwork::Activation(const BootstrapableCiphertext &x) const {
         switch (this->activation) {
             case SIGMOID: return this->calculus.Sigmoid(x, this->approximation);
+            case SQUARE:
+            case SCALED_SQUARE:
+            case ODD_POLY: return this->calculus.Polynomial(x, this->activation, this->activationCoefficients);
             default: return this->calculus.Tanh(x, this->approximation);
         }
     }
 
     BootstrapableCiphertext CkksNeuralNetwork::ActivationDerivative(const BootstrapableCiphertext &x) const {
+        // Approximations are differentiated from the activation cached by the forward pass, so they are never
+        // evaluated twice. Polynomials are differentiated from the cached pre-activation, in fewer levels
         switch (this->activation) {
-            case SIGMOID: return this->calculus.SigmoidDerivative(x, this->approximation);
-            default: return this->calculus.TanhDerivative(x, this->approximation);
+            case SIGMOID: return this->calculus.SigmoidDerivativeFromActivation(x);
+            case SQUARE:
+            case SCALED_SQUARE:
+            case ODD_POLY:
+                return this->calculus.PolynomialDerivative(x, this->activation, this->activationCoefficients);
+            default: return this->calculus.TanhDerivativeFromActivation(x);
         }
     }
 
@@ -412,6 +426,56 @@ namespace hermesml {
         */
     }
 
+    bool CkksNeuralNetwork::RestoreCheckpoint(const Checkpointer &checkpointer, TrainingCursor &cursor) {
+        std::vector<BootstrapableCiphertext> parameters;
+        std::vector<double> coefficients;
+        if (!checkpointer.Load(cursor, this->GetRng(), parameters, coefficients)) {
+            return false;
+        }
+
+        // Checkpoints of the approximated activations carry no coefficients
+        if (!coefficients.empty()) {
+            this->SetActivationCoefficients(coefficients);
+        }
+
+        // Weights then biases, layer by layer, in the order StoreCheckpoint flattened them
+        size_t expected = 0;
+        for (size_t k = 0; k < this->eWeights.size(); k++) {
+            expected += this->eWeights[k].size() + this->eBias[k].size();
+        }
+
+        if (parameters.size() != expected) {
+            throw std::runtime_error("Checkpoint holds " + std::to_string(parameters.size()) +
+                                     " ciphertexts, but the network has " + std::to_string(expected) + " parameters");
+        }
+
+        auto parameter = parameters.begin();
+        for (auto &eLayerWeights: this->eWeights) {
+            for (auto &eUnitWeights: eLayerWeights) {
+                eUnitWeights = std::move(*parameter++);
+            }
+        }
+        for (auto &eLayerBias: this->eBias) {
+            for (auto &eUnitBias: eLayerBias) {
+                eUnitBias = std::move(*parameter++);
+            }
+        }
+
+        return true;
+    }
+
+    void CkksNeuralNetwork::StoreCheckpoint(const Checkpointer &checkpointer, const TrainingCursor &cursor) {
+        std::vector<BootstrapableCiphertext> parameters;
+        for (const auto &eLayerWeights: this->eWeights) {
+            parameters.insert(parameters.end(), eLayerWeights.begin(), eLayerWeights.end());
+        }
+        for (const auto &eLayerBias: this->eBias) {
+            parameters.insert(parameters.end(), eLayerBias.begin(), eLayerBias.end());
+        }
+
+        checkpointer.Save(cursor, this->GetRng(), parameters, this->activationCoefficients);
+    }
+
     void CkksNeuralNetwork::Fit(const std::vector<BootstrapableCiphertext> &x,
                                 const std::vector<BootstrapableCiphertext> &y) {
         if (x.size() != y.size()) {
@@ -420,113 +484,135 @@ namespace hermesml {
                 std::to_string(y.size()) + ")");
         }
 
+        this->Fit(TrainingSet(this->GetCtx(), x, y));
+    }
+
+    void CkksNeuralNetwork::Fit(const TrainingSet &samples) {
+        TRACE_SCOPE("Fit");
         const auto eLearningRate = this->GetLearningRate();
+        const Checkpointer checkpointer(this->GetCtx(), this->GetCheckpointOptions(), "neural_network");
 
-        for (int epoch = 0; epoch < this->epochs; epoch++) {
-            for (size_t i = 0; i < x.size(); i++) {
-                const auto &eInput = x[i];
-                const auto &eTrue = y[i];
+        // The constructor already set the initial weights, so only a checkpoint replaces them
+        TrainingCursor cursor;
+        this->RestoreCheckpoint(checkpointer, cursor);
+
+        for (int epoch = cursor.epoch; epoch < this->epochs; epoch++) {
+            for (size_t i = epoch == cursor.epoch ? cursor.sample : 0; i < samples.GetSize(); i++) {
+                TRACE_SCOPE("Sample");
+                const auto eInput = samples.GetFeatures(i);
+                const auto eTrue = samples.GetLabel(i);
 
                 // Forward --------------------------------------------------------------------------------------------
-                const auto ePred = this->Predict(eInput);
+                const auto ePred = this->Predict(eInput, &this->trainingWorkspace);
+                const auto &eActivations = this->trainingWorkspace.eActivations;
+                const auto &eDerivativeInputs = Calculus::IsPolynomial(this->activation)
+                                                    ? this->trainingWorkspace.ePreActivations
+                                                    : eActivations;
                 // -------------------------------------------------------------------------------------------- Forward
 
                 // Backward -------------------------------------------------------------------------------------------
-                std::vector<std::vector<BootstrapableCiphertext> > eScaledGradWeights;
-                std::vector<std::vector<BootstrapableCiphertext> > eScaledGradBias;
-                std::vector<std::vector<BootstrapableCiphertext> > eLosses;
-                std::vector<std::vector<BootstrapableCiphertext> > eDeltaLs;
+                // Recorded first and run once, so the neurons of a layer are differentiated concurrently
+                TRACE_SCOPE("Backward");
+                ComputationGraph graph(this->GetCtx());
+                const auto derivative = [this](const auto &a) { return this->ActivationDerivative(a); };
+                const auto gLearningRate = graph.Input(eLearningRate);
+                const auto gPred = graph.Input(ePred);
 
-                auto ePreAct = this->ePreActivations.back();
-                auto eZL = this->ActivationDerivative(ePreAct);
-                auto eLoss = this->EvalFlatten(this->EvalSub(ePred, eTrue)); // Only 1 Neuron supported
-                auto eDeltaL = this->EvalFlatten(this->EvalMult(eLoss, eZL)); // Only 1 Neuron supported
+                std::vector<std::vector<NodeId> > gScaledGradWeights;
+                std::vector<std::vector<NodeId> > gScaledGradBias;
+                std::vector<std::vector<NodeId> > gDeltaLs;
 
-                eLosses.emplace_back(std::vector({eLoss}));
-                eDeltaLs.emplace_back(std::vector({eDeltaL}));
+                const auto gZL = graph.Apply(graph.Input(eDerivativeInputs.back()), derivative);
+                const auto gLoss = graph.Flatten(graph.Sub(gPred, graph.Input(eTrue))); // Only 1 Neuron supported
+                auto gDeltaL = graph.Flatten(graph.Mult(gLoss, gZL)); // Only 1 Neuron supported
 
-                // Update the weights of the last layer ---------------------------------------------------------------
-                ePreAct = this->eActivations[this->eActivations.size() - 2];
-                auto eGradWK = this->EvalMult(eDeltaL, ePreAct);
-                auto eScaledGradWK = this->EvalMult(eGradWK, eLearningRate);
-                eScaledGradWeights.emplace_back(std::vector({eScaledGradWK}));
+                gDeltaLs.emplace_back(std::vector({gDeltaL}));
 
-                auto eScaledGradBiasK = this->EvalMult(eDeltaL, eLearningRate);
-                eScaledGradBias.emplace_back(std::vector({eScaledGradBiasK}));
+                // Update the weights of the last layer ---------------------------------------------------------------
+                auto gPreAct = graph.Input(eActivations[eActivations.size() - 2]);
+                gScaledGradWeights.emplace_back(
+                    std::vector({graph.Mult(graph.Mult(gDeltaL, gPreAct), gLearningRate)}));
+                gScaledGradBias.emplace_back(std::vector({graph.Mult(gDeltaL, gLearningRate)}));
 
                 // Update the weights of the remaining layers ---------------------------------------------------------
                 for (auto k = static_cast<int32_t>(this->eWeights.size() - 2); k >= 0; k--) {
-                    const auto &eLayerWeights = this->eWeights[k + 1];
-                    const auto &ePreDeltaL = eDeltaLs.back();
-
-                    auto eLocalLoss = this->constants.Zero();
-                    for (auto l = 0; l < eLayerWeights.size(); l++) {
-                        // ePreDeltaL[1] * eLayerWeights[1] + ePreDeltaL[2] * eLayerWeights[2] ... ePreDeltaL[l] * eLayerWeights[l]
-                        const auto z = this->EvalMult(eLayerWeights[l], ePreDeltaL[l]);
-                        eLocalLoss = this->EvalAdd(eLocalLoss, z);
-
-                        /* Use only for debugging purpose
-                        this->Snoop(eLayerWeights[l]);
-                        this->Snoop(ePreDeltaL[l]);
-                        this->Snoop(z);
-                        /* */
+                    std::vector<NodeId> gLayerWeights;
+                    for (const auto &eUnitWeights: this->eWeights[k + 1]) {
+                        gLayerWeights.emplace_back(graph.Input(eUnitWeights));
                     }
 
-                    auto eAct = this->eActivations[k];
-                    auto eLocalZl = this->EvalSub(this->constants.One(), this->EvalMult(eAct, eAct));
+                    // ePreDeltaL[1] * eLayerWeights[1] + ePreDeltaL[2] * eLayerWeights[2] ... ePreDeltaL[l] * eLayerWeights[l]
+                    const auto gLocalLoss = graph.InnerProduct(gLayerWeights, gDeltaLs.back());
+                    const auto gLocalZl = graph.Apply(graph.Input(eDerivativeInputs[k]), derivative);
 
-                    std::vector<BootstrapableCiphertext> eLocalScaledGradWeights;
-                    std::vector<BootstrapableCiphertext> eLocalScaledGradBias;
-                    std::vector<BootstrapableCiphertext> eLocalLosses;
-                    std::vector<BootstrapableCiphertext> eLocalDeltaLs;
+                    // Slot n holds the delta of neuron n, which is rotated into the first slot and replicated
+                    const auto gLocalDeltas = graph.Mult(gLocalLoss, gLocalZl);
 
-                    if (k > 0) {
-                        ePreAct = this->eActivations[k - 1];
-                    } else {
-                        ePreAct = eInput;
-                    }
+                    std::vector<NodeId> gLocalScaledGradWeights;
+                    std::vector<NodeId> gLocalScaledGradBias;
+                    std::vector<NodeId> gLocalDeltaLs;
+
+                    gPreAct = graph.Input(k > 0 ? eActivations[k - 1] : eInput);
 
                     for (auto n = 0; n < this->eWeights[k].size(); n++) {
-                        auto eLocalLoss2 = eLocalLoss;
-                        if (n > 0) {
-                            eLocalLoss2 = this->EvalRotate(eLocalLoss2, 1);
-                        }
-                        eLocalLoss2 = this->EvalFlatten(eLocalLoss2);
-
-                        auto eLocalZl2 = eLocalZl;
-                        if (n > 0) {
-                            eLocalZl2 = this->EvalRotate(eLocalZl2, 1);
-                        }
-                        eLocalZl2 = this->EvalFlatten(eLocalZl2);
-
-                        eDeltaL = this->EvalMult(eLocalLoss2, eLocalZl2);
-                        eDeltaL = this->EvalFlatten(eDeltaL);
-                        eLocalDeltaLs.emplace_back(eDeltaL);
-
-                        eGradWK = this->EvalMult(eDeltaL, ePreAct);
-                        eScaledGradWK = this->EvalMult(eGradWK, eLearningRate);
-                        eLocalScaledGradWeights.emplace_back(eScaledGradWK);
-
-                        eScaledGradBiasK = this->EvalMult(eDeltaL, eLearningRate);
-                        eLocalScaledGradBias.emplace_back(eScaledGradBiasK);
-
-                        /*
-                        std::cout << "===========================================" << std::endl;
-                        this->Snoop(eAct);
-                        this->Snoop(eLoss);
-                        this->Snoop(eZL);
-                        this->Snoop(ePreAct);
-                        this->Snoop(eGradWK);
-                        this->Snoop(eScaledGradWK);
-                        this->Snoop(eScaledGradBiasK);
-                        /* */
+                        gDeltaL = graph.Flatten(n > 0 ? graph.Rotate(gLocalDeltas, n) : gLocalDeltas);
+
+                        gLocalScaledGradWeights.emplace_back(
+                            graph.Mult(graph.Mult(gDeltaL, gPreAct), gLearningRate));
+                        gLocalScaledGradBias.emplace_back(graph.Mult(gDeltaL, gLearningRate));
+                        gLocalDeltaLs.emplace_back(gDeltaL);
                     }
 
-                    eScaledGradWeights.emplace_back(eLocalScaledGradWeights);
-                    eScaledGradBias.emplace_back(eLocalScaledGradBias);
-                    eDeltaLs.emplace_back(eLocalDeltaLs);
+                    gScaledGradWeights.emplace_back(std::move(gLocalScaledGradWeights));
+                    gScaledGradBias.emplace_back(std::move(gLocalScaledGradBias));
+                    gDeltaLs.emplace_back(std::move(gLocalDeltaLs));
+                }
+
+                std::vector<NodeId> outputs;
+                for (const auto &gLayer: gScaledGradWeights) {
+                    outputs.insert(outputs.end(), gLayer.begin(), gLayer.end());
+                }
+                for (const auto &gLayer: gScaledGradBias) {
+                    outputs.insert(outputs.end(), gLayer.begin(), gLayer.end());
+                }
+
+                auto eGradients = GraphExecutor(this->graphWorkers).Run(graph, outputs);
+                auto eGradient = eGradients.begin();
+
+                std::vector<std::vector<BootstrapableCiphertext> > eScaledGradWeights;
+                std::vector<std::vector<BootstrapableCiphertext> > eScaledGradBias;
+                for (const auto &gLayer: gScaledGradWeights) {
+                    eScaledGradWeights.emplace_back(std::make_move_iterator(eGradient),
+                                                    std::make_move_iterator(eGradient + gLayer.size()));
+                    eGradient += gLayer.size();
+                }
+                for (const auto &gLayer: gScaledGradBias) {
+                    eScaledGradBias.emplace_back(std::make_move_iterator(eGradient),
+                                                 std::make_move_iterator(eGradient + gLayer.size()));
+                    eGradient += gLayer.size();
                 }
                 // ------------------------------------------------------------------------------------------- Backward
+
+                // Update ---------------------------------------------------------------------------------------------
+                // The gradients were recorded from the last layer back, and the graph already holds the weights it
+                // read, so the layers can be descended in place
+                const auto layers = this->eWeights.size();
+                for (size_t j = 0; j < eScaledGradWeights.size(); j++) {
+                    auto &eLayerWeights = this->eWeights[layers - 1 - j];
+                    auto &eLayerBias = this->eBias[layers - 1 - j];
+
+                    for (size_t n = 0; n < eScaledGradWeights[j].size(); n++) {
+                        this->EvalSubInPlace(eLayerWeights[n], eScaledGradWeights[j][n]);
+                        this->EvalSubInPlace(eLayerBias[n], eScaledGradBias[j][n]);
+                    }
+                }
+                // --------------------------------------------------------------------------------------------- Update
+
+                const TrainingCursor reached{static_cast<uint16_t>(epoch), i + 1};
+                if (checkpointer.IsDue(reached, samples.GetSize())) {
+                    this->StoreCheckpoint(checkpointer, reached);
+                }
+                this->ReportProgress(reached, samples.GetSize(), this->epochs);
             }
         }
     }
@@ -536,89 +622,195 @@ namespace hermesml {
     }
 
     BootstrapableCiphertext CkksNeuralNetwork::Predict(const BootstrapableCiphertext &x) {
-        BootstrapableCiphertext bLayerInput = x;
+        return this->Predict(x, nullptr);
+    }
 
-        this->ePreActivations.clear();
-        this->eActivations.clear();
+    BootstrapableCiphertext CkksNeuralNetwork::Predict(const BootstrapableCiphertext &x,
+                                                       ForwardWorkspace *workspace) const {
+        TRACE_SCOPE("Predict");
+        if (workspace) {
+            workspace->ePreActivations.clear();
+            workspace->eActivations.clear();
+        }
+
+        // Units of a layer only depend on the previous layer, so the executor may run them side by side
+        ComputationGraph graph(this->GetCtx());
+        auto gLayerInput = graph.Input(x);
+        std::vector<NodeId> gPreActivations;
+        std::vector<NodeId> gActivations;
 
         // Forward ----------------------------------------------------------------------------------------------------
         for (auto k = 0; k < this->eWeights.size(); k++) {
             const auto &eLayerUnits = this->eWeights[k];
             const auto &eLayerBiases = this->eBias[k];
 
-            std::vector<BootstrapableCiphertext> preActivationLayer;
-            std::vector<BootstrapableCiphertext> activationLayer;
+            std::vector<NodeId> preActivationLayer;
+            std::vector<NodeId> activationLayer;
 
             for (auto j = 0; j < eLayerUnits.size(); j++) {
-                const auto &eWeights = eLayerUnits[j];
-                const auto eBias = eLayerBiases[j];
-                const auto a = this->WeightedSum(eWeights, bLayerInput, eBias);
-                const auto z = this->Activation(a);
+                const auto a = graph.WeightedSum(graph.Input(eLayerUnits[j]), gLayerInput,
+                                                 graph.Input(eLayerBiases[j]));
+                activationLayer.emplace_back(graph.Apply(a, [this](const auto &z) { return this->Activation(z); }));
                 preActivationLayer.emplace_back(a);
-                activationLayer.emplace_back(z);
-
-                /* Use for debugging only
-                std::cout << "a = " << std::flush;
-                this->Snoop(a, n_features);
-                std::cout << "z = " << std::flush;
-                this->Snoop(z, n_features);
-                /* */
+
+                if constexpr (Tracer::IsEnabled()) {
+                    const auto neuron = "Layer " + std::to_string(k) + " neuron " + std::to_string(j);
+                    graph.Label(a, neuron);
+                    graph.Label(activationLayer.back(), neuron + " activation");
+                }
             }
 
-            this->ePreActivations.emplace_back(this->EvalMerge(preActivationLayer));
-            this->eActivations.emplace_back(this->EvalMerge(activationLayer));
-            bLayerInput = this->EvalMerge(activationLayer);
+            gLayerInput = graph.Merge(activationLayer);
+            gPreActivations.emplace_back(graph.Merge(preActivationLayer));
+            gActivations.emplace_back(gLayerInput);
         } // -------------------------------------------------------------------------------------------------- Forward
 
+        // Without a workspace the merged pre-activations are never requested, so they are never evaluated
+        std::vector outputs{gLayerInput};
+        if (workspace) {
+            outputs.insert(outputs.end(), gPreActivations.begin(), gPreActivations.end());
+            outputs.insert(outputs.end(), gActivations.begin(), gActivations.end());
+        }
+
+        auto results = GraphExecutor(this->graphWorkers).Run(graph, outputs);
+
+        if (workspace) {
+            const auto layers = this->eWeights.size();
+            workspace->ePreActivations.assign(results.begin() + 1, results.begin() + 1 + layers);
+            workspace->eActivations.assign(results.begin() + 1 + layers, results.end());
+        }
+
         /* Use for debugging only
         std::cout << "Pre-Activations" << std::endl;
-        for (auto z = 0; z < this->ePreActivations.size(); z++) {
+        for (auto z = 0; z < workspace->ePreActivations.size(); z++) {
             std::cout << "Layer " << z << std::endl;
-            this->Snoop(this->ePreActivations[z], n_features);
+            this->Snoop(workspace->ePreActivations[z], n_features);
         }
 
         std::cout << "Activations" << std::endl;
-        for (auto z = 0; z < this->eActivations.size(); z++) {
+        for (auto z = 0; z < workspace->eActivations.size(); z++) {
             std::cout << "Layer " << z << std::endl;
-            this->Snoop(this->eActivations[z], this->n_features);
+            this->Snoop(workspace->eActivations[z], this->n_features);
         }
         /* */
 
-        auto ePred = this->eActivations.back();
+        return results.front();
+    }
 
-        /* Use for debugging only */
-        // this->Snoop(ePred, n_features);
-        /* */
+    BootstrapableCiphertext CkksNeuralNetwork::PredictBatch(const BootstrapableCiphertext &xPacked) const {
+        TRACE_SCOPE("PredictBatch");
+        const auto segmentSize = this->GetCtx().GetNumSlots();
+        BootstrapableCiphertext bLayerInput = xPacked;
 
-        return ePred;
+        for (auto k = 0; k < this->eWeights.size(); k++) {
+            const auto &eLayerUnits = this->eWeights[k];
+            const auto &eLayerBiases = this->eBias[k];
+
+            std::vector<BootstrapableCiphertext> preActivationLayer;
+            preActivationLayer.reserve(eLayerUnits.size());
+
+            for (auto j = 0; j < eLayerUnits.size(); j++) {
+                auto a = this->EvalSegmentSum(this->EvalMult(bLayerInput, eLayerUnits[j]), segmentSize);
+                this->EvalAddInPlace(a, eLayerBiases[j]);
+                preActivationLayer.emplace_back(std::move(a));
+            }
+
+            // Units land in their own slot of each sample block, so the whole layer needs a single activation. The
+            // unused slots carry f(0), which the zero-padded weights of the next layer cancel out
+            bLayerInput = this->Activation(this->EvalMergePacked(preActivationLayer, segmentSize));
+        }
+
+        return bLayerInput;
     }
 
-    std::vector<BootstrapableCiphertext> CkksNeuralNetwork::PredictAll(
-        const std::vector<BootstrapableCiphertext> &x) {
+    std::vector<BootstrapableCiphertext> CkksNeuralNetwork::MapSamples(
+        const std::vector<BootstrapableCiphertext> &x, const uint32_t workers,
+        const std::function<BootstrapableCiphertext(const BootstrapableCiphertext &)> &fn) const {
         std::vector<BootstrapableCiphertext> predictions(x.size());
 
-        for (size_t i = 0; i < x.size(); ++i) {
-            predictions[i] = this->Predict(x[i]);
-        }
+        // Samples are independent, so each worker pulls the next index and writes to its own output slot
+        this->GetCtx().GetThreadingPolicy().ParallelFor(x.size(), workers, [&x, &fn, &predictions](const size_t i) {
+            predictions[i] = fn(x[i]);
+        });
 
         return predictions;
     }
 
+    std::vector<BootstrapableCiphertext> CkksNeuralNetwork::PredictAll(
+        const std::vector<BootstrapableCiphertext> &x, const uint32_t workers) const {
+        TRACE_SCOPE("PredictAll");
+        return this->MapSamples(x, workers, [this](const BootstrapableCiphertext &sample) {
+            return this->Predict(sample, nullptr);
+        });
+    }
+
+    std::vector<BootstrapableCiphertext> CkksNeuralNetwork::PredictAllPacked(
+        const std::vector<BootstrapableCiphertext> &xPacked, const uint32_t workers) const {
+        TRACE_SCOPE("PredictAllPacked");
+        return this->MapSamples(xPacked, workers, [this](const BootstrapableCiphertext &batch) {
+            return this->PredictBatch(batch);
+        });
+    }
+
     std::vector<BootstrapableCiphertext>
-    CkksNeuralNetwork::PredictAll(const std::string &eTestingFeaturesFilePath) {
+    CkksNeuralNetwork::PredictAll(const std::string &eTestingFeaturesFilePath, const uint32_t workers) const {
         std::vector<BootstrapableCiphertext> predictions{};
 
         std::ifstream eFeaturesStream(eTestingFeaturesFilePath, std::ios::binary);
 
+        // Read one chunk per worker at a time, so only a bounded number of inputs is resident in memory
+        const auto nWorkers = this->GetCtx().GetThreadingPolicy().ResolveWorkers(
+            workers, std::numeric_limits<size_t>::max());
+        std::vector<BootstrapableCiphertext> chunk;
+
         while (eFeaturesStream.peek() != EOF) {
             Ciphertext<DCRTPoly> eFeatures;
             Serial::Deserialize(eFeatures, eFeaturesStream, SerType::BINARY);
-            predictions.emplace_back(
-                this->Predict(BootstrapableCiphertext(eFeatures, this->GetCtx().GetMultiplicativeDepth())));
+            chunk.emplace_back(this->Wrap(eFeatures));
+
+            if (chunk.size() == nWorkers || eFeaturesStream.peek() == EOF) {
+                auto ePredictions = this->PredictAll(chunk, nWorkers);
+                predictions.insert(predictions.end(), ePredictions.begin(), ePredictions.end());
+                chunk.clear();
+            }
         }
 
         eFeaturesStream.close();
 
         return predictions;
     }
+
+    size_t CkksNeuralNetwork::GetCiphertextBytes() const {
+        return MemoryFootprint::CiphertextBytes(this->eWeights) + MemoryFootprint::CiphertextBytes(this->eBias) +
+               MemoryFootprint::CiphertextBytes(this->trainingWorkspace.ePreActivations) +
+               MemoryFootprint::CiphertextBytes(this->trainingWorkspace.eActivations);
+    }
+
+    void CkksNeuralNetwork::SetGraphWorkers(const uint32_t workers) {
+        this->graphWorkers = workers;
+    }
+
+    const std::vector<std::vector<BootstrapableCiphertext> > &CkksNeuralNetwork::GetWeights() const {
+        return this->eWeights;
+    }
+
+    const std::vector<std::vector<BootstrapableCiphertext> > &CkksNeuralNetwork::GetBias() const {
+        return this->eBias;
+    }
+
+    void CkksNeuralNetwork::SetActivationCoefficients(const std::vector<double> &coefficients) {
+        Calculus::CheckCoefficients(this->activation, coefficients);
+        this->activationCoefficients = coefficients;
+    }
+
+    const std::vector<double> &CkksNeuralNetwork::GetActivationCoefficients() const {
+        return this->activationCoefficients;
+    }
+
+    uint32_t CkksNeuralNetwork::InferenceDepth(const HEContext &ctx, const std::vector<size_t> &sizes,
+                                               const ActivationFn activation, const ApproximationFn approximation) {
+        // Every layer multiplies by its weights, activates, and merges its units into one ciphertext
+        const auto layers = static_cast<uint32_t>(sizes.size() - 1);
+        return layers * (2 + Calculus::ActivationDepth(ctx, activation, approximation));
+    }
 }
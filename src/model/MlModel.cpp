@@ -1,10 +1,32 @@
 #include "model.h"
 
 namespace hermesml {
-    MlModel::MlModel(const uint32_t seed) : seed(seed) {
+    MlModel::MlModel(const uint32_t seed) : seed(seed), rng(seed) {
     }
 
     uint32_t MlModel::GetSeed() const {
         return this->seed;
     }
+
+    void MlModel::SetCheckpointOptions(const CheckpointOptions &options) {
+        this->checkpointOptions = options;
+    }
+
+    const CheckpointOptions &MlModel::GetCheckpointOptions() const {
+        return this->checkpointOptions;
+    }
+
+    void MlModel::SetProgressCallback(ProgressCallback progressCallback) {
+        this->progressCallback = std::move(progressCallback);
+    }
+
+    void MlModel::ReportProgress(const TrainingCursor &reached, const size_t samples, const uint16_t epochs) const {
+        if (this->progressCallback) {
+            this->progressCallback(reached.epoch * samples + reached.sample, epochs * samples);
+        }
+    }
+
+    std::mt19937 &MlModel::GetRng() {
+        return this->rng;
+    }
 }
@@ -0,0 +1,96 @@
+#include "expressions.h"
+#include "model.h"
+
+namespace hermesml {
+    Optimizer::Optimizer(const HEContext &ctx, const OptimizerOptions &options) : EncryptedObject(ctx),
+        options(options) {
+        if (options.learningRate <= 0.0) {
+            throw std::invalid_argument("The learning rate must be positive, got " +
+                                        std::to_string(options.learningRate));
+        }
+        if (options.momentum < 0.0 || options.momentum >= 1.0) {
+            throw std::invalid_argument("The momentum must be in [0, 1), got " + std::to_string(options.momentum));
+        }
+        if (options.decayEpochs <= 0.0) {
+            throw std::invalid_argument("The decay period must be positive, got " +
+                                        std::to_string(options.decayEpochs));
+        }
+    }
+
+    const OptimizerOptions &Optimizer::GetOptions() const {
+        return this->options;
+    }
+
+    double Optimizer::GetLearningRate(const double epoch) const {
+        const auto periods = epoch / this->options.decayEpochs;
+
+        switch (this->options.schedule) {
+            case STEP_DECAY: return this->options.learningRate * std::pow(this->options.decayRate, std::floor(periods));
+            case EXPONENTIAL_DECAY: return this->options.learningRate * std::pow(this->options.decayRate, periods);
+            case INVERSE_TIME_DECAY: return this->options.learningRate / (1.0 + this->options.decayRate * periods);
+            default: return this->options.learningRate;
+        }
+    }
+
+    void Optimizer::Step(const std::vector<BootstrapableCiphertext *> &eParameters,
+                         const std::vector<BootstrapableCiphertext> &eDirections, const double rate) {
+        TRACE_SCOPE("OptimizerStep");
+        if (eParameters.size() != eDirections.size()) {
+            throw std::invalid_argument("Got " + std::to_string(eDirections.size()) + " directions for " +
+                                        std::to_string(eParameters.size()) + " parameters");
+        }
+
+        if (this->options.optimizer == SGD) {
+            for (size_t i = 0; i < eParameters.size(); i++) {
+                this->EvalAddInPlace(*eParameters[i], Evaluate(*this, rate * eDirections[i]));
+            }
+            return;
+        }
+
+        // Velocities start at rest, so the first step needs no term for them
+        const auto atRest = this->eVelocities.empty();
+        if (!atRest && this->eVelocities.size() != eParameters.size()) {
+            throw std::invalid_argument("The optimizer tracks " + std::to_string(this->eVelocities.size()) +
+                                        " velocities, got " + std::to_string(eParameters.size()) + " parameters");
+        }
+        if (atRest) {
+            this->eVelocities.resize(eParameters.size());
+        }
+
+        const auto mu = this->options.momentum;
+
+        for (size_t i = 0; i < eParameters.size(); i++) {
+            auto &eVelocity = this->eVelocities[i];
+            const auto &eDirection = eDirections[i];
+
+            // v' = mu v + rate g
+            auto eNewVelocity = atRest
+                                    ? Evaluate(*this, rate * eDirection)
+                                    : Evaluate(*this, mu * eVelocity + rate * eDirection);
+
+            if (this->options.optimizer == NESTEROV) {
+                // p += mu v' + rate g, expanded over v so that it takes no more levels than v' itself
+                const auto eStep = atRest
+                                       ? Evaluate(*this, (1.0 + mu) * rate * eDirection)
+                                       : Evaluate(*this, mu * mu * eVelocity + (1.0 + mu) * rate * eDirection);
+                this->EvalAddInPlace(*eParameters[i], eStep);
+            } else {
+                this->EvalAddInPlace(*eParameters[i], eNewVelocity);
+            }
+
+            eVelocity = std::move(eNewVelocity);
+        }
+    }
+
+    const std::vector<BootstrapableCiphertext> &Optimizer::GetVelocities() const {
+        return this->eVelocities;
+    }
+
+    void Optimizer::SetVelocities(std::vector<BootstrapableCiphertext> eVelocities) {
+        this->eVelocities = std::move(eVelocities);
+    }
+
+    void Optimizer::Reset() {
+        this->eVelocities.clear();
+    }
+}
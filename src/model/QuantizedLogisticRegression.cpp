@@ -0,0 +1,46 @@
+#include "model.h"
+
+namespace hermesml {
+    QuantizedLogisticRegression::QuantizedLogisticRegression(const HEContext &ctx, const std::vector<double> &weights,
+                                                             const double bias) : EncryptedObject(ctx) {
+        if (weights.size() != ctx.GetNumFeatures()) {
+            throw std::invalid_argument("Expected " + std::to_string(ctx.GetNumFeatures()) + " weights, got " +
+                                        std::to_string(weights.size()));
+        }
+
+        this->eWeights = this->Encrypt(Quantizer::Quantize(weights));
+        // The bias is added to products of two quantized values, so it carries the squared scale
+        this->eBias = this->Encrypt(
+            {static_cast<int64_t>(std::llround(bias * QUANTIZE_SCALE_FACTOR * QUANTIZE_SCALE_FACTOR))});
+    }
+
+    BootstrapableCiphertext QuantizedLogisticRegression::Predict(const BootstrapableCiphertext &x) const {
+        // The simulated values are doubles, exact for integers far beyond the products of two quantized values
+        if (this->GetCtx().IsSimulated()) {
+            return this->EvalAdd(this->EvalSum(this->EvalMult(x, this->eWeights)), this->eBias);
+        }
+
+        // Raw scheme calls: BFV has neither rescaling nor bootstrapping for the CKKS level tracking to manage
+        const auto &cc = this->GetCc();
+
+        const auto linearDot = cc->EvalMult(x.GetCiphertext(), this->eWeights.GetCiphertext());
+        const auto sumLinearDot = cc->EvalSum(linearDot, this->GetCtx().GetNumSlots());
+        return this->Wrap(cc->EvalAdd(sumLinearDot, this->eBias.GetCiphertext()));
+    }
+
+    std::vector<BootstrapableCiphertext> QuantizedLogisticRegression::PredictAll(
+        const std::vector<BootstrapableCiphertext> &x) const {
+        std::vector<BootstrapableCiphertext> predictions;
+        predictions.reserve(x.size());
+
+        for (const auto &sample: x) {
+            predictions.emplace_back(this->Predict(sample));
+        }
+
+        return predictions;
+    }
+
+    double QuantizedLogisticRegression::Dequantize(const int64_t logit) {
+        return static_cast<double>(logit) / (QUANTIZE_SCALE_FACTOR * QUANTIZE_SCALE_FACTOR);
+    }
+}
@@ -0,0 +1,97 @@
+#include <iomanip>
+
+#include "ciphertext-ser.h"
+#include "serving.h"
+
+namespace hermesml {
+    ClientAidedRefresh::ClientAidedRefresh(const std::string &socketPath, const double maskBound) :
+        stream(SocketStream::Connect(socketPath)), maskBound(maskBound), rng(std::random_device{}()) {
+    }
+
+    std::vector<double> ClientAidedRefresh::DrawMask(const size_t slots) const {
+        std::vector<double> mask(slots);
+        std::uniform_real_distribution dist(-this->maskBound, this->maskBound);
+        std::lock_guard lock(this->streamMutex);
+        for (auto &m: mask) {
+            m = dist(this->rng);
+        }
+        return mask;
+    }
+
+    std::string ClientAidedRefresh::Exchange(const std::string &payload) const {
+        MessageType type;
+        std::string reply;
+        {
+            // One request in flight per connection, so concurrent refreshes queue up here
+            std::lock_guard lock(this->streamMutex);
+            this->stream->WriteFrame(MSG_REFRESH, payload);
+
+            if (!this->stream->ReadFrame(type, reply)) {
+                throw std::runtime_error("The key holder closed the connection");
+            }
+        }
+
+        if (type != MSG_REFRESH) {
+            throw std::runtime_error("The key holder failed to refresh: " + reply);
+        }
+
+        ++this->refreshes;
+        return reply;
+    }
+
+    Ciphertext<DCRTPoly> ClientAidedRefresh::Refresh(const CryptoContext<DCRTPoly> &cc,
+                                                     const Ciphertext<DCRTPoly> &ciphertext) const {
+        const auto slots = ciphertext->GetSlots();
+        const auto mask = this->DrawMask(slots);
+        const auto pMask = cc->MakeCKKSPackedPlaintext(mask, 1, ciphertext->GetLevel(), nullptr, slots);
+
+        std::ostringstream out;
+        Serial::Serialize(cc->EvalAdd(ciphertext, pMask), out, SerType::BINARY);
+
+        Ciphertext<DCRTPoly> fresh;
+        std::istringstream in(this->Exchange(out.str()));
+        Serial::Deserialize(fresh, in, SerType::BINARY);
+
+        // The fresh ciphertext sits at level 0, where the unmasking plaintext is encoded by default
+        return cc->EvalSub(fresh, cc->MakeCKKSPackedPlaintext(mask, 1, 0, nullptr, slots));
+    }
+
+    std::vector<double> ClientAidedRefresh::SimulateRefresh(const std::vector<double> &values) const {
+        const auto mask = this->DrawMask(values.size());
+
+        std::ostringstream out;
+        out << std::setprecision(17);
+        for (size_t i = 0; i < values.size(); i++) {
+            out << values[i] + mask[i] << " ";
+        }
+
+        std::vector<double> fresh;
+        std::istringstream in(this->Exchange(out.str()));
+        for (double value; in >> value;) {
+            fresh.push_back(value);
+        }
+
+        if (fresh.size() != values.size()) {
+            throw std::runtime_error("The key holder returned " + std::to_string(fresh.size()) + " slots for " +
+                                     std::to_string(values.size()));
+        }
+
+        for (size_t i = 0; i < fresh.size(); i++) {
+            fresh[i] -= mask[i];
+        }
+        return fresh;
+    }
+
+    size_t ClientAidedRefresh::GetRefreshes() const {
+        return this->refreshes.load();
+    }
+
+    void ClientAidedRefresh::Shutdown() const {
+        std::lock_guard lock(this->streamMutex);
+        this->stream->WriteFrame(MSG_SHUTDOWN, "");
+
+        MessageType type;
+        std::string payload;
+        (void) this->stream->ReadFrame(type, payload);
+    }
+}
@@ -0,0 +1,61 @@
+#include "ciphertext-ser.h"
+#include "serving.h"
+
+namespace hermesml {
+    InferenceClient::InferenceClient(const HEContext &ctx, const std::string &socketPath) : EncryptedObject(ctx),
+        stream(SocketStream::Connect(socketPath)) {
+    }
+
+    double InferenceClient::Predict(const std::vector<double> &features) const {
+        const auto eQuery = this->EncryptCKKS(features);
+
+        std::ostringstream out;
+        Serial::Serialize(eQuery.GetCiphertext(), out, SerType::BINARY);
+        this->stream->WriteFrame(MSG_PREDICT, out.str());
+
+        MessageType type;
+        std::string payload;
+        if (!this->stream->ReadFrame(type, payload)) {
+            throw std::runtime_error("The inference server closed the connection");
+        }
+
+        if (type != MSG_RESULT) {
+            throw std::runtime_error("The inference server failed: " + payload);
+        }
+
+        std::istringstream in(payload);
+        Ciphertext<DCRTPoly> ePrediction;
+        Serial::Deserialize(ePrediction, in, SerType::BINARY);
+
+        Plaintext plaintext;
+        this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), ePrediction, &plaintext);
+
+        // The server zeroes every slot but the one of this query, whose position in the batch is not disclosed
+        double prediction = 0.0;
+        for (const auto value: plaintext->GetRealPackedValue()) {
+            prediction += value;
+        }
+
+        return prediction;
+    }
+
+    std::string InferenceClient::Stats() const {
+        this->stream->WriteFrame(MSG_STATS, "");
+
+        MessageType type;
+        std::string payload;
+        if (!this->stream->ReadFrame(type, payload) || type != MSG_STATS) {
+            throw std::runtime_error("Could not read the inference server statistics");
+        }
+
+        return payload;
+    }
+
+    void InferenceClient::Shutdown() const {
+        this->stream->WriteFrame(MSG_SHUTDOWN, "");
+
+        MessageType type;
+        std::string payload;
+        (void) this->stream->ReadFrame(type, payload);
+    }
+}
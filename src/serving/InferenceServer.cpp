@@ -0,0 +1,267 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "ciphertext-ser.h"
+#include "serving.h"
+
+namespace hermesml {
+    InferenceServer::InferenceServer(const HEContext &ctx, const CkksLogisticRegression &model,
+                                     InferenceServerOptions options) : EncryptedObject(ctx), model(model),
+                                                                       options(std::move(options)) {
+        const auto samplesPerCiphertext = ctx.GetSamplesPerCiphertext();
+
+        if (samplesPerCiphertext == 0) {
+            throw std::runtime_error("The inference server needs a context created with batched inference");
+        }
+
+        this->batchSize = this->options.maxBatchSize > 0
+                              ? std::min(this->options.maxBatchSize, samplesPerCiphertext)
+                              : samplesPerCiphertext;
+
+        // Queries arrive replicated over every block (sparse packing), so masking keeps one copy per query
+        const auto slots = ctx.GetPackingSlots();
+        const auto blockSize = ctx.GetNumSlots();
+        for (uint32_t k = 0; k < this->batchSize; k++) {
+            std::vector mask(slots, 0.0);
+            std::fill_n(mask.begin() + k * blockSize, blockSize, 1.0);
+            this->blockMasks.emplace_back(this->GetCc()->MakeCKKSPackedPlaintext(mask, 1, 0, nullptr, slots));
+
+            std::vector first(slots, 0.0);
+            first[k * blockSize] = 1.0;
+            this->resultMasks.emplace_back(this->GetCc()->MakeCKKSPackedPlaintext(first, 1, 0, nullptr, slots));
+        }
+    }
+
+    void InferenceServer::Serve() {
+        sockaddr_un address{};
+        if (this->options.socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path is too long: " + this->options.socketPath);
+        }
+
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, this->options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+        unlink(this->options.socketPath.c_str());
+
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(fd, 64) < 0) {
+            const auto error = std::string(std::strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            throw std::runtime_error("Could not listen on " + this->options.socketPath + ": " + error);
+        }
+
+        this->listenFd = fd;
+        this->running = true;
+
+        std::thread batcher(&InferenceServer::BatchLoop, this);
+
+        while (this->running) {
+            const auto connection = accept(fd, nullptr, nullptr);
+            if (connection < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            std::lock_guard lock(this->connectionsMutex);
+            this->connections.insert(connection);
+            std::thread(&InferenceServer::HandleConnection, this, connection).detach();
+        }
+
+        this->Stop();
+        batcher.join();
+
+        // Stop woke every handler up, and the batcher drained the queue before it returned
+        {
+            std::unique_lock lock(this->connectionsMutex);
+            this->connectionsCondition.wait(lock, [this] { return this->connections.empty(); });
+        }
+
+        close(fd);
+        unlink(this->options.socketPath.c_str());
+    }
+
+    void InferenceServer::Stop() {
+        // Under the queue lock, so no request is queued after the batcher saw the queue empty and stopped
+        {
+            std::lock_guard lock(this->queueMutex);
+            this->running = false;
+        }
+        this->queueCondition.notify_all();
+
+        // Wake up accept() and every handler blocked on a read
+        if (const auto fd = this->listenFd.load(); fd >= 0) {
+            shutdown(fd, SHUT_RDWR);
+        }
+
+        std::lock_guard lock(this->connectionsMutex);
+        for (const auto connection: this->connections) {
+            shutdown(connection, SHUT_RDWR);
+        }
+    }
+
+    void InferenceServer::HandleConnection(const int fd) {
+        const SocketStream stream(fd, this->options.maxFrameBytes);
+
+        MessageType type;
+        std::string payload;
+
+        // A misbehaving client only loses its own connection; nothing it sends may take the daemon down
+        try {
+            while (stream.ReadFrame(type, payload)) {
+                switch (type) {
+                    case MSG_PREDICT: {
+                        try {
+                            PendingRequest request;
+                            request.arrival = std::chrono::steady_clock::now();
+
+                            std::istringstream in(payload);
+                            Ciphertext<DCRTPoly> query;
+                            Serial::Deserialize(query, in, SerType::BINARY);
+                            request.query = this->Wrap(query);
+
+                            auto future = request.result.get_future();
+                            {
+                                std::lock_guard lock(this->queueMutex);
+                                if (!this->running) {
+                                    throw std::runtime_error("The inference server is shutting down");
+                                }
+                                this->queue.emplace_back(std::move(request));
+                            }
+                            this->queueCondition.notify_all();
+
+                            const auto result = future.get();
+
+                            std::ostringstream out;
+                            Serial::Serialize(result.prediction.GetCiphertext(), out, SerType::BINARY);
+                            stream.WriteFrame(MSG_RESULT, out.str());
+                        } catch (const std::exception &e) {
+                            stream.WriteFrame(MSG_ERROR, e.what());
+                        }
+                        break;
+                    }
+
+                    case MSG_STATS:
+                        stream.WriteFrame(MSG_STATS, this->GetStats());
+                        break;
+
+                    case MSG_SHUTDOWN:
+                        stream.WriteFrame(MSG_SHUTDOWN, "");
+                        this->Stop();
+                        break;
+
+                    default:
+                        stream.WriteFrame(MSG_ERROR, "Unknown message type");
+                        break;
+                }
+            }
+        } catch (const std::exception &e) {
+            // An oversized frame, or a peer gone while we wrote; the reply is best effort
+            try {
+                stream.WriteFrame(MSG_ERROR, e.what());
+            } catch (const std::exception &) {
+            }
+        }
+
+        std::lock_guard lock(this->connectionsMutex);
+        this->connections.erase(fd);
+        this->connectionsCondition.notify_all();
+    }
+
+    void InferenceServer::BatchLoop() {
+        while (true) {
+            std::vector<PendingRequest> batch;
+            {
+                std::unique_lock lock(this->queueMutex);
+                this->queueCondition.wait(lock, [this] { return !this->queue.empty() || !this->running; });
+
+                if (this->queue.empty()) {
+                    return;
+                }
+
+                // Hold the oldest request back a little, so concurrent requests can share its ciphertext
+                const auto deadline = this->queue.front().arrival +
+                                      std::chrono::milliseconds(this->options.maxBatchWaitMs);
+                this->queueCondition.wait_until(lock, deadline, [this] {
+                    return this->queue.size() >= this->batchSize || !this->running;
+                });
+
+                while (!this->queue.empty() && batch.size() < this->batchSize) {
+                    batch.emplace_back(std::move(this->queue.front()));
+                    this->queue.pop_front();
+                }
+            }
+
+            this->Execute(batch);
+            ++this->batchesExecuted;
+        }
+    }
+
+    void InferenceServer::Execute(std::vector<PendingRequest> &batch) {
+        try {
+            const auto prediction = this->model.PredictBatch(this->Pack(batch));
+
+            // Every reply is masked down to its own slot, so the predictions of the other clients stay private
+            const auto reply = this->EvalBootstrap(prediction, 1);
+            std::vector<BootstrapableCiphertext> replies;
+            replies.reserve(batch.size());
+            for (uint32_t k = 0; k < batch.size(); k++) {
+                replies.emplace_back(this->Wrap(this->GetCc()->EvalMult(reply.GetCiphertext(),
+                                                                        this->resultMasks[k])));
+            }
+
+            for (uint32_t k = 0; k < batch.size(); k++) {
+                batch[k].result.set_value(InferenceResult{std::move(replies[k])});
+            }
+        } catch (...) {
+            for (auto &request: batch) {
+                request.result.set_exception(std::current_exception());
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        for (const auto &request: batch) {
+            const std::chrono::duration<double, std::milli> elapsed = now - request.arrival;
+            this->latency.Record(elapsed.count());
+        }
+    }
+
+    BootstrapableCiphertext InferenceServer::Pack(const std::vector<PendingRequest> &batch) const {
+        BootstrapableCiphertext packed;
+
+        for (size_t k = 0; k < batch.size(); k++) {
+            const auto query = this->EvalBootstrap(batch[k].query, 1);
+            auto masked = this->GetCc()->EvalMult(query.GetCiphertext(), this->blockMasks[k]);
+            // The product inherits the sparse slot count of the query, but now spans the whole ring
+            masked->SetSlots(this->GetCtx().GetPackingSlots());
+
+            if (k == 0) {
+                packed = this->Wrap(std::move(masked));
+            } else {
+                this->EvalAddInPlace(packed, this->Wrap(std::move(masked)));
+            }
+        }
+
+        return this->EvalBootstrap(std::move(packed));
+    }
+
+    std::string InferenceServer::GetStats() const {
+        const auto summary = this->latency.Summarize();
+        const auto batches = this->batchesExecuted.load();
+
+        std::ostringstream stats;
+        stats << "requests = " << summary.count << std::endl;
+        stats << "batches = " << batches << std::endl;
+        stats << "meanBatchSize = " << (batches > 0 ? static_cast<double>(summary.count) / batches : 0.0) << std::endl;
+        stats << "meanLatencyMs = " << summary.mean << std::endl;
+        stats << "p50LatencyMs = " << summary.p50 << std::endl;
+        stats << "p99LatencyMs = " << summary.p99 << std::endl;
+
+        return stats.str();
+    }
+}
@@ -0,0 +1,36 @@
+#include "serving.h"
+
+namespace hermesml {
+    void LatencyRecorder::Record(const double milliseconds) {
+        std::lock_guard lock(this->mutex);
+        this->samples.push_back(milliseconds);
+    }
+
+    LatencySummary LatencyRecorder::Summarize() const {
+        std::vector<double> sorted;
+        {
+            std::lock_guard lock(this->mutex);
+            sorted = this->samples;
+        }
+
+        LatencySummary summary;
+        if (sorted.empty()) {
+            return summary;
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        // Nearest-rank percentiles
+        const auto percentile = [&sorted](const double p) {
+            const auto rank = static_cast<size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+            return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+        };
+
+        summary.count = sorted.size();
+        summary.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+        summary.p50 = percentile(0.50);
+        summary.p99 = percentile(0.99);
+
+        return summary;
+    }
+}
@@ -0,0 +1,115 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "ciphertext-ser.h"
+#include "serving.h"
+
+namespace hermesml {
+    RefreshService::RefreshService(const HEContext &ctx, std::string socketPath) : EncryptedObject(ctx),
+        socketPath(std::move(socketPath)) {
+        if (!ctx.IsSimulated() && !ctx.GetPrivateKey()) {
+            throw std::invalid_argument("The refresh service needs the secret key");
+        }
+    }
+
+    void RefreshService::Serve() {
+        sockaddr_un address{};
+        if (this->socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path is too long: " + this->socketPath);
+        }
+
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, this->socketPath.c_str(), sizeof(address.sun_path) - 1);
+        unlink(this->socketPath.c_str());
+
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || listen(fd, 16) < 0) {
+            const auto error = std::string(std::strerror(errno));
+            if (fd >= 0) {
+                close(fd);
+            }
+            throw std::runtime_error("Could not listen on " + this->socketPath + ": " + error);
+        }
+
+        this->listenFd = fd;
+        this->running = true;
+
+        std::vector<std::thread> handlers;
+        while (this->running) {
+            const auto connection = accept(fd, nullptr, nullptr);
+            if (connection < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+
+            handlers.emplace_back(&RefreshService::HandleConnection, this, connection);
+        }
+
+        for (auto &handler: handlers) {
+            handler.join();
+        }
+
+        close(fd);
+        unlink(this->socketPath.c_str());
+    }
+
+    void RefreshService::HandleConnection(const int fd) {
+        const SocketStream stream(fd);
+
+        MessageType type;
+        std::string payload;
+
+        // An oversized frame or a peer gone mid-reply only ends this connection
+        try {
+            while (stream.ReadFrame(type, payload)) {
+                if (type == MSG_SHUTDOWN) {
+                    stream.WriteFrame(MSG_SHUTDOWN, "");
+                    this->running = false;
+                    shutdown(this->listenFd, SHUT_RDWR);
+                    return;
+                }
+
+                if (type != MSG_REFRESH) {
+                    stream.WriteFrame(MSG_ERROR, "Unknown message type");
+                    continue;
+                }
+
+                try {
+                    stream.WriteFrame(MSG_REFRESH, this->Refresh(payload));
+                } catch (const std::exception &e) {
+                    stream.WriteFrame(MSG_ERROR, e.what());
+                }
+            }
+        } catch (const std::exception &) {
+        }
+    }
+
+    std::string RefreshService::Refresh(const std::string &payload) const {
+        // A simulated encryption is the slot values themselves, so decrypting and re-encrypting leaves them as sent
+        if (this->GetCtx().IsSimulated()) {
+            return payload;
+        }
+
+        Ciphertext<DCRTPoly> masked;
+        std::istringstream in(payload);
+        Serial::Deserialize(masked, in, SerType::BINARY);
+
+        Plaintext plaintext;
+        this->GetCc()->Decrypt(this->GetCtx().GetPrivateKey(), masked, &plaintext);
+
+        // Re-encrypting at level 0 gives the whole multiplicative depth back
+        const auto slots = masked->GetSlots();
+        plaintext->SetLength(slots);
+        const auto pFresh = this->GetCc()->MakeCKKSPackedPlaintext(plaintext->GetRealPackedValue(), 1, 0, nullptr,
+                                                                   slots);
+
+        std::ostringstream out;
+        Serial::Serialize(this->EncryptPlaintext(pFresh), out, SerType::BINARY);
+        return out.str();
+    }
+}
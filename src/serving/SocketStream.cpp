@@ -0,0 +1,102 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "serving.h"
+
+namespace hermesml {
+    SocketStream::SocketStream(const int fd, const uint64_t maxFrameBytes) : fd(fd), maxFrameBytes(maxFrameBytes) {
+    }
+
+    SocketStream::~SocketStream() {
+        if (this->fd >= 0) {
+            close(this->fd);
+        }
+    }
+
+    std::unique_ptr<SocketStream> SocketStream::Connect(const std::string &socketPath,
+                                                        const uint64_t maxFrameBytes) {
+        sockaddr_un address{};
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("Socket path is too long: " + socketPath);
+        }
+
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+        }
+
+        if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+            const auto error = std::string(std::strerror(errno));
+            close(fd);
+            throw std::runtime_error("Could not connect to " + socketPath + ": " + error);
+        }
+
+        return std::make_unique<SocketStream>(fd, maxFrameBytes);
+    }
+
+    void SocketStream::WriteFrame(const MessageType type, const std::string &payload) const {
+        const uint64_t length = payload.size();
+
+        std::string frame;
+        frame.reserve(sizeof(type) + sizeof(length) + payload.size());
+        frame.push_back(static_cast<char>(type));
+        frame.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        frame.append(payload);
+
+        size_t written = 0;
+        while (written < frame.size()) {
+            const auto n = send(this->fd, frame.data() + written, frame.size() - written, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error("Could not write to socket: " + std::string(std::strerror(errno)));
+            }
+            written += static_cast<size_t>(n);
+        }
+    }
+
+    bool SocketStream::ReadFrame(MessageType &type, std::string &payload) const {
+        const auto readExactly = [this](char *buffer, const size_t size) {
+            size_t read = 0;
+            while (read < size) {
+                const auto n = recv(this->fd, buffer + read, size - read, 0);
+                if (n == 0) {
+                    return false;
+                }
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                read += static_cast<size_t>(n);
+            }
+            return true;
+        };
+
+        char header[1 + sizeof(uint64_t)];
+        if (!readExactly(header, sizeof(header))) {
+            return false;
+        }
+
+        uint64_t length;
+        std::memcpy(&length, header + 1, sizeof(length));
+        type = static_cast<MessageType>(header[0]);
+
+        // The length comes from the peer, so it is checked before anything is allocated for it
+        if (length > this->maxFrameBytes) {
+            throw std::runtime_error("Frame of " + std::to_string(length) + " bytes exceeds the limit of " +
+                                     std::to_string(this->maxFrameBytes));
+        }
+
+        payload.resize(length);
+        return length == 0 || readExactly(payload.data(), length);
+    }
+}
@@ -0,0 +1,93 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "context.h"
+
+using namespace hermesml;
+
+namespace {
+    class CostModelTest : public testing::Test {
+    protected:
+        std::string filePath;
+
+        void SetUp() override {
+            const auto *test = testing::UnitTest::GetInstance()->current_test_info();
+            filePath = (std::filesystem::temp_directory_path() /
+                        ("hermesml-cost-model-test-" + std::string(test->name()) + ".csv")).string();
+        }
+
+        void TearDown() override {
+            std::filesystem::remove(filePath);
+        }
+
+        void Write(const std::string &contents) const {
+            std::ofstream(filePath, std::ios::trunc) << contents;
+        }
+    };
+
+    CostModel TwoLevels() {
+        return CostModel({{0.5, 1.0, 8.0, 4.0, 900.0}, {0.75, 1.5, 12.0, 6.0, 900.0}});
+    }
+}
+
+TEST_F(CostModelTest, LoadsWhatSaveWrote) {
+    TwoLevels().Save(filePath);
+    const auto loaded = CostModel::Load(filePath);
+
+    ASSERT_EQ(loaded.GetLevels(), 1u);
+    for (auto level = 0; level <= 1; level++) {
+        for (auto op = 0; op < SIM_OPS; op++) {
+            EXPECT_EQ(loaded.GetCost(static_cast<SimulatedOp>(op), level),
+                      TwoLevels().GetCost(static_cast<SimulatedOp>(op), level));
+        }
+    }
+}
+
+TEST_F(CostModelTest, MatchesColumnsByName) {
+    Write("level,bootstrap,rotate,mult,add,encrypt\n"
+        "0,900,4,8,1,0.5\n"
+        "1,900,6,12,1.5,0.75\n");
+    const auto loaded = CostModel::Load(filePath);
+
+    EXPECT_EQ(loaded.GetCost(SIM_ENCRYPT, 1), 0.75);
+    EXPECT_EQ(loaded.GetCost(SIM_MULT, 0), 8.0);
+    EXPECT_EQ(loaded.GetCost(SIM_BOOTSTRAP, 1), 900.0);
+}
+
+TEST_F(CostModelTest, RejectsFilesWithoutEveryOperation) {
+    Write("level,encrypt,add,mult,rotate\n0,0.5,1,8,4\n");
+    EXPECT_THROW((void) CostModel::Load(filePath), std::runtime_error);
+}
+
+TEST_F(CostModelTest, RejectsMalformedRows) {
+    Write("level,encrypt,add,mult,rotate,bootstrap\n0,0.5,1,8,4\n");
+    EXPECT_THROW((void) CostModel::Load(filePath), std::runtime_error);
+
+    // Levels have to follow each other from 0
+    Write("level,encrypt,add,mult,rotate,bootstrap\n1,0.5,1,8,4,900\n");
+    EXPECT_THROW((void) CostModel::Load(filePath), std::runtime_error);
+}
+
+TEST_F(CostModelTest, RejectsMissingFiles) {
+    EXPECT_THROW((void) CostModel::Load(filePath), std::runtime_error);
+}
+
+TEST_F(CostModelTest, ClampsLevelsOutsideTheCalibratedRange) {
+    const auto model = TwoLevels();
+
+    EXPECT_EQ(model.GetCost(SIM_MULT, -3), 8.0);
+    EXPECT_EQ(model.GetCost(SIM_MULT, 30), 12.0);
+    EXPECT_FALSE(CostModel().IsCalibrated());
+    EXPECT_EQ(CostModel().GetCost(SIM_MULT, 1), 0.0);
+}
+
+TEST_F(CostModelTest, SimulationChargesEveryOperationAtItsLevel) {
+    Simulation simulation(1, TwoLevels());
+    simulation.Count(SIM_MULT, 1, 10);
+    simulation.Count(SIM_ADD, 0, 4);
+    simulation.Count(SIM_BOOTSTRAP, 5);
+
+    EXPECT_DOUBLE_EQ(simulation.EstimateSeconds(), (10 * 12.0 + 4 * 1.0 + 900.0) / 1000.0);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    class SimulationTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(4);
+        EncryptedObject he{ctx};
+
+        [[nodiscard]] Simulation &GetSimulation() const {
+            return ctx.GetSimulation();
+        }
+
+        [[nodiscard]] int32_t AfterBootstrapping() const {
+            return static_cast<int32_t>(ctx.GetLevelsAfterBootstrapping());
+        }
+    };
+}
+
+TEST_F(SimulationTest, HasNoKeysButKeepsTheParameters) {
+    EXPECT_TRUE(ctx.IsSimulated());
+    EXPECT_FALSE(ctx.GetPublicKey());
+    EXPECT_EQ(ctx.GetNumSlots(), 4u);
+    EXPECT_EQ(HEContextFactory::simulatedCkksHeContext(5).GetNumSlots(), 8u);
+}
+
+TEST_F(SimulationTest, ComputesOnTheSlotValues) {
+    const auto x = he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0});
+    const auto y = he.EncryptCKKS(std::vector{0.5, -1.0, 2.0, 0.0});
+
+    EXPECT_EQ(he.EvalAdd(x, y).GetValues(), (std::vector{1.5, 1.0, 5.0, 4.0}));
+    EXPECT_EQ(he.EvalSub(x, y).GetValues(), (std::vector{0.5, 3.0, 1.0, 4.0}));
+    EXPECT_EQ(he.EvalMult(x, y).GetValues(), (std::vector{0.5, -2.0, 6.0, 0.0}));
+    EXPECT_EQ(he.EvalRotate(x, 1).GetValues(), (std::vector{2.0, 3.0, 4.0, 1.0}));
+    EXPECT_EQ(he.EvalRotate(x, -1).GetValues(), (std::vector{4.0, 1.0, 2.0, 3.0}));
+    EXPECT_EQ(he.EvalSum(x).GetValues()[0], 10.0);
+}
+
+TEST_F(SimulationTest, CountsOperationsAtTheirLevel) {
+    GetSimulation().Reset();
+
+    const auto x = he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0});
+    const auto levels = x.GetRemainingLevels();
+    const auto product = he.EvalMult(x, x);
+    (void) he.EvalAdd(product, x);
+
+    EXPECT_EQ(product.GetRemainingLevels(), levels - 1);
+    EXPECT_EQ(GetSimulation().GetCount(SIM_ENCRYPT, levels), 1u);
+    EXPECT_EQ(GetSimulation().GetCount(SIM_MULT, levels), 1u);
+    EXPECT_EQ(GetSimulation().GetCount(SIM_ADD, levels - 1), 1u);
+    EXPECT_EQ(GetSimulation().GetTotalCount(), 3u);
+
+    GetSimulation().Reset();
+    EXPECT_EQ(GetSimulation().GetTotalCount(), 0u);
+}
+
+TEST_F(SimulationTest, BootstrapsWhenTheLevelsRunOut) {
+    GetSimulation().Reset();
+
+    auto x = he.EncryptCKKS(std::vector{0.5, 0.5, 0.5, 0.5});
+    const auto products = x.GetRemainingLevels();
+    for (auto i = 0; i < products; i++) {
+        x = he.EvalMult(x, x);
+    }
+
+    EXPECT_GE(GetSimulation().GetCount(SIM_BOOTSTRAP), 1u);
+    EXPECT_GT(x.GetRemainingLevels(), 1);
+    EXPECT_LE(x.GetRemainingLevels(), AfterBootstrapping());
+}
+
+TEST_F(SimulationTest, MaskingTheLastLevelBootstraps) {
+    GetSimulation().Reset();
+
+    const BootstrapableCiphertext x(std::vector{1.0, 2.0, 3.0, 4.0}, 2);
+    const auto masked = he.EvalMask(x, {0.0, 1.0});
+
+    EXPECT_EQ(masked.GetValues(), (std::vector{0.0, 2.0, 0.0, 0.0}));
+    EXPECT_EQ(GetSimulation().GetCount(SIM_BOOTSTRAP), 1u);
+    EXPECT_EQ(masked.GetRemainingLevels(), AfterBootstrapping());
+}
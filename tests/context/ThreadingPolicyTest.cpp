@@ -0,0 +1,72 @@
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "context.h"
+
+using namespace hermesml;
+
+TEST(ThreadingPolicyTest, ParallelForRunsEveryJobOnce) {
+    const ThreadingPolicy policy;
+
+    for (const uint32_t workers: {1u, 4u}) {
+        std::vector<std::atomic<int> > runs(100);
+        policy.ParallelFor(runs.size(), workers, [&runs](const size_t i) { ++runs[i]; });
+
+        for (size_t i = 0; i < runs.size(); i++) {
+            EXPECT_EQ(runs[i], 1) << "job " << i << " on " << workers << " workers";
+        }
+    }
+}
+
+TEST(ThreadingPolicyTest, ParallelForRethrowsTheExceptionOfAJob) {
+    const ThreadingPolicy policy;
+
+    for (const uint32_t workers: {1u, 4u}) {
+        std::atomic<size_t> started{0};
+        const auto job = [&started](const size_t i) {
+            ++started;
+            if (i == 3) {
+                throw std::runtime_error("job failed");
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        };
+
+        EXPECT_THROW(policy.ParallelFor(1000, workers, job), std::runtime_error);
+
+        // The other workers stop at their next job instead of draining the range
+        EXPECT_LT(started, 1000u) << "on " << workers << " workers";
+    }
+}
+
+TEST(ThreadingPolicyTest, ResolvesWorkersWithinTheJobs) {
+    const ThreadingPolicy policy(8, 4);
+
+    EXPECT_EQ(policy.ResolveWorkers(0, 100), 4u);
+    EXPECT_EQ(policy.ResolveWorkers(6, 100), 6u);
+    EXPECT_EQ(policy.ResolveWorkers(0, 2), 2u);
+    EXPECT_EQ(policy.ResolveWorkers(0, 0), 1u);
+}
+
+TEST(ThreadingPolicyTest, SplitsTheCoresBetweenWorkers) {
+    const ThreadingPolicy policy(1);
+
+    EXPECT_EQ(policy.GetCores(), 1u);
+    EXPECT_EQ(policy.GetWorkers(), 1u);
+    EXPECT_EQ(policy.GetOpenMPThreads(4), 1u);
+    EXPECT_EQ(ThreadingPolicy().GetOpenMPThreads(1), ThreadingPolicy().GetCores());
+}
+
+TEST(ThreadingPolicyTest, ReadsTheEnvironment) {
+    setenv("HERMESML_WORKERS", "3", 1);
+    setenv("HERMESML_AFFINITY", "cores", 1);
+    const auto policy = ThreadingPolicy::FromEnvironment(ThreadingPolicy());
+    EXPECT_EQ(policy.GetWorkers(), 3u);
+    EXPECT_EQ(policy.GetAffinity(), CORE_AFFINITY);
+
+    setenv("HERMESML_AFFINITY", "sockets", 1);
+    EXPECT_THROW((void) ThreadingPolicy::FromEnvironment(ThreadingPolicy()), std::invalid_argument);
+
+    unsetenv("HERMESML_WORKERS");
+    unsetenv("HERMESML_AFFINITY");
+}
@@ -0,0 +1,95 @@
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    class CheckpointerTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(4);
+        std::string directory;
+
+        void SetUp() override {
+            const auto *test = testing::UnitTest::GetInstance()->current_test_info();
+            directory = (std::filesystem::temp_directory_path() / "hermesml-checkpoint-test" / test->name()).string();
+            std::filesystem::remove_all(directory);
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(directory);
+        }
+    };
+}
+
+TEST_F(CheckpointerTest, RoundTripsCursorRngAndParameters) {
+    const Checkpointer checkpointer(ctx, {directory}, "model");
+
+    std::mt19937 rng(42);
+    rng.discard(7);
+    const std::vector parameters = {
+        BootstrapableCiphertext(std::vector{0.1, -2.5, 1.0 / 3.0, 0.0}, 5, 2),
+        BootstrapableCiphertext(std::vector{1e-9, 3.0}, 1, 0)
+    };
+    const std::vector activationCoefficients = {0.0, 0.6, 0.0, -1.0 / 30.0};
+    checkpointer.Save({2, 17}, rng, parameters, activationCoefficients);
+
+    TrainingCursor cursor;
+    std::mt19937 restoredRng;
+    std::vector<BootstrapableCiphertext> restored;
+    std::vector<double> coefficients;
+    ASSERT_TRUE(checkpointer.Load(cursor, restoredRng, restored, coefficients));
+
+    EXPECT_EQ(cursor.epoch, 2);
+    EXPECT_EQ(cursor.sample, 17u);
+    EXPECT_EQ(restoredRng, rng);
+    EXPECT_EQ(coefficients, activationCoefficients);
+    ASSERT_EQ(restored.size(), parameters.size());
+
+    for (size_t i = 0; i < parameters.size(); i++) {
+        EXPECT_EQ(restored[i].GetValues(), parameters[i].GetValues());
+        EXPECT_EQ(restored[i].GetRemainingLevels(), parameters[i].GetRemainingLevels());
+        EXPECT_EQ(restored[i].GetAdditionsExecuted(), parameters[i].GetAdditionsExecuted());
+    }
+}
+
+TEST_F(CheckpointerTest, LoadReturnsFalseWithoutACheckpoint) {
+    TrainingCursor cursor;
+    std::mt19937 rng;
+    std::vector<BootstrapableCiphertext> parameters;
+    std::vector<double> coefficients;
+
+    EXPECT_FALSE(Checkpointer(ctx, {directory}, "model").Load(cursor, rng, parameters, coefficients));
+    EXPECT_FALSE(Checkpointer(ctx, {}, "model").Load(cursor, rng, parameters, coefficients));
+}
+
+TEST_F(CheckpointerTest, IsDueFollowsTheConfiguredInterval) {
+    const Checkpointer disabled(ctx, {}, "model");
+    EXPECT_FALSE(disabled.IsDue({0, 10}, 10));
+
+    const Checkpointer everyTwoEpochs(ctx, {directory, 0, 2}, "model");
+    EXPECT_FALSE(everyTwoEpochs.IsDue({0, 5}, 10));
+    EXPECT_FALSE(everyTwoEpochs.IsDue({0, 10}, 10));
+    EXPECT_TRUE(everyTwoEpochs.IsDue({1, 10}, 10));
+
+    const Checkpointer everyFourSamples(ctx, {directory, 4, 1}, "model");
+    EXPECT_FALSE(everyFourSamples.IsDue({0, 3}, 10));
+    EXPECT_TRUE(everyFourSamples.IsDue({0, 4}, 10));
+    EXPECT_TRUE(everyFourSamples.IsDue({0, 10}, 10));
+}
+
+TEST_F(CheckpointerTest, RefusesTheCheckpointOfAnotherModel) {
+    Checkpointer(ctx, {directory}, "model").Save({}, std::mt19937(), {});
+
+    // Both models share the file name, as a renamed checkpoint would
+    std::filesystem::rename(directory + "/model.ckpt", directory + "/other.ckpt");
+
+    TrainingCursor cursor;
+    std::mt19937 rng;
+    std::vector<BootstrapableCiphertext> parameters;
+    std::vector<double> coefficients;
+    EXPECT_THROW((void) Checkpointer(ctx, {directory}, "other").Load(cursor, rng, parameters, coefficients),
+                 std::runtime_error);
+}
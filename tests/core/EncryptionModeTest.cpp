@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "client.h"
+
+using namespace hermesml;
+
+namespace {
+    const std::vector<int64_t> values = {3, -7, 11, 0};
+
+    // BFV round-trips integers exactly, so a wrong key cannot hide behind a tolerance
+    class EncryptionModeTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::bfvHeContext(static_cast<uint32_t>(values.size()));
+    };
+}
+
+TEST_F(EncryptionModeTest, PublicKeyEncryptionLeavesThePrivateKeyAlone) {
+    ASSERT_EQ(ctx.GetEncryptionMode(), PUBLIC_KEY_ENCRYPTION);
+
+    auto encrypting = ctx;
+    encrypting.SetPrivateKey(nullptr);
+
+    EXPECT_EQ(Client(ctx).Decrypt(Client(encrypting).Encrypt(values)), values);
+}
+
+TEST_F(EncryptionModeTest, SecretKeyEncryptionLeavesThePublicKeyAlone) {
+    auto encrypting = ctx;
+    encrypting.SetEncryptionMode(SECRET_KEY_ENCRYPTION);
+    encrypting.SetPublicKey(nullptr);
+
+    EXPECT_EQ(Client(ctx).Decrypt(Client(encrypting).Encrypt(values)), values);
+}
+
+TEST_F(EncryptionModeTest, SecretKeyEncryptionEncryptsUnderTheContextsPrivateKey) {
+    auto other = ctx;
+    other.SetEncryptionMode(SECRET_KEY_ENCRYPTION);
+    other.SetPrivateKey(ctx.GetCc()->KeyGen().secretKey);
+
+    EXPECT_EQ(Client(other).Decrypt(Client(other).Encrypt(values)), values);
+    EXPECT_NE(Client(ctx).Decrypt(Client(other).Encrypt(values)), values);
+}
+
+TEST_F(EncryptionModeTest, SecretKeyEncryptionWithoutThePrivateKeyFails) {
+    auto encrypting = ctx;
+    encrypting.SetEncryptionMode(SECRET_KEY_ENCRYPTION);
+    encrypting.SetPrivateKey(nullptr);
+
+    EXPECT_THROW((void) Client(encrypting).Encrypt(values), std::runtime_error);
+}
@@ -0,0 +1,83 @@
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    class ScoredExperiment final : public Experiment {
+    public:
+        using Experiment::Experiment;
+        using Experiment::WritePredictions;
+    };
+
+    class ExperimentTest : public testing::Test {
+    protected:
+        std::filesystem::path previous = std::filesystem::current_path();
+        std::filesystem::path directory = std::filesystem::temp_directory_path() / "ExperimentTest";
+
+        // Experiments log to ../logs and write under ./Predictions, so both land in a scratch directory
+        void SetUp() override {
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory / "run");
+            std::filesystem::current_path(directory / "run");
+        }
+
+        void TearDown() override {
+            std::filesystem::current_path(previous);
+            std::filesystem::remove_all(directory);
+        }
+    };
+
+    std::vector<std::string> ReadLines(const std::string &path) {
+        std::ifstream in(path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+}
+
+TEST_F(ExperimentTest, WritesOneThresholdedLinePerPredictionAndScoresThem) {
+    Dataset dataset("scored", F01);
+    const ScoredExperiment experiment("scoring", dataset);
+
+    // Predicted 1, 0, 1, 0, 1: two true positives, one of each other outcome. The threshold itself is negative
+    const auto metrics = experiment.WritePredictions({0.9, 0.2, 0.6, 0.5, 0.7}, {1.0, 0.0, 0.0, 1.0, 1.0}, 0.5);
+
+    EXPECT_EQ(metrics.truePositives, 2u);
+    EXPECT_EQ(metrics.falsePositives, 1u);
+    EXPECT_EQ(metrics.trueNegatives, 1u);
+    EXPECT_EQ(metrics.falseNegatives, 1u);
+    EXPECT_DOUBLE_EQ(metrics.accuracy, 3.0 / 5.0);
+    EXPECT_DOUBLE_EQ(metrics.precision, 2.0 / 3.0);
+    EXPECT_DOUBLE_EQ(metrics.recall, 2.0 / 3.0);
+    EXPECT_DOUBLE_EQ(metrics.f1, 2.0 / 3.0);
+
+    const std::vector<std::string> expected = {"0.9,1,1", "0.2,0,0", "0.6,0,1", "0.5,1,0", "0.7,1,1"};
+    EXPECT_EQ(ReadLines(experiment.GetContentPath() + "predictions.csv"), expected);
+}
+
+TEST_F(ExperimentTest, ScoresWithoutPositivesAsZero) {
+    Dataset dataset("scored", F01);
+    const ScoredExperiment experiment("negatives", dataset);
+
+    const auto metrics = experiment.WritePredictions({0.1, 0.3}, {0.0, 0.0}, 0.5);
+
+    EXPECT_DOUBLE_EQ(metrics.accuracy, 1.0);
+    EXPECT_DOUBLE_EQ(metrics.precision, 0.0);
+    EXPECT_DOUBLE_EQ(metrics.recall, 0.0);
+    EXPECT_DOUBLE_EQ(metrics.f1, 0.0);
+}
+
+TEST_F(ExperimentTest, RejectsPredictionsWithoutAMatchingLabel) {
+    Dataset dataset("scored", F01);
+    const ScoredExperiment experiment("mismatched", dataset);
+
+    EXPECT_THROW((void) experiment.WritePredictions({0.9, 0.2}, {1.0}, 0.5), std::invalid_argument);
+    EXPECT_FALSE(std::filesystem::exists(experiment.GetContentPath() + "predictions.csv"));
+}
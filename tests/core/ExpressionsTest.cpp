@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "expressions.h"
+
+using namespace hermesml;
+
+namespace {
+    class ExpressionsTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(2);
+        EncryptedObject he{ctx};
+
+        BootstrapableCiphertext a = he.EncryptCKKS(std::vector{1.0, 2.0});
+        BootstrapableCiphertext b = he.EncryptCKKS(std::vector{3.0, -1.0});
+        BootstrapableCiphertext c = he.EncryptCKKS(std::vector{0.5, 4.0});
+        BootstrapableCiphertext d = he.EncryptCKKS(std::vector{-2.0, 0.25});
+
+        [[nodiscard]] Simulation &GetSimulation() const {
+            return ctx.GetSimulation();
+        }
+    };
+
+    void ExpectValues(const BootstrapableCiphertext &ciphertext, const std::vector<double> &expected) {
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(ciphertext.GetValues()[i], expected[i], 1e-12) << "at slot " << i;
+        }
+    }
+}
+
+TEST_F(ExpressionsTest, EvaluatesLikeTheSameArithmeticOnPlainValues) {
+    const auto result = Evaluate(he, 2.0 * a - b / 4.0 + 0.5 * (a * b + c * d) - d);
+
+    std::vector<double> expected(2);
+    for (size_t i = 0; i < expected.size(); i++) {
+        const auto x = a.GetValues()[i], y = b.GetValues()[i], z = c.GetValues()[i], w = d.GetValues()[i];
+        expected[i] = 2.0 * x - y / 4.0 + 0.5 * (x * y + z * w) - w;
+    }
+
+    ExpectValues(result, expected);
+}
+
+TEST_F(ExpressionsTest, ProductsSharingAWeightAreRelinearizedOnce) {
+    GetSimulation().Reset();
+    const auto result = Evaluate(he, a * b + c * d);
+
+    EXPECT_EQ(GetSimulation().GetCount(SIM_MULT), 1u);
+    EXPECT_EQ(result.GetRemainingLevels(), a.GetRemainingLevels() - 1);
+    ExpectValues(result, {3.0 - 1.0, -2.0 + 1.0});
+}
+
+TEST_F(ExpressionsTest, UnitWeightsSpendNoLevel) {
+    const auto result = Evaluate(he, a + b - c);
+
+    EXPECT_EQ(result.GetRemainingLevels(), a.GetRemainingLevels());
+    ExpectValues(result, {3.5, -3.0});
+}
+
+TEST_F(ExpressionsTest, RepeatedOperandsAreOneTerm) {
+    GetSimulation().Reset();
+    const auto result = Evaluate(he, a + a + a);
+
+    ExpectValues(result, {3.0, 6.0});
+    EXPECT_EQ(GetSimulation().GetCount(SIM_ADD), 1u);
+}
+
+TEST_F(ExpressionsTest, NestedProductsStayCorrect) {
+    // (a * b) is evaluated on its own before it multiplies c, so no product goes beyond degree two
+    const auto result = Evaluate(he, (a * b) * c + 3.0 * d);
+
+    ExpectValues(result, {1.5 - 6.0, -8.0 + 0.75});
+    EXPECT_EQ(result.GetRemainingLevels(), a.GetRemainingLevels() - 3);
+}
+
+TEST_F(ExpressionsTest, ExpressionsThatCancelOutAreZero) {
+    const auto linear = Evaluate(he, a - a);
+    ExpectValues(linear, {0.0, 0.0});
+    EXPECT_EQ(linear.GetRemainingLevels(), a.GetRemainingLevels());
+
+    // The product still spends the level it would have without its zero weight
+    const auto products = Evaluate(he, 0.0 * (a * b) + c - c);
+    ExpectValues(products, {0.0, 0.0});
+    EXPECT_EQ(products.GetRemainingLevels(), a.GetRemainingLevels() - 1);
+
+    ExpectValues(Evaluate(he, 2.0 * a * b - 2.0 * a * b), {0.0, 0.0});
+}
+
+TEST_F(ExpressionsTest, ProductsWithDifferentWeightsAreRelinearizedOncePerWeight) {
+    GetSimulation().Reset();
+    const auto separate = Evaluate(he, a * b + 2.0 * c * d);
+    EXPECT_EQ(GetSimulation().GetCount(SIM_MULT), 2u);
+
+    GetSimulation().Reset();
+    const auto shared = Evaluate(he, 2.0 * (a * b + c * d));
+    EXPECT_EQ(GetSimulation().GetCount(SIM_MULT), 1u);
+
+    ExpectValues(separate, {3.0 - 2.0, -2.0 + 2.0});
+    ExpectValues(shared, {6.0 - 2.0, -4.0 + 2.0});
+}
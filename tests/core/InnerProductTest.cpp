@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    class InnerProductTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(2);
+        EncryptedObject he{ctx};
+
+        std::vector<BootstrapableCiphertext> a = {
+            he.EncryptCKKS(std::vector{1.0, 2.0}), he.EncryptCKKS(std::vector{0.5, -3.0}),
+            he.EncryptCKKS(std::vector{-2.0, 0.25})
+        };
+        std::vector<BootstrapableCiphertext> b = {
+            he.EncryptCKKS(std::vector{3.0, -1.0}), he.EncryptCKKS(std::vector{4.0, 2.0}),
+            he.EncryptCKKS(std::vector{1.5, 8.0})
+        };
+    };
+}
+
+TEST_F(InnerProductTest, SumsThePairwiseProducts) {
+    const auto result = he.EvalInnerProduct(a, b);
+
+    for (size_t i = 0; i < 2; i++) {
+        double expected = 0.0;
+        for (size_t j = 0; j < a.size(); j++) {
+            expected += a[j].GetValues()[i] * b[j].GetValues()[i];
+        }
+        EXPECT_NEAR(result.GetValues()[i], expected, 1e-12) << "at slot " << i;
+    }
+}
+
+TEST_F(InnerProductTest, RelinearizesAndSpendsALevelOnlyOnce) {
+    ctx.GetSimulation().Reset();
+    const auto result = he.EvalInnerProduct(a, b);
+
+    EXPECT_EQ(ctx.GetSimulation().GetCount(SIM_MULT), 1u);
+    EXPECT_EQ(result.GetRemainingLevels(), a[0].GetRemainingLevels() - 1);
+    EXPECT_EQ(result.GetAdditionsExecuted(), static_cast<int32_t>(a.size()) - 1);
+}
+
+TEST_F(InnerProductTest, RejectsUnpairedCiphertexts) {
+    b.pop_back();
+    EXPECT_THROW((void) he.EvalInnerProduct(a, b), std::invalid_argument);
+    EXPECT_THROW((void) he.EvalInnerProduct({}, {}), std::invalid_argument);
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    constexpr size_t blockBytes = 64 << 20;
+
+    // Touches every page, so the block is resident until it is freed
+    size_t HoldBlock() {
+        const std::vector<char> block(blockBytes, 1);
+        return MemoryFootprint::CurrentRss() + static_cast<size_t>(block.back() - 1);
+    }
+}
+
+TEST(MemoryFootprintTest, PeakRssFollowsTheResidentSet) {
+    const auto before = MemoryFootprint::CurrentRss();
+    ASSERT_GT(before, 0u);
+
+    const auto holding = HoldBlock();
+
+    // The kernel updates both counters lazily, so they are only compared at the scale of the block
+    EXPECT_GE(holding, before + blockBytes / 2);
+    EXPECT_GE(MemoryFootprint::PeakRss(), before + blockBytes / 2);
+}
+
+TEST(MemoryFootprintTest, ResetPeakRssForgetsEarlierPeaks) {
+    const auto peak = std::max(MemoryFootprint::PeakRss(), HoldBlock());
+
+    if (!MemoryFootprint::ResetPeakRss()) {
+        GTEST_SKIP() << "The kernel does not allow resetting the peak resident set";
+    }
+
+    // An experiment that runs after a larger one reports its own peak
+    EXPECT_LT(MemoryFootprint::PeakRss(), peak - blockBytes / 2);
+}
@@ -0,0 +1,127 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "tracing.h"
+
+using namespace hermesml;
+
+namespace {
+    class TracerTest : public testing::Test {
+    protected:
+        std::string filePath;
+
+        void SetUp() override {
+            const auto *test = testing::UnitTest::GetInstance()->current_test_info();
+            filePath = (std::filesystem::temp_directory_path() /
+                        ("hermesml-tracer-test-" + std::string(test->name()) + ".json")).string();
+
+            // The tracer is process-wide, so whatever earlier tests recorded is dropped first
+            Tracer::Get().Flush(filePath);
+        }
+
+        void TearDown() override {
+            std::filesystem::remove(filePath);
+        }
+
+        [[nodiscard]] std::string Flush() const {
+            Tracer::Get().Flush(filePath);
+            std::ifstream in(filePath);
+            std::stringstream contents;
+            contents << in.rdbuf();
+            return contents.str();
+        }
+    };
+
+    size_t Count(const std::string &text, const std::string &pattern) {
+        size_t count = 0;
+        for (auto at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + 1)) {
+            count++;
+        }
+        return count;
+    }
+
+    int64_t Field(const std::string &text, const std::string &name, const std::string &key) {
+        const auto span = text.find("{\"name\":\"" + name + "\"");
+        const auto at = text.find("\"" + key + "\":", span);
+        return std::stoll(text.substr(at + key.size() + 3));
+    }
+}
+
+TEST_F(TracerTest, RecordsNestedScopes) {
+    {
+        TraceScope outer("outer");
+        {
+            TraceScope inner("inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+
+    const auto trace = Flush();
+    EXPECT_EQ(Count(trace, "\"ph\":\"X\""), 2u);
+
+    // Viewers nest spans by their times alone
+    const auto outerStart = Field(trace, "outer", "ts");
+    const auto innerStart = Field(trace, "inner", "ts");
+    EXPECT_LE(outerStart, innerStart);
+    EXPECT_GE(outerStart + Field(trace, "outer", "dur"), innerStart + Field(trace, "inner", "dur"));
+    EXPECT_GE(Field(trace, "inner", "dur"), 2000);
+}
+
+TEST_F(TracerTest, FlushStartsOver) {
+    Tracer::Get().Record("once", 0, 1);
+
+    EXPECT_EQ(Count(Flush(), "\"name\":\"once\""), 1u);
+    EXPECT_EQ(Count(Flush(), "\"name\":\"once\""), 0u);
+}
+
+TEST_F(TracerTest, KeepsTheSpansOfEveryThread) {
+    Tracer::Get().Record("main", 0, 1);
+    std::thread([] { Tracer::Get().Record("worker", 0, 1); }).join();
+
+    // The worker has exited, yet its spans are still written, under a thread of their own
+    const auto trace = Flush();
+    EXPECT_EQ(Count(trace, "\"name\":\"worker\""), 1u);
+    EXPECT_NE(Field(trace, "main", "tid"), Field(trace, "worker", "tid"));
+}
+
+TEST_F(TracerTest, ForgetsThreadsOnceTheirSpansAreWritten) {
+    for (auto i = 0; i < 8; i++) {
+        std::thread([] { Tracer::Get().Record("short-lived", 0, 1); }).join();
+    }
+    Tracer::Get().Record("main", 0, 1);
+
+    EXPECT_EQ(Count(Flush(), "\"name\":\"short-lived\""), 8u);
+
+    // Only the live thread is left, so exited workers hold no buffer
+    EXPECT_EQ(Count(Flush(), "\"name\":\"thread_name\""), 1u);
+}
+
+TEST_F(TracerTest, EscapesSpanNames) {
+    Tracer::Get().Record("say \"hi\" \\", 0, 1);
+    Tracer::Get().Record("line\nbreak\t\x01", 0, 1);
+
+    const auto trace = Flush();
+    EXPECT_EQ(Count(trace, R"("name":"say \"hi\" \\")"), 1u);
+    EXPECT_EQ(Count(trace, R"("name":"line\u000abreak\u0009\u0001")"), 1u);
+}
+
+TEST_F(TracerTest, TraceScopeOnlyRecordsInTracingBuilds) {
+    auto evaluated = 0;
+    // Unused when the macro expands to nothing
+    [[maybe_unused]] const auto name = [&evaluated] {
+        evaluated++;
+        return std::string("macro");
+    };
+
+    {
+        TRACE_SCOPE(name());
+    }
+
+    const auto expected = Tracer::IsEnabled() ? 1 : 0;
+    EXPECT_EQ(evaluated, expected);
+    EXPECT_EQ(Count(Flush(), "\"name\":\"macro\""), static_cast<size_t>(expected));
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include "core.h"
+
+using namespace hermesml;
+
+namespace {
+    // 5 features in 8 slots: an odd count, with spare slots for FEATURE_SLOT_LABELS
+    constexpr uint32_t n_features = 5;
+    constexpr uint32_t slots = 8;
+
+    class TrainingSetTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+        EncryptedObject he{ctx};
+
+        const std::vector<double> labels = {1.0, 0.0, 1.0, 1.0, 0.0, 1.0, 0.0, 0.0, 1.0, 1.0};
+
+        [[nodiscard]] std::vector<double> Features(const size_t i) const {
+            std::vector<double> features(n_features);
+            for (size_t j = 0; j < n_features; j++) {
+                features[j] = static_cast<double>(i) + 0.1 * static_cast<double>(j + 1);
+            }
+            return features;
+        }
+
+        [[nodiscard]] std::vector<BootstrapableCiphertext> EncryptFeatures() const {
+            std::vector<BootstrapableCiphertext> features;
+            for (size_t i = 0; i < labels.size(); i++) {
+                features.push_back(he.EncryptCKKS(Features(i)));
+            }
+            return features;
+        }
+    };
+
+    // A label laid out as REPLICATED_LABELS does: in the n_features slots the weights are multiplied with
+    void ExpectReplicated(const BootstrapableCiphertext &label, const double expected) {
+        const auto &values = label.GetValues();
+        ASSERT_EQ(values.size(), slots);
+        for (size_t j = 0; j < slots; j++) {
+            EXPECT_NEAR(values[j], j < n_features ? expected : 0.0, 1e-12) << "at slot " << j;
+        }
+    }
+}
+
+TEST_F(TrainingSetTest, ReplicatedLabelsAreReturnedAsGiven) {
+    std::vector<BootstrapableCiphertext> eLabels;
+    for (const auto label: labels) {
+        eLabels.push_back(he.EncryptCKKS(std::vector(n_features, label)));
+    }
+    const TrainingSet samples(ctx, EncryptFeatures(), eLabels);
+
+    EXPECT_EQ(samples.GetSize(), labels.size());
+    for (size_t i = 0; i < labels.size(); i++) {
+        ExpectReplicated(samples.GetLabel(i), labels[i]);
+        EXPECT_EQ(samples.GetFeatures(i).GetValues(), he.EncryptCKKS(Features(i)).GetValues());
+    }
+}
+
+TEST_F(TrainingSetTest, FeatureSlotLabelsAreSplitFromTheFeatures) {
+    std::vector<BootstrapableCiphertext> features;
+    for (size_t i = 0; i < labels.size(); i++) {
+        auto withLabel = Features(i);
+        withLabel.push_back(labels[i]);
+        features.push_back(he.EncryptCKKS(withLabel));
+    }
+    const TrainingSet samples(ctx, features, {}, FEATURE_SLOT_LABELS);
+
+    for (size_t i = 0; i < labels.size(); i++) {
+        ExpectReplicated(samples.GetLabel(i), labels[i]);
+
+        // The label must not reach the weights
+        const auto values = samples.GetFeatures(i).GetValues();
+        const auto expected = Features(i);
+        for (size_t j = 0; j < slots; j++) {
+            EXPECT_NEAR(values[j], j < n_features ? expected[j] : 0.0, 1e-12) << "at slot " << j;
+        }
+    }
+}
+
+TEST_F(TrainingSetTest, PackedLabelsAreUnpackedOneAtATime) {
+    const std::vector eLabels = {
+        he.EncryptCKKS(std::vector(labels.begin(), labels.begin() + slots)),
+        he.EncryptCKKS(std::vector(labels.begin() + slots, labels.end()))
+    };
+    const TrainingSet samples(ctx, EncryptFeatures(), eLabels, PACKED_LABELS);
+
+    for (size_t i = 0; i < labels.size(); i++) {
+        ExpectReplicated(samples.GetLabel(i), labels[i]);
+    }
+}
+
+TEST_F(TrainingSetTest, UnpackingALabelSpendsOnlyTheMaskLevel) {
+    auto features = EncryptFeatures();
+    features.resize(slots);
+    const std::vector eLabels = {he.EncryptCKKS(labels)};
+    const TrainingSet samples(ctx, features, eLabels, PACKED_LABELS);
+
+    EXPECT_EQ(samples.GetLabel(3).GetRemainingLevels(), eLabels[0].GetRemainingLevels() - 1);
+}
+
+TEST_F(TrainingSetTest, ReplicateFillsExactlyTheRequestedSlots) {
+    const auto x = he.EncryptCKKS(std::vector{2.5});
+
+    for (uint32_t count = 1; count <= slots; count++) {
+        const auto replicated = he.EvalReplicate(x, count);
+
+        EXPECT_EQ(replicated.GetRemainingLevels(), x.GetRemainingLevels());
+        for (size_t j = 0; j < slots; j++) {
+            EXPECT_EQ(replicated.GetValues()[j], j < count ? 2.5 : 0.0) << count << " copies, slot " << j;
+        }
+    }
+}
+
+TEST_F(TrainingSetTest, FallsBackToPackedLabelsWithoutASpareSlot) {
+    EXPECT_EQ(TrainingSet::SupportedEncoding(ctx, FEATURE_SLOT_LABELS), FEATURE_SLOT_LABELS);
+    EXPECT_EQ(TrainingSet::SupportedEncoding(ctx, REPLICATED_LABELS), REPLICATED_LABELS);
+
+    const auto full = HEContextFactory::simulatedCkksHeContext(slots);
+    EXPECT_EQ(TrainingSet::SupportedEncoding(full, FEATURE_SLOT_LABELS), PACKED_LABELS);
+    EXPECT_THROW(TrainingSet(full, {}, {}, FEATURE_SLOT_LABELS), std::invalid_argument);
+}
+
+TEST_F(TrainingSetTest, RejectsLabelsThatDoNotMatchTheSamples) {
+    EXPECT_THROW(TrainingSet(ctx, EncryptFeatures(), {}), std::invalid_argument);
+    EXPECT_THROW(TrainingSet(ctx, EncryptFeatures(), {he.EncryptCKKS(labels)}, PACKED_LABELS),
+                 std::invalid_argument);
+}
@@ -0,0 +1,94 @@
+#include <filesystem>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "distributed.h"
+
+using namespace hermesml;
+
+namespace {
+    constexpr uint16_t features = 4;
+
+    class TrainingCoordinatorTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(features);
+        EncryptedObject he{ctx};
+        std::string directory = (std::filesystem::temp_directory_path() / "TrainingCoordinatorTest").string();
+        std::vector<BootstrapableCiphertext> x, y;
+
+        void SetUp() override {
+            std::filesystem::remove_all(directory);
+            std::filesystem::create_directories(directory);
+
+            const std::vector<std::vector<double> > samples = {
+                {0.5, -0.25, 0.75, 0.1}, {-0.6, 0.3, 0.2, -0.4}, {0.1, 0.9, -0.3, 0.05}, {-0.2, -0.7, 0.4, 0.6}
+            };
+            const std::vector<double> labels = {1.0, 0.0, 1.0, 0.0};
+
+            for (size_t i = 0; i < samples.size(); i++) {
+                x.push_back(he.EncryptCKKS(samples[i]));
+                y.push_back(he.EncryptCKKS(std::vector{labels[i]}));
+            }
+        }
+
+        void TearDown() override {
+            std::filesystem::remove_all(directory);
+        }
+    };
+
+    void ExpectSameValues(const BootstrapableCiphertext &actual, const BootstrapableCiphertext &expected) {
+        ASSERT_EQ(actual.GetValues().size(), expected.GetValues().size());
+        for (size_t i = 0; i < expected.GetValues().size(); i++) {
+            EXPECT_NEAR(actual.GetValues()[i], expected.GetValues()[i], 1e-12) << "slot " << i;
+        }
+    }
+}
+
+TEST_F(TrainingCoordinatorTest, MergedWorkerUpdatesEqualASingleProcessUpdate) {
+    const TrainingCoordinator coordinator(ctx, {directory, 2, 1});
+    coordinator.Prepare(x, y);
+
+    // Worker 0 holds samples 0 and 2, worker 1 samples 1 and 3, so each round moves the weights over two samples
+    std::vector<std::thread> workers;
+    for (uint32_t rank = 0; rank < 2; rank++) {
+        workers.emplace_back([&, rank] { TrainingWorker(ctx, directory, rank).Run(); });
+    }
+
+    CkksLogisticRegression distributed(ctx, features, 1);
+    coordinator.Train(distributed, 1);
+
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    CkksLogisticRegression local(ctx, features, 1);
+    local.Initialize();
+    local.ApplyGradients(local.ComputeGradients(x, y, 0, 2), 0.0);
+    local.ApplyGradients(local.ComputeGradients(x, y, 2, 4), 0.5);
+
+    ExpectSameValues(distributed.GetWeights(), local.GetWeights());
+    ExpectSameValues(distributed.GetBias(), local.GetBias());
+    EXPECT_EQ(distributed.GetWeights().GetRemainingLevels(), local.GetWeights().GetRemainingLevels());
+
+    // The round files are consumed and only the shards, the manifest and the end marker remain
+    EXPECT_FALSE(std::filesystem::exists(SharedDirectory(directory).ModelPath(0)));
+    EXPECT_FALSE(std::filesystem::exists(SharedDirectory(directory).GradientsPath(1, 1)));
+    EXPECT_TRUE(std::filesystem::exists(SharedDirectory(directory).Path("done")));
+}
+
+TEST_F(TrainingCoordinatorTest, ReportsAFailedWorker) {
+    const TrainingCoordinator coordinator(ctx, {directory, 2, 1});
+    coordinator.Prepare(x, y);
+
+    // Only worker 0 answers; worker 1 fails before its first round
+    std::filesystem::remove(SharedDirectory(directory).ShardPath(1, "x"));
+    std::thread worker([&] { TrainingWorker(ctx, directory, 0).Run(); });
+    std::thread broken([&] { EXPECT_ANY_THROW(TrainingWorker(ctx, directory, 1).Run()); });
+
+    CkksLogisticRegression model(ctx, features, 1);
+    EXPECT_THROW(coordinator.Train(model, 1), std::runtime_error);
+
+    worker.join();
+    broken.join();
+}
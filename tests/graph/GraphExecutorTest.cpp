@@ -0,0 +1,103 @@
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "graph.h"
+
+using namespace hermesml;
+
+namespace {
+    class GraphExecutorTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(4);
+        EncryptedObject he{ctx};
+    };
+
+    void ExpectValues(const BootstrapableCiphertext &ciphertext, const std::vector<double> &expected) {
+        const auto &values = ciphertext.GetValues();
+        ASSERT_GE(values.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(values[i], expected[i], 1e-9) << "at slot " << i;
+        }
+    }
+}
+
+TEST_F(GraphExecutorTest, EvaluatesOutputsInTheirOrder) {
+    ComputationGraph graph(ctx);
+    const auto a = graph.Input(he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0}));
+    const auto b = graph.Input(he.EncryptCKKS(std::vector{0.5, 0.5, 1.0, 2.0}));
+    const auto sum = graph.Add(a, b);
+    const auto difference = graph.Sub(a, b);
+    const auto product = graph.Mult(sum, difference);
+
+    for (const uint32_t workers: {1u, 4u}) {
+        const auto results = GraphExecutor(workers).Run(graph, {product, sum, a});
+
+        ASSERT_EQ(results.size(), 3u);
+        ExpectValues(results[0], {0.75, 3.75, 8.0, 12.0});
+        ExpectValues(results[1], {1.5, 2.5, 4.0, 6.0});
+        ExpectValues(results[2], {1.0, 2.0, 3.0, 4.0});
+    }
+}
+
+TEST_F(GraphExecutorTest, WideGraphsGiveTheSameResultsOnAnyNumberOfWorkers) {
+    ComputationGraph graph(ctx);
+    const auto x = graph.Input(he.EncryptCKKS(std::vector{0.1, 0.2, 0.3, 0.4}));
+
+    std::vector<NodeId> outputs;
+    for (auto i = 0; i < 64; i++) {
+        const auto scale = graph.Input(he.EncryptCKKS(std::vector(4, static_cast<double>(i))));
+        outputs.push_back(graph.Add(graph.Mult(x, scale), graph.Rotate(x, 1)));
+    }
+
+    const auto sequential = GraphExecutor(1).Run(graph, outputs);
+    const auto parallel = GraphExecutor(8).Run(graph, outputs);
+
+    ASSERT_EQ(parallel.size(), sequential.size());
+    for (size_t i = 0; i < sequential.size(); i++) {
+        EXPECT_EQ(parallel[i].GetValues(), sequential[i].GetValues()) << "at output " << i;
+    }
+}
+
+TEST_F(GraphExecutorTest, RunsOnlyWhatTheOutputsDependOn) {
+    std::atomic<int> calls{0};
+    const auto counted = [&calls](const BootstrapableCiphertext &c) {
+        ++calls;
+        return c;
+    };
+
+    ComputationGraph graph(ctx);
+    const auto x = graph.Input(he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0}));
+    const auto used = graph.Apply(x, counted);
+    (void) graph.Apply(graph.Apply(x, counted), counted);
+
+    const auto results = GraphExecutor(4).Run(graph, {used});
+
+    EXPECT_EQ(calls, 1);
+    ExpectValues(results[0], {1.0, 2.0, 3.0, 4.0});
+}
+
+TEST_F(GraphExecutorTest, PropagatesTheExceptionOfAFailingOperation) {
+    ComputationGraph graph(ctx);
+    const auto x = graph.Input(he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0}));
+
+    std::vector<NodeId> outputs;
+    for (auto i = 0; i < 16; i++) {
+        outputs.push_back(graph.Add(x, x));
+    }
+    outputs.push_back(graph.Apply(x, [](const BootstrapableCiphertext &) -> BootstrapableCiphertext {
+        throw std::runtime_error("operation failed");
+    }));
+
+    for (const uint32_t workers: {1u, 4u}) {
+        EXPECT_THROW((void) GraphExecutor(workers).Run(graph, outputs), std::runtime_error);
+    }
+}
+
+TEST_F(GraphExecutorTest, RejectsUnknownNodes) {
+    ComputationGraph graph(ctx);
+    const auto x = graph.Input(he.EncryptCKKS(std::vector{1.0, 2.0, 3.0, 4.0}));
+
+    EXPECT_THROW((void) GraphExecutor(1).Run(graph, {x + 1}), std::invalid_argument);
+    EXPECT_THROW((void) graph.Add(x, x + 1), std::invalid_argument);
+}
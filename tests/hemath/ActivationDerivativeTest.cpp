@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include "hemath.h"
+
+using namespace hermesml;
+
+namespace {
+    const std::vector inputs = {-2.0, -0.5, 0.0, 0.25, 1.0, 3.0};
+
+    class ActivationDerivativeTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(static_cast<uint32_t>(inputs.size()));
+        Calculus calculus{ctx};
+        BootstrapableCiphertext x = EncryptedObject(ctx).EncryptCKKS(inputs);
+
+        // Products an evaluation runs, to tell whether an approximation was evaluated once or twice
+        [[nodiscard]] uint64_t Products(const std::function<void()> &evaluation) const {
+            ctx.GetSimulation().Reset();
+            evaluation();
+            return ctx.GetSimulation().GetCount(SIM_MULT);
+        }
+    };
+}
+
+TEST_F(ActivationDerivativeTest, TanhDerivativeIsTakenFromTheActivation) {
+    for (const auto approximation: {CHEBYSHEV, TAYLOR, LEAST_SQUARES}) {
+        const auto [t, d] = calculus.TanhWithDerivative(x, approximation);
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const auto value = t.GetValues()[i];
+            EXPECT_NEAR(d.GetValues()[i], 1.0 - value * value, 1e-12) << "at " << inputs[i];
+        }
+
+        const auto tanhOnly = Products([&] { (void) calculus.Tanh(x, approximation); });
+        const auto both = Products([&] { (void) calculus.TanhWithDerivative(x, approximation); });
+        EXPECT_EQ(both, tanhOnly + 1) << "approximation " << approximation;
+    }
+}
+
+TEST_F(ActivationDerivativeTest, SigmoidDerivativeIsTakenFromTheActivation) {
+    for (const auto approximation: {CHEBYSHEV, TAYLOR, LEAST_SQUARES}) {
+        const auto [s, d] = calculus.SigmoidWithDerivative(x, approximation);
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            const auto value = s.GetValues()[i];
+            EXPECT_NEAR(d.GetValues()[i], value * (1.0 - value), 1e-12) << "at " << inputs[i];
+        }
+
+        const auto sigmoidOnly = Products([&] { (void) calculus.Sigmoid(x, approximation); });
+        const auto both = Products([&] { (void) calculus.SigmoidWithDerivative(x, approximation); });
+        EXPECT_EQ(both, sigmoidOnly + 1) << "approximation " << approximation;
+    }
+}
+
+TEST_F(ActivationDerivativeTest, DerivativesFollowTheExactFunctions) {
+    const auto tanh = calculus.TanhDerivative(x, CHEBYSHEV);
+    const auto sigmoid = calculus.SigmoidDerivative(x, CHEBYSHEV);
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto t = std::tanh(inputs[i]);
+        const auto s = 1.0 / (1.0 + std::exp(-inputs[i]));
+        EXPECT_NEAR(tanh.GetValues()[i], 1.0 - t * t, 0.05) << "tanh' at " << inputs[i];
+        EXPECT_NEAR(sigmoid.GetValues()[i], s * (1.0 - s), 0.05) << "sigmoid' at " << inputs[i];
+    }
+}
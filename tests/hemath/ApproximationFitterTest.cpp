@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "hemath.h"
+
+using namespace hermesml;
+
+namespace {
+    double Tanh(const double x) {
+        return std::tanh(x);
+    }
+
+    constexpr double errorTarget = 1e-3;
+    constexpr uint32_t maxDepth = 10;
+}
+
+TEST(ApproximationFitterTest, RemezMeetsTheErrorTargetOnTanh) {
+    const auto approximation = ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, errorTarget, maxDepth);
+
+    EXPECT_LE(approximation.maxError, errorTarget);
+    EXPECT_EQ(approximation.depth, Calculus::ChebyshevDepth(approximation.degree));
+
+    // The error Fit reports is the one the stored series actually reaches
+    for (auto x = -6.0; x <= 6.0; x += 0.01) {
+        EXPECT_NEAR(ApproximationFitter::Evaluate(approximation, x), Tanh(x), errorTarget * 1.01) << "at x = " << x;
+    }
+}
+
+TEST(ApproximationFitterTest, ChoosesTheLowestDepthThatMeetsTheTarget) {
+    const auto approximation = ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, errorTarget, maxDepth);
+    ASSERT_GT(approximation.depth, Calculus::ChebyshevDepth(1));
+
+    // Every degree one level cheaper misses the target
+    EXPECT_THROW((void) ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, errorTarget, approximation.depth - 1),
+                 std::invalid_argument);
+}
+
+TEST(ApproximationFitterTest, RejectsTargetsNoAffordableDegreeMeets) {
+    constexpr uint32_t shallowDepth = 4;
+    EXPECT_THROW((void) ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, 1e-6, shallowDepth), std::invalid_argument);
+
+    // A failed fit is not cached, and a reachable target at the same depth still fits
+    EXPECT_THROW((void) ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, 1e-6, shallowDepth), std::invalid_argument);
+    EXPECT_LE(ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, 1e-1, shallowDepth).maxError, 1e-1);
+}
+
+TEST(ApproximationFitterTest, CacheReturnsTheSameFitForTheSameConfiguration) {
+    const auto first = ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, errorTarget, maxDepth);
+
+    // A function that would fit differently under the same key shows the second result came from the cache
+    const auto cached = ApproximationFitter::Fit("tanh", [](double) { return 0.0; }, -6.0, 6.0, errorTarget,
+                                                 maxDepth);
+
+    EXPECT_EQ(cached.degree, first.degree);
+    EXPECT_EQ(cached.coefficients, first.coefficients);
+    EXPECT_EQ(cached.maxError, first.maxError);
+}
+
+TEST(ApproximationFitterTest, DifferentConfigurationsAreFittedSeparately) {
+    const auto coarse = ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, 1e-1, maxDepth);
+    const auto fine = ApproximationFitter::Fit("tanh", Tanh, -6.0, 6.0, errorTarget, maxDepth);
+
+    EXPECT_LT(coarse.degree, fine.degree);
+}
+
+TEST(ApproximationFitterTest, MinimaxNeedsLevelsLeftAfterBootstrapping) {
+    auto ctx = HEContextFactory::simulatedCkksHeContext(4);
+    ctx.SetLevelsAfterBootstrapping(2);
+
+    const Calculus calculus(ctx);
+    const auto x = EncryptedObject(ctx).EncryptCKKS(std::vector{0.5, -0.5, 0.25, -0.25});
+
+    EXPECT_THROW((void) calculus.Tanh(x, MINIMAX), std::invalid_argument);
+}
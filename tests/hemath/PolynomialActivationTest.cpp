@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include "hemath.h"
+
+using namespace hermesml;
+
+namespace {
+    const std::vector inputs = {-2.0, -0.5, 0.0, 0.75};
+
+    class PolynomialActivationTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(static_cast<uint32_t>(inputs.size()));
+        Calculus calculus{ctx};
+        BootstrapableCiphertext x = EncryptedObject(ctx).EncryptCKKS(inputs);
+    };
+
+    double PowerSeries(const std::vector<double> &coefficients, const double x) {
+        auto y = 0.0;
+        for (auto k = coefficients.size(); k-- > 0;) {
+            y = y * x + coefficients[k];
+        }
+        return y;
+    }
+
+    double Derivative(const std::vector<double> &coefficients, const double x) {
+        std::vector<double> derivative;
+        for (size_t k = 1; k < coefficients.size(); k++) {
+            derivative.push_back(static_cast<double>(k) * coefficients[k]);
+        }
+        return PowerSeries(derivative, x);
+    }
+}
+
+TEST_F(PolynomialActivationTest, EvaluatesEveryActivationInItsDepth) {
+    const std::vector<std::pair<ActivationFn, std::vector<double> > > activations = {
+        {SQUARE, Calculus::DefaultCoefficients(SQUARE)},
+        {SCALED_SQUARE, {0.5, -1.0, 0.25}},
+        {ODD_POLY, {0.0, 0.8, 0.0, -0.1}}
+    };
+
+    for (const auto &[activation, coefficients]: activations) {
+        const auto y = calculus.Polynomial(x, activation, coefficients);
+
+        EXPECT_EQ(y.GetRemainingLevels(), x.GetRemainingLevels() - Calculus::PolynomialDepth(activation));
+        for (size_t i = 0; i < inputs.size(); i++) {
+            EXPECT_NEAR(y.GetValues()[i], PowerSeries(coefficients, inputs[i]), 1e-12)
+                << "activation " << activation << " at " << inputs[i];
+        }
+    }
+}
+
+TEST_F(PolynomialActivationTest, DifferentiatesFromTheInput) {
+    for (const auto activation: {SQUARE, SCALED_SQUARE, ODD_POLY}) {
+        const auto coefficients = Calculus::DefaultCoefficients(activation);
+        const auto dy = calculus.PolynomialDerivative(x, activation, coefficients);
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            EXPECT_NEAR(dy.GetValues()[i], Derivative(coefficients, inputs[i]), 1e-12)
+                << "activation " << activation << " at " << inputs[i];
+        }
+    }
+}
+
+TEST_F(PolynomialActivationTest, DefaultsApproximateTheirTargets) {
+    const auto relu = Calculus::DefaultCoefficients(SCALED_SQUARE);
+    const auto tanh = Calculus::DefaultCoefficients(ODD_POLY);
+
+    for (auto t = -2.0; t <= 2.0; t += 0.01) {
+        EXPECT_NEAR(PowerSeries(relu, t), std::max(t, 0.0), 0.19) << "ReLU at " << t;
+    }
+    for (auto t = -4.0; t <= 4.0; t += 0.01) {
+        EXPECT_NEAR(PowerSeries(tanh, t), std::tanh(t), 0.23) << "tanh at " << t;
+    }
+}
+
+TEST_F(PolynomialActivationTest, OnlyPolynomialActivationsAreListed) {
+    EXPECT_TRUE(Calculus::IsPolynomial(SQUARE));
+    EXPECT_TRUE(Calculus::IsPolynomial(SCALED_SQUARE));
+    EXPECT_TRUE(Calculus::IsPolynomial(ODD_POLY));
+    EXPECT_FALSE(Calculus::IsPolynomial(TANH));
+    EXPECT_FALSE(Calculus::IsPolynomial(SIGMOID));
+    EXPECT_THROW((void) Calculus::DefaultCoefficients(TANH), std::invalid_argument);
+}
+
+TEST_F(PolynomialActivationTest, RejectsCoefficientsOfAnotherShape) {
+    EXPECT_NO_THROW(Calculus::CheckCoefficients(SCALED_SQUARE, {1.0, 2.0, 3.0}));
+    EXPECT_NO_THROW(Calculus::CheckCoefficients(ODD_POLY, {0.0, 1.0, 0.0, -0.5}));
+
+    EXPECT_THROW(Calculus::CheckCoefficients(SCALED_SQUARE, {1.0, 2.0}), std::invalid_argument);
+    EXPECT_THROW(Calculus::CheckCoefficients(SQUARE, {0.0, 0.0, 2.0}), std::invalid_argument);
+    EXPECT_THROW(Calculus::CheckCoefficients(ODD_POLY, {0.0, 1.0, 0.5, -0.5}), std::invalid_argument);
+}
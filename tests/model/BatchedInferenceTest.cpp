@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "client.h"
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    // The initial network weights are hard-coded for a 30-20-10-1 network
+    constexpr uint16_t n_features = 30;
+
+    class BatchedInferenceTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(n_features, true);
+        Client client{ctx};
+
+        // More samples than one packed ciphertext holds, so the last one is only partly filled
+        [[nodiscard]] std::vector<std::vector<double> > Samples() const {
+            std::vector<std::vector<double> > samples(ctx.GetSamplesPerCiphertext() + 5);
+            for (size_t i = 0; i < samples.size(); i++) {
+                for (size_t j = 0; j < n_features; j++) {
+                    samples[i].push_back(std::sin(static_cast<double>(i * n_features + j)));
+                }
+            }
+            return samples;
+        }
+    };
+
+    void ExpectNear(const std::vector<double> &actual, const std::vector<double> &expected) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(actual[i], expected[i], 1e-9) << "sample " << i;
+        }
+    }
+}
+
+TEST_F(BatchedInferenceTest, NeuralNetworkPredictsEverySampleOfABatch) {
+    const auto model = CkksNeuralNetwork(ctx, n_features, 1, {n_features, 20, 10, 1});
+    const auto samples = Samples();
+
+    const auto packed = client.DecryptPacked(model.PredictAllPacked(client.EncryptCKKSPacked(samples)),
+                                             samples.size());
+    const auto oneByOne = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(samples)));
+
+    ExpectNear(packed, oneByOne);
+}
+
+TEST_F(BatchedInferenceTest, LogisticRegressionPredictsEverySampleOfABatch) {
+    auto model = CkksLogisticRegression(ctx, n_features, 1);
+    model.Initialize();
+    const auto samples = Samples();
+
+    const auto packed = client.DecryptPacked(model.PredictAllPacked(client.EncryptCKKSPacked(samples)),
+                                             samples.size());
+    const auto oneByOne = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(samples)));
+
+    ExpectNear(packed, oneByOne);
+}
+
+TEST_F(BatchedInferenceTest, PacksOneBlockPerSample) {
+    const auto samples = Samples();
+    const auto packed = client.EncryptCKKSPacked(samples);
+
+    ASSERT_EQ(packed.size(), 2u);
+    const auto &values = packed[1].GetValues();
+    EXPECT_EQ(values[0], samples[ctx.GetSamplesPerCiphertext()][0]);
+    EXPECT_EQ(values[ctx.GetNumSlots() + 1], samples[ctx.GetSamplesPerCiphertext() + 1][1]);
+    EXPECT_EQ(values[5 * ctx.GetNumSlots()], 0.0);
+}
+
+TEST_F(BatchedInferenceTest, RejectsWhatDoesNotFit) {
+    EXPECT_THROW((void) client.EncryptCKKSPacked({std::vector(ctx.GetNumSlots() + 1, 1.0)}), std::invalid_argument);
+
+    const auto unbatched = HEContextFactory::simulatedCkksHeContext(n_features);
+    EXPECT_THROW((void) Client(unbatched).EncryptCKKSPacked(Samples()), std::runtime_error);
+}
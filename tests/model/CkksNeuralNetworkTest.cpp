@@ -0,0 +1,176 @@
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    // The initial weights are hard-coded for a 30-20-10-1 network
+    constexpr uint16_t n_features = 30;
+    const std::vector<size_t> layers = {n_features, 20, 10, 1};
+
+    std::vector<double> Sample(const double value) {
+        std::vector<double> features(n_features);
+        for (size_t i = 0; i < features.size(); i++) {
+            features[i] = value * static_cast<double>(i % 5) / 5.0;
+        }
+        return features;
+    }
+}
+
+TEST(CkksNeuralNetworkTest, ResumesTheTrainedWeightsFromACheckpoint) {
+    const auto directory = (std::filesystem::temp_directory_path() / "hermesml-nn-checkpoint-test").string();
+    std::filesystem::remove_all(directory);
+
+    const auto ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+    const EncryptedObject he(ctx);
+
+    const std::vector x = {he.EncryptCKKS(Sample(1.0)), he.EncryptCKKS(Sample(-1.0))};
+    const std::vector y = {
+        he.EncryptCKKS(std::vector<double>(n_features, 1.0)), he.EncryptCKKS(std::vector<double>(n_features, 0.0))
+    };
+    const auto point = he.EncryptCKKS(Sample(0.5));
+
+    auto trained = CkksNeuralNetwork(ctx, n_features, 1, layers);
+    trained.SetCheckpointOptions({directory});
+    trained.Fit(x, y);
+
+    // Every sample is already done, so Fit only restores the checkpoint
+    auto resumed = CkksNeuralNetwork(ctx, n_features, 1, layers);
+    resumed.SetCheckpointOptions({directory});
+    resumed.Fit(x, y);
+
+    auto untrained = CkksNeuralNetwork(ctx, n_features, 1, layers);
+
+    const auto expected = trained.Predict(point).GetValues();
+    const auto actual = resumed.Predict(point).GetValues();
+    const auto initial = untrained.Predict(point).GetValues();
+
+    EXPECT_NE(initial[0], expected[0]);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_DOUBLE_EQ(actual[i], expected[i]);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(CkksNeuralNetworkTest, ResumesCustomActivationCoefficientsFromACheckpoint) {
+    const auto directory = (std::filesystem::temp_directory_path() / "hermesml-nn-coefficients-test").string();
+    std::filesystem::remove_all(directory);
+
+    const auto ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+    const EncryptedObject he(ctx);
+    const std::vector coefficients = {0.0, 0.5, 0.0, -0.02};
+
+    auto trained = CkksNeuralNetwork(ctx, n_features, 1, layers, 42, ODD_POLY);
+    trained.SetActivationCoefficients(coefficients);
+    trained.SetCheckpointOptions({directory});
+    trained.Fit({he.EncryptCKKS(Sample(1.0))}, {he.EncryptCKKS(std::vector<double>(n_features, 1.0))});
+
+    // Built with the default coefficients, as a resuming process would be
+    auto resumed = CkksNeuralNetwork(ctx, n_features, 1, layers, 42, ODD_POLY);
+    resumed.SetCheckpointOptions({directory});
+    resumed.Fit({he.EncryptCKKS(Sample(1.0))}, {he.EncryptCKKS(std::vector<double>(n_features, 1.0))});
+
+    EXPECT_EQ(resumed.GetActivationCoefficients(), coefficients);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(CkksNeuralNetworkTest, PredictAllMatchesPredictOnAnyNumberOfWorkers) {
+    const auto ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+    const EncryptedObject he(ctx);
+
+    std::vector<BootstrapableCiphertext> x;
+    for (auto i = 0; i < 12; i++) {
+        x.push_back(he.EncryptCKKS(Sample(0.25 * i - 1.5)));
+    }
+
+    auto model = CkksNeuralNetwork(ctx, n_features, 1, layers);
+
+    for (const uint32_t workers: {1u, 4u}) {
+        const auto predictions = model.PredictAll(x, workers);
+
+        ASSERT_EQ(predictions.size(), x.size());
+        for (size_t i = 0; i < x.size(); i++) {
+            EXPECT_EQ(predictions[i].GetValues(), model.Predict(x[i]).GetValues())
+                << "sample " << i << " on " << workers << " workers";
+        }
+    }
+}
+
+TEST(CkksNeuralNetworkTest, FitStepMatchesPlaintextBackpropagation) {
+    const auto ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+    const EncryptedObject he(ctx);
+
+    // A polynomial activation is evaluated exactly, so the plaintext network can follow it to the last digit
+    auto model = CkksNeuralNetwork(ctx, n_features, 1, layers, 42, SCALED_SQUARE);
+    const auto c = model.GetActivationCoefficients();
+    const auto f = [&c](const double z) { return c[0] + c[1] * z + c[2] * z * z; };
+    const auto df = [&c](const double z) { return c[1] + 2.0 * c[2] * z; };
+
+    // w[k][n][i] weighs input i of unit n in layer k
+    std::vector<std::vector<std::vector<double> > > w(layers.size() - 1);
+    std::vector<std::vector<double> > b(layers.size() - 1);
+    for (size_t k = 0; k < w.size(); k++) {
+        for (size_t n = 0; n < layers[k + 1]; n++) {
+            const auto weights = model.GetWeights()[k][n].GetValues();
+            w[k].emplace_back(weights.begin(), weights.begin() + static_cast<std::ptrdiff_t>(layers[k]));
+            b[k].push_back(model.GetBias()[k][n].GetValues()[0]);
+        }
+    }
+
+    const auto x = Sample(1.0);
+    constexpr auto y = 1.0;
+    model.Fit({he.EncryptCKKS(x)}, {he.EncryptCKKS(std::vector(n_features, y))});
+
+    // Forward
+    std::vector<std::vector<double> > inputs{x};
+    std::vector<std::vector<double> > z;
+    for (size_t k = 0; k < w.size(); k++) {
+        z.emplace_back();
+        inputs.emplace_back();
+        for (size_t n = 0; n < w[k].size(); n++) {
+            auto sum = b[k][n];
+            for (size_t i = 0; i < w[k][n].size(); i++) {
+                sum += w[k][n][i] * inputs[k][i];
+            }
+            z.back().push_back(sum);
+            inputs.back().push_back(f(sum));
+        }
+    }
+
+    // Backward, against the weights the forward pass used
+    constexpr auto lr = 0.005;
+    std::vector delta{(inputs.back()[0] - y) * df(z.back()[0])};
+    for (auto k = static_cast<int32_t>(w.size() - 1); k >= 0; k--) {
+        std::vector<double> previous(layers[k], 0.0);
+        for (size_t i = 0; k > 0 && i < previous.size(); i++) {
+            for (size_t n = 0; n < w[k].size(); n++) {
+                previous[i] += w[k][n][i] * delta[n];
+            }
+            previous[i] *= df(z[k - 1][i]);
+        }
+
+        for (size_t n = 0; n < w[k].size(); n++) {
+            for (size_t i = 0; i < w[k][n].size(); i++) {
+                w[k][n][i] -= lr * delta[n] * inputs[k][i];
+            }
+            b[k][n] -= lr * delta[n];
+        }
+        delta = previous;
+    }
+
+    for (size_t k = 0; k < w.size(); k++) {
+        for (size_t n = 0; n < w[k].size(); n++) {
+            const auto weights = model.GetWeights()[k][n].GetValues();
+            for (size_t i = 0; i < w[k][n].size(); i++) {
+                EXPECT_NEAR(weights[i], w[k][n][i], 1e-12) << "layer " << k << " unit " << n << " input " << i;
+            }
+            EXPECT_NEAR(model.GetBias()[k][n].GetValues()[0], b[k][n], 1e-12) << "layer " << k << " unit " << n;
+        }
+    }
+}
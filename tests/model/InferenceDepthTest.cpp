@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "client.h"
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    // The initial network weights are hard-coded for a 30-20-10-1 network
+    constexpr uint16_t n_features = 30;
+    const std::vector<size_t> layers = {n_features, 20, 10, 1};
+
+    class InferenceDepthTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+        Client client{ctx};
+
+        [[nodiscard]] std::vector<std::vector<double> > Samples() const {
+            std::vector<std::vector<double> > samples(4);
+            for (size_t i = 0; i < samples.size(); i++) {
+                for (size_t j = 0; j < n_features; j++) {
+                    samples[i].push_back(std::cos(static_cast<double>(i * n_features + j)));
+                }
+            }
+            return samples;
+        }
+
+        [[nodiscard]] uint64_t Bootstraps() const {
+            return ctx.GetSimulation().GetCount(SIM_BOOTSTRAP);
+        }
+    };
+}
+
+TEST_F(InferenceDepthTest, EncryptsWithOnlyTheLevelsAskedFor) {
+    const auto full = client.EncryptCKKS(Samples());
+    const auto reduced = client.EncryptCKKS(Samples(), 3);
+
+    EXPECT_EQ(full[0].GetRemainingLevels(), static_cast<int32_t>(ctx.GetMultiplicativeDepth()));
+    EXPECT_EQ(reduced[0].GetRemainingLevels(), static_cast<int32_t>(3 + ctx.GetEarlyBootstrapping() + 2));
+    EXPECT_EQ(reduced[0].GetValues(), full[0].GetValues());
+
+    // Never more than the context has
+    EXPECT_EQ(client.EncryptCKKS(Samples(), 1000)[0].GetRemainingLevels(), full[0].GetRemainingLevels());
+}
+
+TEST_F(InferenceDepthTest, NeuralNetworkNeedsNoBootstrapWithinItsDepth) {
+    const auto model = CkksNeuralNetwork(ctx, n_features, 1, layers);
+    const auto depth = CkksNeuralNetwork::InferenceDepth(ctx, layers, TANH, CHEBYSHEV);
+    ASSERT_LT(depth, ctx.GetMultiplicativeDepth());
+
+    const auto expected = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(Samples())));
+
+    const auto x = client.EncryptCKKS(Samples(), depth);
+    ctx.GetSimulation().Reset();
+    const auto predictions = model.PredictAll(x);
+
+    EXPECT_EQ(Bootstraps(), 0u);
+    EXPECT_EQ(client.DecryptCKKS(predictions), expected);
+}
+
+TEST_F(InferenceDepthTest, LogisticRegressionNeedsNoBootstrapWithinItsDepth) {
+    auto model = CkksLogisticRegression(ctx, n_features, 1);
+    model.Initialize();
+    const auto depth = CkksLogisticRegression::InferenceDepth(ctx, TANH, CHEBYSHEV);
+
+    const auto expected = client.DecryptCKKS(model.PredictAll(client.EncryptCKKS(Samples())));
+
+    const auto x = client.EncryptCKKS(Samples(), depth);
+    ctx.GetSimulation().Reset();
+    const auto predictions = model.PredictAll(x);
+
+    EXPECT_EQ(Bootstraps(), 0u);
+    EXPECT_EQ(client.DecryptCKKS(predictions), expected);
+}
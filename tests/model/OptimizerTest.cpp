@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    class OptimizerTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(2);
+        EncryptedObject he{ctx};
+
+        static constexpr double rate = 0.1;
+        static constexpr double mu = 0.9;
+        const std::vector<std::vector<double> > directions = {{1.0, -2.0}, {0.5, 4.0}, {-1.0, 1.0}};
+
+        // Runs the optimizer over every direction, from a parameter at {1, 1}
+        [[nodiscard]] std::vector<double> Train(Optimizer &optimizer) const {
+            auto eParameter = he.EncryptCKKS(std::vector{1.0, 1.0});
+            for (const auto &direction: directions) {
+                optimizer.Step({&eParameter}, {he.EncryptCKKS(direction)}, rate);
+            }
+            return eParameter.GetValues();
+        }
+    };
+
+    void ExpectValues(const std::vector<double> &actual, const std::vector<double> &expected) {
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_NEAR(actual[i], expected[i], 1e-12) << "at slot " << i;
+        }
+    }
+}
+
+TEST_F(OptimizerTest, SgdStepsAlongTheDirections) {
+    auto optimizer = Optimizer(ctx, {SGD, rate});
+
+    ExpectValues(Train(optimizer), {1.0 + rate * 0.5, 1.0 + rate * 3.0});
+    EXPECT_TRUE(optimizer.GetVelocities().empty());
+}
+
+TEST_F(OptimizerTest, MomentumAccumulatesAVelocity) {
+    auto optimizer = Optimizer(ctx, {MOMENTUM, rate, mu});
+
+    std::vector parameter = {1.0, 1.0};
+    std::vector velocity = {0.0, 0.0};
+    for (const auto &direction: directions) {
+        for (size_t i = 0; i < parameter.size(); i++) {
+            velocity[i] = mu * velocity[i] + rate * direction[i];
+            parameter[i] += velocity[i];
+        }
+    }
+
+    ExpectValues(Train(optimizer), parameter);
+    ASSERT_EQ(optimizer.GetVelocities().size(), 1u);
+    ExpectValues(optimizer.GetVelocities()[0].GetValues(), velocity);
+}
+
+TEST_F(OptimizerTest, NesterovLooksAhead) {
+    auto optimizer = Optimizer(ctx, {NESTEROV, rate, mu});
+
+    std::vector parameter = {1.0, 1.0};
+    std::vector velocity = {0.0, 0.0};
+    for (const auto &direction: directions) {
+        for (size_t i = 0; i < parameter.size(); i++) {
+            velocity[i] = mu * velocity[i] + rate * direction[i];
+            parameter[i] += mu * velocity[i] + rate * direction[i];
+        }
+    }
+
+    ExpectValues(Train(optimizer), parameter);
+}
+
+TEST_F(OptimizerTest, ResetStartsFromRest) {
+    auto optimizer = Optimizer(ctx, {MOMENTUM, rate, mu});
+    (void) Train(optimizer);
+
+    optimizer.Reset();
+    EXPECT_TRUE(optimizer.GetVelocities().empty());
+
+    auto eParameter = he.EncryptCKKS(std::vector{0.0, 0.0});
+    optimizer.Step({&eParameter}, {he.EncryptCKKS(std::vector{1.0, 1.0})}, rate);
+    ExpectValues(eParameter.GetValues(), {rate, rate});
+}
+
+TEST_F(OptimizerTest, SchedulesDecayTheLearningRate) {
+    const auto at = [this](const ScheduleFn schedule, const double epoch) {
+        return Optimizer(ctx, {SGD, 0.2, mu, schedule, 0.5, 2.0}).GetLearningRate(epoch);
+    };
+
+    EXPECT_DOUBLE_EQ(at(CONSTANT_RATE, 3.0), 0.2);
+
+    EXPECT_DOUBLE_EQ(at(STEP_DECAY, 1.5), 0.2);
+    EXPECT_DOUBLE_EQ(at(STEP_DECAY, 2.0), 0.1);
+    EXPECT_DOUBLE_EQ(at(STEP_DECAY, 4.5), 0.05);
+
+    EXPECT_DOUBLE_EQ(at(EXPONENTIAL_DECAY, 1.0), 0.2 * std::sqrt(0.5));
+    EXPECT_DOUBLE_EQ(at(EXPONENTIAL_DECAY, 4.0), 0.05);
+
+    EXPECT_DOUBLE_EQ(at(INVERSE_TIME_DECAY, 0.0), 0.2);
+    EXPECT_DOUBLE_EQ(at(INVERSE_TIME_DECAY, 4.0), 0.1);
+}
+
+TEST_F(OptimizerTest, RejectsInvalidOptions) {
+    EXPECT_THROW(Optimizer(ctx, {SGD, 0.0}), std::invalid_argument);
+    EXPECT_THROW(Optimizer(ctx, {MOMENTUM, rate, 1.0}), std::invalid_argument);
+    EXPECT_THROW(Optimizer(ctx, {SGD, rate, mu, STEP_DECAY, 0.5, 0.0}), std::invalid_argument);
+}
+
+TEST_F(OptimizerTest, RejectsMismatchedParameters) {
+    auto optimizer = Optimizer(ctx, {MOMENTUM, rate, mu});
+    auto eFirst = he.EncryptCKKS(std::vector{0.0, 0.0});
+    auto eSecond = he.EncryptCKKS(std::vector{0.0, 0.0});
+    const auto eDirection = he.EncryptCKKS(std::vector{1.0, 1.0});
+
+    EXPECT_THROW(optimizer.Step({&eFirst, &eSecond}, {eDirection}, rate), std::invalid_argument);
+
+    // Velocities are tracked per parameter, so the parameter set cannot change between steps
+    optimizer.Step({&eFirst}, {eDirection}, rate);
+    EXPECT_THROW(optimizer.Step({&eFirst, &eSecond}, {eDirection, eDirection}, rate), std::invalid_argument);
+}
+
+TEST_F(OptimizerTest, DistributedGradientsStepAtTheScheduledRate) {
+    auto model = CkksLogisticRegression(ctx, 2, 1);
+    model.SetOptimizer({SGD, 0.2, mu, STEP_DECAY, 0.5, 1.0});
+    model.Initialize();
+
+    const auto weights = model.GetWeights().GetValues();
+    const auto bias = model.GetBias().GetValues();
+
+    // Workers send unscaled sums; the rate is only known where the schedule runs
+    model.ApplyGradients({he.EncryptCKKS(std::vector{1.0, -1.0}), he.EncryptCKKS(std::vector{2.0, 2.0})}, 1.5);
+
+    ExpectValues(model.GetWeights().GetValues(), {weights[0] + 0.1, weights[1] - 0.1});
+    ExpectValues(model.GetBias().GetValues(), {bias[0] + 0.2, bias[1] + 0.2});
+}
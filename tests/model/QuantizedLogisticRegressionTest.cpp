@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "model.h"
+
+using namespace hermesml;
+
+namespace {
+    constexpr uint32_t n_features = 4;
+
+    class QuantizedLogisticRegressionTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(n_features);
+        EncryptedObject he{ctx};
+
+        [[nodiscard]] double Logit(const QuantizedLogisticRegression &model, const std::vector<double> &x) const {
+            const auto logit = model.Predict(he.Encrypt(Quantizer::Quantize(x))).GetValues()[0];
+            return QuantizedLogisticRegression::Dequantize(static_cast<int64_t>(std::llround(logit)));
+        }
+    };
+
+    double PlainLogit(const std::vector<double> &x, const std::vector<double> &weights, const double bias) {
+        auto logit = bias;
+        for (size_t i = 0; i < x.size(); i++) {
+            logit += x[i] * weights[i];
+        }
+        return logit;
+    }
+}
+
+TEST_F(QuantizedLogisticRegressionTest, ValuesOnTheQuantizationGridRoundTripExactly) {
+    const std::vector x = {0.25, -0.5, 0.125, 1.0};
+    const std::vector weights = {2.0, 0.75, -1.5, 0.0625};
+    const auto bias = -0.375;
+
+    const QuantizedLogisticRegression model(ctx, weights, bias);
+    EXPECT_EQ(Logit(model, x), PlainLogit(x, weights, bias));
+}
+
+TEST_F(QuantizedLogisticRegressionTest, DequantizedLogitStaysWithinTheQuantizationError) {
+    const std::vector x = {0.123456, -0.987654, 0.333333, 0.707107};
+    const std::vector weights = {1.414214, -0.271828, 0.577216, -2.302585};
+    const auto bias = 0.161803;
+
+    // Each factor is truncated by less than one step of the grid, so each product moves by less than
+    // (|x| + |w| + 1 / scale) / scale
+    auto bound = 0.0;
+    for (size_t i = 0; i < x.size(); i++) {
+        bound += (std::abs(x[i]) + std::abs(weights[i]) + 1.0 / QUANTIZE_SCALE_FACTOR) / QUANTIZE_SCALE_FACTOR;
+    }
+
+    const QuantizedLogisticRegression model(ctx, weights, bias);
+    const auto logit = Logit(model, x);
+    EXPECT_NEAR(logit, PlainLogit(x, weights, bias), bound);
+    EXPECT_NE(logit, PlainLogit(x, weights, bias));
+}
+
+TEST_F(QuantizedLogisticRegressionTest, PredictAllKeepsTheSampleOrder) {
+    const std::vector weights = {1.0, -1.0, 0.5, 0.25};
+    const QuantizedLogisticRegression model(ctx, weights, 0.0);
+
+    const std::vector<std::vector<double> > samples = {
+        {1.0, 0.0, 0.0, 0.0}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 1.0}
+    };
+    std::vector<BootstrapableCiphertext> x;
+    for (const auto &sample: samples) {
+        x.push_back(he.Encrypt(Quantizer::Quantize(sample)));
+    }
+
+    const auto predictions = model.PredictAll(x);
+    ASSERT_EQ(predictions.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        const auto logit = static_cast<int64_t>(std::llround(predictions[i].GetValues()[0]));
+        EXPECT_EQ(QuantizedLogisticRegression::Dequantize(logit), PlainLogit(samples[i], weights, 0.0));
+    }
+}
+
+TEST_F(QuantizedLogisticRegressionTest, RejectsWeightsThatDoNotMatchTheFeatures) {
+    EXPECT_THROW(QuantizedLogisticRegression(ctx, {0.5, 0.25, 0.125}, 0.0), std::invalid_argument);
+}
@@ -0,0 +1,58 @@
+#include <filesystem>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "serving.h"
+
+using namespace hermesml;
+
+namespace {
+    const std::vector inputs = {0.75, -1.5, 3.25, 0.0};
+
+    class ClientAidedRefreshTest : public testing::Test {
+    protected:
+        HEContext ctx = HEContextFactory::simulatedCkksHeContext(static_cast<uint32_t>(inputs.size()));
+        std::string socketPath = (std::filesystem::temp_directory_path() / "ClientAidedRefreshTest.sock").string();
+        RefreshService service{ctx, socketPath};
+        std::thread serving{[this] { service.Serve(); }};
+        std::shared_ptr<ClientAidedRefresh> refresh = Connect();
+
+        void TearDown() override {
+            refresh->Shutdown();
+            serving.join();
+        }
+
+        // The service listens from its own thread, so the first attempts may come before it does
+        [[nodiscard]] std::shared_ptr<ClientAidedRefresh> Connect() const {
+            for (int attempt = 0;; attempt++) {
+                try {
+                    return std::make_shared<ClientAidedRefresh>(socketPath);
+                } catch (const std::runtime_error &) {
+                    if (attempt == 500) {
+                        throw;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        }
+    };
+}
+
+TEST_F(ClientAidedRefreshTest, MaskedRefreshKeepsTheValuesAndResetsTheLevels) {
+    auto aidedCtx = ctx;
+    aidedCtx.SetRefreshStrategy(refresh);
+    const EncryptedObject he(aidedCtx);
+
+    // A ciphertext with a single level left, as the end of a deep computation leaves it
+    const BootstrapableCiphertext exhausted(inputs, 1);
+    const auto refreshed = he.EvalBootstrap(exhausted);
+
+    EXPECT_EQ(refresh->GetRefreshes(), 1u);
+    EXPECT_GT(refreshed.GetRemainingLevels(), exhausted.GetRemainingLevels());
+    EXPECT_EQ(refreshed.GetRemainingLevels(), static_cast<int32_t>(aidedCtx.GetLevelsAfterBootstrapping()));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        // The mask goes up to 1e3, so its removal costs a few ulps of that magnitude
+        EXPECT_NEAR(refreshed.GetValues()[i], inputs[i], 1e-9) << "slot " << i;
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+
+#include "serving.h"
+
+using namespace hermesml;
+
+namespace {
+    // Both ends of a connected Unix domain socket, as the server and a client hold them
+    std::pair<std::unique_ptr<SocketStream>, std::unique_ptr<SocketStream> > Connected(
+        const uint64_t maxFrameBytes = SocketStream::defaultMaxFrameBytes) {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+            throw std::runtime_error("Could not create a socket pair");
+        }
+        return {std::make_unique<SocketStream>(fds[0], maxFrameBytes), std::make_unique<SocketStream>(fds[1])};
+    }
+}
+
+TEST(SocketStreamTest, FramesRoundTrip) {
+    const auto [server, client] = Connected();
+
+    // Binary payloads, including NUL bytes, arrive exactly as sent
+    const std::string payload("ciphertext\0bytes", 16);
+    client->WriteFrame(MSG_PREDICT, payload);
+    client->WriteFrame(MSG_STATS, "");
+
+    MessageType type;
+    std::string received;
+
+    ASSERT_TRUE(server->ReadFrame(type, received));
+    EXPECT_EQ(type, MSG_PREDICT);
+    EXPECT_EQ(received, payload);
+
+    ASSERT_TRUE(server->ReadFrame(type, received));
+    EXPECT_EQ(type, MSG_STATS);
+    EXPECT_TRUE(received.empty());
+}
+
+TEST(SocketStreamTest, LargeFramesArriveWhole) {
+    // Structured bindings cannot be captured by a lambda in C++17
+    const auto streams = Connected();
+    const auto &server = streams.first;
+    const auto &client = streams.second;
+
+    // Larger than a socket buffer, so both sides loop over partial transfers
+    std::string payload(8 << 20, '\0');
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = static_cast<char>(i * 31);
+    }
+
+    std::thread writer([&client, &payload] { client->WriteFrame(MSG_RESULT, payload); });
+
+    MessageType type;
+    std::string received;
+    const auto read = server->ReadFrame(type, received);
+    writer.join();
+
+    ASSERT_TRUE(read);
+    EXPECT_EQ(type, MSG_RESULT);
+    EXPECT_EQ(received, payload);
+}
+
+TEST(SocketStreamTest, ReadReportsAClosedPeer) {
+    auto [server, client] = Connected();
+    client.reset();
+
+    MessageType type;
+    std::string received;
+    EXPECT_FALSE(server->ReadFrame(type, received));
+}
+
+TEST(SocketStreamTest, OversizedFramesAreRejectedBeforeTheirPayload) {
+    const auto [server, client] = Connected(16);
+
+    client->WriteFrame(MSG_PREDICT, std::string(17, 'x'));
+
+    MessageType type;
+    std::string received;
+    EXPECT_THROW((void) server->ReadFrame(type, received), std::runtime_error);
+    EXPECT_TRUE(received.empty());
+}